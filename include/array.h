@@ -2,17 +2,39 @@
 #define DATALIB_ARRAY_H
 
 #include "defs.h"
+#include "threadpool.h"
 
 /** @struct array_t
 * @brief Data structure with dynamic contiguous storage of generic data.
 */
 typedef struct array_container {
-	char* data;				/**< Main memory pool */
-	uint32_t size;			/**< Number of stored elements */
-	uint32_t capacity;		/**< Max number of elements allocated */
-	uint32_t element_size;	/**< Size in bytes of an element */
+	char* data;				/**< Main memory pool, aligned to `DATALIB_ALIGNMENT` */
+	size_t size;			/**< Number of stored elements */
+	size_t capacity;		/**< Max number of elements allocated */
+	size_t element_size;	/**< Size in bytes of an element */
+	struct array_mapping* mapping;	/**< Backing file, or NULL if the pool is on the heap */
 } array_t;
 
+/** @brief Expected access pattern of a file-backed array, see `array_advise` */
+enum array_advice {
+	ARRAY_ADVICE_NORMAL,		/**< No particular pattern */
+	ARRAY_ADVICE_SEQUENTIAL,	/**< Elements are read in order, read ahead aggressively */
+	ARRAY_ADVICE_RANDOM,		/**< Elements are read in random order, do not read ahead */
+	ARRAY_ADVICE_WILLNEED		/**< All elements will be needed soon, start paging them in */
+};
+
+/** @brief Returns a pointer to the element at index I of an array A.
+* Unlike `array_get`, the array and the index are not validated.
+*/
+#define array_at(A, I) ((void*)((A)->data + (size_t)(I) * (A)->element_size))
+
+/** @brief Accesses the element at index I of an array A as a value of type T.
+* The index is not validated, and T must have a size equal to the element size.
+* Can be used on both sides of an assignment, and compiles to a plain load or store,
+* e.g. `array_at_as(&a, int, i) = array_at_as(&a, int, i - 1) + 1;`
+*/
+#define array_at_as(A, T, I) (((T*)(A)->data)[(I)])
+
 /** @brief Initialises an array via a given pointer.
 *   Allows the user to manage the memory of the struct itself.
 *   The memory pool will still be stored on the heap.
@@ -21,7 +43,7 @@ typedef struct array_container {
 *	@param element_size size in bytes of an array element.
 *   @returns input array or NULL if element_size is zero.
 */
-void* array_init(array_t* array, uint32_t element_size);
+void* array_init(array_t* array, size_t element_size);
 
 /** @brief Resets the array state and frees the memory pool.
 *	@param array the array to uninitialise.
@@ -32,7 +54,7 @@ void array_uninit(array_t* array);
 *   Should be later freed with `array_destroy`.
 *	@param element_size size in bytes of an array element.
 */
-array_t* array_create(uint32_t element_size);
+array_t* array_create(size_t element_size);
 
 /** @brief Frees an allocated array
 *	@param array the array to deallocate.
@@ -44,12 +66,14 @@ void array_destroy(array_t* array);
 */
 array_t* array_copy(array_t* orig);
 
-/* Initialises an array from existing data
-If a size of zero or empty data are provided, no elements are added to the array.
-*/
-/*
-array_t* array_from_data(void* data, uint32_t size, uint32_t element_size);
+/** @brief Initialises an array from existing data, allocating it on the heap.
+* If a size of zero or empty data are provided, no elements are added to the array.
+* Should be later freed with `array_destroy`.
+* @param data buffer of `size` contiguous elements to copy.
+* @param size number of elements in the buffer.
+* @param element_size size in bytes of an array element.
 */
+array_t* array_from_data(const void* data, size_t size, size_t element_size);
 
 /** @brief Pre-allocates a given number of elements.
 * The new elements are not initialised.
@@ -58,7 +82,7 @@ array_t* array_from_data(void* data, uint32_t size, uint32_t element_size);
 * @param array Array to resize.
 * @param size New size of the array.
 */
-array_t* array_resize(array_t* array, uint32_t size);
+array_t* array_resize(array_t* array, size_t size);
 
 /** @brief Sets the value of an element.
 * Any previously data contained in the element is overwritten.
@@ -68,14 +92,14 @@ array_t* array_resize(array_t* array, uint32_t size);
 * @param data Memory which will overwrite the element in question.
 * @param index Which element to modify (starting from zero).
 */
-void* array_set(array_t* array, void* data, uint32_t index);
+void* array_set(array_t* array, void* data, size_t index);
 
 /** @brief Returns a pointer to the element at the given index.
 * Returns NULL if the index is invalid.
 * @param array Array from which to retrieve an element.
 * @param index Which element to retrieve.
 */
-void* array_get(array_t* array, uint32_t index);
+void* array_get(array_t* array, size_t index);
 
 /** @brief Returns a pointer to the first element */
 void* array_front(array_t* array);
@@ -95,7 +119,21 @@ void* array_end(array_t* array);
 * @param index Location where to insert the element.
 * 	A previous element at this index is displaced one position forward.
 */
-array_t* array_insert(array_t* array, void* element, uint32_t index);
+array_t* array_insert(array_t* array, void* element, size_t index);
+
+/** @brief Inserts a block of contiguous elements at the given index.
+* The elements after the index are displaced only once, and the block is copied in one go.
+* If the given elements are NULL, the inserted elements are zeroed.
+* The elements may be taken from the array itself, e.g. to duplicate its contents.
+* @param array Array object
+* @param elements Buffer of `count` elements to insert
+* @param count Number of elements to insert
+* @param index Location where to insert the first element.
+*/
+array_t* array_insert_range(array_t* array, const void* elements, size_t count, size_t index);
+
+/** @brief Inserts a block of contiguous elements at the end of the array, which may be taken from the array itself */
+array_t* array_push_back_n(array_t* array, const void* elements, size_t count);
 
 /** @brief Inserts an element at the end of the array */
 array_t* array_push_back(array_t* array, void* element);
@@ -107,7 +145,28 @@ array_t* array_push_front(array_t* array, void* element);
 /** @brief Removes the element at the given index.
 * Note that, whilst the size of the array is reduced, its capacity is not.
 */
-array_t* array_remove(array_t* array, uint32_t index);
+array_t* array_remove(array_t* array, size_t index);
+
+/** @brief Removes `count` consecutive elements starting at the given index.
+* The elements after the range are displaced only once.
+* Returns NULL if the range goes beyond the end of the array.
+*/
+array_t* array_remove_range(array_t* array, size_t index, size_t count);
+
+/** @brief Removes the element at the given index by moving the last element into its place.
+* Takes constant time, but does not preserve the order of the elements.
+*/
+array_t* array_swap_remove(array_t* array, size_t index);
+
+/** @brief Keeps only the elements for which `pred(element, args)` returns non-zero.
+* The order of the kept elements is preserved, and each of them is moved at most once.
+* Note that, whilst the size of the array is reduced, its capacity is not.
+* The predicate is called exactly once per element, in order.
+* @param pred predicate that decides whether an element is kept.
+* @param args argument passed to every call of the predicate.
+* @returns the number of removed elements, or 0 if the array or the predicate is NULL.
+*/
+size_t array_retain(array_t* array, int (*pred)(const void* element, void* args), void* args);
 
 /** @brief Removes the last element of the array */
 array_t* array_pop_back(array_t* array);
@@ -118,4 +177,65 @@ array_t* array_pop_front(array_t* array);
 /** @brief Removes all elements on the array */
 array_t* array_clear(array_t* array);
 
+/** @brief Sorts the elements of the array in ascending order.
+* The sort is not stable.
+* For an inlined comparison, instantiate `SORT_DEFINE` from sort.h over `array->data`.
+* @param cmp comparator with the same contract as that of `qsort`.
+*/
+array_t* array_sort(array_t* array, int (*cmp)(const void*, const void*));
+
+/** @brief Sorts the elements of the array in ascending order across the threads of a pool.
+* Small arrays are sorted on the calling thread (see `sort_buffer_parallel`).
+* The sort is not stable.
+* @param cmp comparator with the same contract as that of `qsort`.
+* @param pool pool whose threads sort the array, or NULL for `threadpool_default()`.
+*   Create a pool with `threadpool_create` to choose the number of threads.
+* @returns the input array, or NULL if the temporary buffer cannot be allocated.
+*/
+array_t* array_sort_parallel(array_t* array, int (*cmp)(const void*, const void*), threadpool_t* pool);
+
+/** @brief Returns the index of the first element not less than a key
+* in an array sorted in ascending order, or the array size if there is none.
+* @param key pointer to a value to compare elements with.
+* @param cmp comparator with the same contract as that of `qsort`.
+*/
+size_t array_lower_bound(array_t* array, const void* key, int (*cmp)(const void*, const void*));
+
+/** @brief Returns the index of the first element greater than a key
+* in an array sorted in ascending order, or the array size if there is none.
+* @param key pointer to a value to compare elements with.
+* @param cmp comparator with the same contract as that of `qsort`.
+*/
+size_t array_upper_bound(array_t* array, const void* key, int (*cmp)(const void*, const void*));
+
+/** @brief Initialises an array backed by a memory-mapped file.
+* The file is created if it does not exist, and its contents become the elements of the array,
+* which are paged in by the system on demand instead of being read up front.
+* Growing the array extends the file.
+* Should be freed with `array_uninit` or `array_destroy`,
+* which unmap the file and trim it to the size of the array.
+* Only available on POSIX systems.
+* @param array the return array.
+* @param path path to the file.
+* @param element_size size in bytes of an array element.
+* @returns input array, or NULL if the file cannot be mapped
+* or its size is not a multiple of the element size.
+*/
+array_t* array_map_file(array_t* array, const char* path, size_t element_size);
+
+/** @brief Writes the elements of a file-backed array to its file,
+* blocking until the write is complete.
+* The file is trimmed to the elements, and the capacity of the array is reduced to its size,
+* so the next insertion maps the file again.
+* @returns input array, or NULL on failure or if the array is not file-backed.
+*/
+array_t* array_sync(array_t* array);
+
+/** @brief Informs the system of how the elements of a file-backed array will be accessed,
+* so that it can tune read-ahead.
+* The hint applies to the current mapping, and should be repeated after the array grows.
+* @returns input array, or NULL on failure or if the array is not file-backed.
+*/
+array_t* array_advise(array_t* array, enum array_advice advice);
+
 #endif /* DATALIB_ARRAY_H */
\ No newline at end of file
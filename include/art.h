@@ -0,0 +1,103 @@
+/** @file art.h
+* Adaptive radix tree mapping byte keys to values.
+* Each inner node branches on one byte of the key and grows through four
+* layouts (4, 16, 48 and 256 children) as children are added, so sparse
+* nodes stay small. Runs of bytes shared by all keys below a node are stored
+* once in the node (path compression), and leaves only hold the part of their
+* key below their parent.
+* Lookups, prefix queries and longest-prefix matches take time proportional
+* to the length of the key, independently of the number of keys.
+*
+* A key may be a prefix of another key: such keys are stored in the node
+* where they end instead of in a leaf.
+*
+* Example code:
+* ```c
+*     art_t tree;
+*     art_init(&tree);
+*
+*     int x = 1, y = 2;
+*     art_setb(&tree, "/usr", 4, &x);
+*     art_setb(&tree, "/usr/lib", 8, &y);
+*
+*     uint32_t n;
+*     int* v = art_longest_prefix(&tree, "/usr/local", 10, &n); // &x, n = 4
+*
+*     art_uninit(&tree); // does not free stored values
+* ```
+*/
+
+#ifndef DATALIB_ART_H
+#define DATALIB_ART_H
+
+#include "defs.h"
+
+/** @struct art_t
+* @brief Adaptive radix tree of byte keys.
+*/
+typedef struct art {
+	void* root;		///< Root node or leaf, or NULL if the tree is empty
+	size_t size;	///< Number of keys
+} art_t;
+
+/** @brief Initialises an empty tree via a user-managed object.
+* Should be deleted using `art_uninit`.
+* @returns the input tree, or NULL if it is NULL.
+*/
+art_t* art_init(art_t* tree);
+
+/** @brief Frees all nodes of a tree.
+* It does not free the values, which are managed by the user.
+*/
+void art_uninit(art_t* tree);
+
+/** @brief Allocates and initialises an empty tree.
+* Destroy with `art_destroy`.
+*/
+art_t* art_create(void);
+
+/** @brief Deallocates a tree created with `art_create`.
+* It does not free the values.
+*/
+void art_destroy(art_t* tree);
+
+/** @brief Retrieves the value associated with a key.
+* @param key key to search for, which can be any set of bytes.
+* @param key_length number of bytes in the key.
+* @returns the value associated with the key, or NULL if the key does not exist.
+*/
+void* art_getb(art_t* tree, const void* key, uint32_t key_length);
+
+/** @brief Adds a key-value pair to a tree. If the key already exists, the value is replaced.
+* The key is copied, but only a pointer to the value is stored.
+* @returns the input tree, or NULL if memory cannot be allocated,
+* in which case the tree is unchanged.
+*/
+art_t* art_setb(art_t* tree, const void* key, uint32_t key_length, void* value);
+
+/** @brief Removes a key and returns its value, or NULL if the key does not exist.
+* Nodes shrink to smaller layouts and are merged with their only child when possible.
+*/
+void* art_removeb(art_t* tree, const void* key, uint32_t key_length);
+
+/** @brief Calls `fn(key, key_length, value, args)` for each key that starts with a prefix,
+* in lexicographic order. Iteration stops early if `fn` returns zero.
+* The key passed to `fn` is only valid during the call.
+* @param prefix bytes every visited key starts with. An empty prefix visits every key.
+* @param prefix_length number of bytes in the prefix.
+* @returns the number of calls to `fn`. Iteration also stops early if memory for the keys
+* cannot be allocated.
+*/
+size_t art_foreach_prefix(art_t* tree, const void* prefix, uint32_t prefix_length,
+                          int (*fn)(const void* key, uint32_t key_length, void* value, void* args),
+                          void* args);
+
+/** @brief Finds the longest stored key that is a prefix of a given key.
+* @param key key to match, which can be any set of bytes.
+* @param key_length number of bytes in the key.
+* @param match_length returns the length of the matched key, if not NULL.
+* @returns the value of the longest matching key, or NULL if no stored key is a prefix of the key.
+*/
+void* art_longest_prefix(art_t* tree, const void* key, uint32_t key_length, uint32_t* match_length);
+
+#endif /* DATALIB_ART_H */
@@ -0,0 +1,165 @@
+/** @file btree.h
+* Ordered map from byte keys to values implemented as a B+tree.
+* Nodes hold up to `BTREE_NODE_KEYS` keys. The first 8 bytes of every key
+* are stored contiguously in each node as big-endian integers, so a search
+* compares a few cache lines of integers and only reads the full key on a tie.
+* All values live in the leaves, which are chained in key order so that
+* ordered iteration and range scans read the leaves one after another.
+*
+* Example code:
+* ```c
+*     btree_t tree;
+*     btree_init(&tree);
+*
+*     int x = 10, y = 20;
+*     btree_set(&tree, "b", &x);
+*     btree_set(&tree, "a", &y);
+*
+*     btree_iter_t it;
+*     for(it = btree_begin(&tree); btree_iter_valid(&it); btree_next(&it)){
+*         printf("%s = %d\n", it.key, *(int*)it.value); // a = 20, b = 10
+*     }
+*
+*     btree_uninit(&tree); // does not free stored values
+* ```
+*/
+
+#ifndef DATALIB_BTREE_H
+#define DATALIB_BTREE_H
+
+#include "defs.h"
+
+/* Max number of keys in a node.
+   32 key prefixes take 256 bytes, i.e. four 64-byte cache lines. */
+#ifndef BTREE_NODE_KEYS
+	#define BTREE_NODE_KEYS 32
+#endif
+#if BTREE_NODE_KEYS < 3
+	#error "BTREE_NODE_KEYS must be at least 3"
+#endif
+
+/** @struct btree_key
+* @brief Key stored in a node. The bytes are owned by the tree.
+*/
+struct btree_key {
+	char* data;		///< Bytes of the key
+	uint32_t len;	///< Number of bytes of the key
+};
+
+/** @struct btree_node
+* @brief Node of a B+tree. Leaves hold values and internal nodes hold children.
+* Separator `keys[i]` of an internal node is the smallest key under `children[i+1]`.
+*/
+struct btree_node {
+	uint32_t n_keys;						///< Number of keys in the node
+	uint32_t leaf;							///< 1 for leaves and 0 for internal nodes
+	uint64_t prefixes[BTREE_NODE_KEYS];		///< First 8 bytes of each key as big-endian integers
+	union {
+		void* values[BTREE_NODE_KEYS];						///< Values of a leaf
+		struct btree_node* children[BTREE_NODE_KEYS + 1];	///< Children of an internal node
+	} slots;
+	struct btree_node* next;				///< Next leaf in key order
+	struct btree_key keys[BTREE_NODE_KEYS];	///< Full keys, only read when prefixes are equal
+};
+
+/** @struct btree_t
+* @brief Ordered map of byte keys to pointers.
+*/
+typedef struct btree {
+	struct btree_node* root;	///< Root node, or NULL if the tree is empty
+	size_t size;				///< Number of key-value pairs
+} btree_t;
+
+/** @struct btree_iter_t
+* @brief Position of a key-value pair in a tree.
+* Invalidated by any insertion or removal.
+*/
+typedef struct btree_iter {
+	struct btree_node* leaf;	///< Leaf of the current pair, or NULL past the end
+	uint32_t index;				///< Index of the current pair in the leaf
+	const char* key;			///< Current key
+	uint32_t key_length;		///< Number of bytes of the current key
+	void* value;				///< Current value
+} btree_iter_t;
+
+/** @brief Initialises an empty tree via a user-managed object.
+* Should be deleted using `btree_uninit`.
+* @returns the input tree, or NULL if it is NULL.
+*/
+btree_t* btree_init(btree_t* tree);
+
+/** @brief Frees all nodes and keys of a tree.
+* It does not free the values, which are managed by the user.
+*/
+void btree_uninit(btree_t* tree);
+
+/** @brief Allocates and initialises an empty tree.
+* Destroy with `btree_destroy`.
+*/
+btree_t* btree_create(void);
+
+/** @brief Deallocates a tree created with `btree_create`.
+* It does not free the values.
+*/
+void btree_destroy(btree_t* tree);
+
+/** @brief Retrieves the value associated with a key.
+* @param key key to search for, which can be any set of bytes.
+* @param key_length number of bytes in the key.
+* @returns the value associated with the key, or NULL if the key does not exist.
+*/
+void* btree_getb(btree_t* tree, const void* key, uint32_t key_length);
+
+/** @brief Retrieves the value associated with a null-terminated string key (see `btree_getb`) */
+void* btree_get(btree_t* tree, const char* key);
+
+/** @brief Adds a key-value pair to a tree. If the key already exists, the value is replaced.
+* The key is copied, but only a pointer to the value is stored.
+* @param key key to insert, which can be any set of bytes.
+* @param key_length number of bytes in the key.
+* @returns the input tree, or NULL if memory cannot be allocated.
+*/
+btree_t* btree_setb(btree_t* tree, const void* key, uint32_t key_length, void* value);
+
+/** @brief Adds a pair with a null-terminated string key (see `btree_setb`).
+* The terminator is part of the key, as in `hashmap_set`.
+*/
+btree_t* btree_set(btree_t* tree, const char* key, void* value);
+
+/** @brief Removes a key and returns its value, or NULL if the key does not exist.
+* Nodes are not merged when they become sparse; empty leaves stay in the chain
+* until the tree is cleared.
+*/
+void* btree_removeb(btree_t* tree, const void* key, uint32_t key_length);
+
+/** @brief Removes a null-terminated string key (see `btree_removeb`) */
+void* btree_remove(btree_t* tree, const char* key);
+
+/** @brief Fills an empty tree with keys in strictly ascending order.
+* Leaves and internal nodes are built bottom-up and filled to capacity,
+* without the searches and splits of repeated insertions.
+* @param keys pointers to the keys.
+* @param key_lengths number of bytes of each key.
+* @param values value of each key.
+* @param n number of keys.
+* @returns the input tree, or NULL if the tree is not empty, the keys are not
+* strictly ascending or memory cannot be allocated, in which case the tree stays empty.
+*/
+btree_t* btree_load_sortedb(btree_t* tree, const void* const* keys, const uint32_t* key_lengths,
+                            void* const* values, size_t n);
+
+/** @brief Returns an iterator to the smallest key of the tree */
+btree_iter_t btree_begin(btree_t* tree);
+
+/** @brief Returns an iterator to the smallest key not less than a given key.
+* Iterating from it while keys are below an upper bound scans a range in order.
+*/
+btree_iter_t btree_lower_bound(btree_t* tree, const void* key, uint32_t key_length);
+
+/** @brief Returns 1 if an iterator points to a key-value pair, and 0 past the end */
+int btree_iter_valid(const btree_iter_t* it);
+
+/** @brief Advances an iterator to the next key in order */
+void btree_next(btree_iter_t* it);
+
+#endif /* DATALIB_BTREE_H */
@@ -14,4 +14,44 @@
     #define DATALIB_MEMMOVE memmove
 #endif
 
-#endif /* DATALIB_DEFS_H */
\ No newline at end of file
+/* File-backed containers rely on POSIX `mmap`, and thread pools on POSIX threads */
+#if defined(__unix__) || defined(__APPLE__)
+    #define DATALIB_HAS_MMAP
+    #define DATALIB_HAS_THREADS
+#endif
+
+/* Alignment in bytes of the element storage of vec, array_t and numv.
+ * Defaults to the size of a cache line, which also satisfies AVX-512 loads.
+ * Must be a power of two no smaller than `sizeof(void*)`.
+ */
+#ifndef DATALIB_ALIGNMENT
+    #define DATALIB_ALIGNMENT 64
+#endif
+
+/* Rounds a number of bytes `n` up to a multiple of `DATALIB_ALIGNMENT` */
+#define DATALIB_ALIGN_UP(n) \
+    (((size_t)(n) + DATALIB_ALIGNMENT - 1) & ~((size_t)DATALIB_ALIGNMENT - 1))
+
+#define DATALIB_ALIGNED_ALLOC datalib_aligned_alloc
+#define DATALIB_ALIGNED_FREE  datalib_aligned_free
+
+/* Allocates `size` bytes aligned to `DATALIB_ALIGNMENT`.
+ * The block is over-allocated with `DATALIB_ALLOC` and the original pointer
+ * is stored right before the returned address.
+ * Must be freed with `datalib_aligned_free`.
+ */
+static inline void* datalib_aligned_alloc(size_t size){
+    char* raw = DATALIB_ALLOC(size + DATALIB_ALIGNMENT + sizeof(void*));
+    if(!raw) return NULL;
+    char* aligned = (char*)DATALIB_ALIGN_UP((uintptr_t)(raw + sizeof(void*)));
+    ((void**)aligned)[-1] = raw;
+    return aligned;
+}
+
+/* Frees a block allocated with `datalib_aligned_alloc` */
+static inline void datalib_aligned_free(void* ptr){
+    if(!ptr) return;
+    DATALIB_FREE(((void**)ptr)[-1]);
+}
+
+#endif /* DATALIB_DEFS_H */
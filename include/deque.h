@@ -0,0 +1,122 @@
+/** @file deque.h
+* Double-ended queue of generic elements stored in a ring buffer.
+* Elements can be added and removed at both ends in constant time,
+* which makes it a better fit for FIFO queues than `vec` or `array_t`.
+*
+* Example code:
+* ```c
+*     deque_t q;
+*     deque_init(&q, sizeof(int));
+*
+*     int x = 10, y = 20;
+*     deque_push_back(&q, &x);
+*     deque_push_back(&q, &y);
+*
+*     int a = *(int*)deque_front(&q); // 10
+*     deque_pop_front(&q);
+*
+*     deque_uninit(&q);
+* ```
+*/
+
+#ifndef DATALIB_DEQUE_H
+#define DATALIB_DEQUE_H
+
+#include "defs.h"
+
+/** @struct deque_t
+* @brief Ring buffer of generic elements.
+* The capacity is always zero or a power of two, so that positions
+* wrap around the buffer with a bit mask instead of a division.
+*/
+typedef struct deque_container {
+	char* data;				/**< Ring buffer, aligned to `DATALIB_ALIGNMENT` */
+	size_t head;			/**< Position in the buffer of the first element */
+	size_t size;			/**< Number of stored elements */
+	size_t capacity;		/**< Max number of elements allocated */
+	size_t element_size;	/**< Size in bytes of an element */
+} deque_t;
+
+/** @brief Initialises a deque via a given pointer.
+*   Should be freed with `deque_uninit`.
+*	@param deque the return deque.
+*	@param element_size size in bytes of an element.
+*   @returns input deque or NULL if element_size is zero.
+*/
+void* deque_init(deque_t* deque, size_t element_size);
+
+/** @brief Resets the deque state and frees the ring buffer.
+*	@param deque the deque to uninitialise.
+*/
+void deque_uninit(deque_t* deque);
+
+/** @brief Returns a pointer to a new deque allocated on the heap.
+*   Should be later freed with `deque_destroy`.
+*	@param element_size size in bytes of an element.
+*/
+deque_t* deque_create(size_t element_size);
+
+/** @brief Frees an allocated deque
+*	@param deque the deque to deallocate.
+*/
+void deque_destroy(deque_t* deque);
+
+/** @brief Allocates space for at least `capacity` elements.
+* The capacity is rounded up to a power of two and never shrinks.
+* @returns the input deque, or NULL if the allocation failed.
+*/
+deque_t* deque_reserve(deque_t* deque, size_t capacity);
+
+/** @brief Returns a pointer to the element at the given index,
+* counting from the front of the deque.
+* Returns NULL if the index is invalid.
+*/
+void* deque_get(deque_t* deque, size_t index);
+
+/** @brief Returns a pointer to the first element */
+void* deque_front(deque_t* deque);
+
+/** @brief Returns a pointer to the last element */
+void* deque_back(deque_t* deque);
+
+/** @brief Inserts an element at the end of the deque.
+* If the given element is NULL, the inserted element is zeroed.
+* The element may be one of the deque itself, e.g. from `deque_front`.
+*/
+deque_t* deque_push_back(deque_t* deque, const void* element);
+
+/** @brief Inserts an element at the beginning of the deque.
+* If the given element is NULL, the inserted element is zeroed.
+* The element may be one of the deque itself, e.g. from `deque_front`.
+*/
+deque_t* deque_push_front(deque_t* deque, const void* element);
+
+/** @brief Removes the last element of the deque */
+deque_t* deque_pop_back(deque_t* deque);
+
+/** @brief Removes the first element of the deque */
+deque_t* deque_pop_front(deque_t* deque);
+
+/** @brief Removes the first `n` elements of the deque.
+* Pairs with `deque_segments` to consume elements read in bulk.
+* Returns NULL if the deque holds fewer than `n` elements.
+*/
+deque_t* deque_pop_front_n(deque_t* deque, size_t n);
+
+/** @brief Returns the elements of the deque as (up to) two contiguous segments.
+* The elements in `first` come before those in `second`,
+* and `second` is empty unless the elements wrap around the end of the buffer.
+* The pointers remain valid until the deque is modified.
+* @param first returns a pointer to the first segment, or NULL if the deque is empty.
+* @param first_size returns the number of elements in the first segment.
+* @param second returns a pointer to the second segment, or NULL if there is none.
+* @param second_size returns the number of elements in the second segment.
+* @returns the total number of elements.
+*/
+size_t deque_segments(deque_t* deque, void** first, size_t* first_size,
+                      void** second, size_t* second_size);
+
+/** @brief Removes all elements on the deque */
+deque_t* deque_clear(deque_t* deque);
+
+#endif /* DATALIB_DEQUE_H */
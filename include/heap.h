@@ -0,0 +1,112 @@
+/** @file heap.h
+ * Priority queue over a datalib vector (see vec.h).
+ * The elements of the vector are kept in d-ary heap order with respect to
+ * a `qsort`-style comparator, so that the smallest element is at index 0.
+ * Invert the comparator to keep the largest element at the top instead.
+ *
+ * Each node has `DATALIB_HEAP_ARITY` children. Wider nodes make the heap
+ * shallower and keep the children of a node in the same cache line.
+ *
+ * Example:
+ *      int* heap = vec_init(int);
+ *      heap_push(heap, 5, cmp_int);
+ *      heap_push(heap, 2, cmp_int);
+ *      printf("%d\n", *heap_peek(heap)); // 2
+ *      heap_pop(heap, cmp_int);
+ *      vec_free(heap);
+ *
+ */
+
+#ifndef DATALIB_HEAP_H
+#define DATALIB_HEAP_H
+
+#include "defs.h"
+#include "vec.h"
+
+/* Number of children of each node of the heaps built by the macros */
+#ifndef DATALIB_HEAP_ARITY
+    #define DATALIB_HEAP_ARITY 4
+#endif
+
+/* --- Macro functions --- */
+
+/* Returns a pointer to the smallest element of a heap V, or NULL if it is empty */
+#define heap_peek(V) (vec_empty((V)) ? NULL : (V))
+
+/* Adds an element E to a heap V ordered by a comparator CMP */
+#define heap_push(V, E, CMP) \
+    do { \
+        vec_push((V), (E)); \
+        _heap_sift_up((V), sizeof(*(V)), vec_size((V))-1, DATALIB_HEAP_ARITY, (CMP)); \
+    } while(0)
+
+/* Removes the smallest element of a heap V ordered by a comparator CMP */
+#define heap_pop(V, CMP) _heap_pop((V), sizeof(*(V)), DATALIB_HEAP_ARITY, (CMP))
+
+/* Replaces the smallest element of a non-empty heap V with an element E.
+ * Cheaper than a pop followed by a push.
+ */
+#define heap_replace_top(V, E, CMP) \
+    do { \
+        if(!vec_empty((V))){ \
+            (V)[0] = (E); \
+            _heap_sift_down((V), sizeof(*(V)), 0, DATALIB_HEAP_ARITY, (CMP)); \
+        } \
+    } while(0)
+
+/* Arranges the elements of a vector V into a heap ordered by a comparator CMP in linear time */
+#define heap_heapify(V, CMP) _heap_heapify((V), sizeof(*(V)), DATALIB_HEAP_ARITY, (CMP))
+
+/* Offers the element pointed to by P to a heap V that keeps the K greatest elements seen.
+ * The heap grows until it holds K elements. From then on, an element greater than
+ * the top replaces it, so no further memory is allocated.
+ * A stream of n elements is processed in O(n log K).
+ */
+#define heap_topk_push(V, K, P, CMP) \
+    do { \
+        void* temp__ = _heap_topk_push((V), sizeof(*(V)), (K), (P), DATALIB_HEAP_ARITY, (CMP)); \
+        if(temp__) (V) = temp__; \
+    } while(0)
+
+/* Sorts a heap V in descending order by repeatedly moving its top to the end.
+ * The vector is no longer a heap afterwards.
+ */
+#define heap_sort(V, CMP) _heap_sort((V), sizeof(*(V)), DATALIB_HEAP_ARITY, (CMP))
+
+
+/* --- Functions --- */
+/*  Can be used directly to choose the arity of a heap.
+ *  A heap must always be accessed with the same arity.
+ *  Elements larger than `HEAP_STACK_BYTES` bytes need a temporary allocation per call.
+ */
+
+/* Max size in bytes of an element moved without heap allocation */
+#define HEAP_STACK_BYTES 256
+
+/* Moves the element at index `index` of a heap `vec` up to its place */
+void _heap_sift_up(void* vec, size_t item_size, size_t index, size_t arity,
+                   int (*cmp)(const void*, const void*));
+
+/* Moves the element at index `index` of a heap `vec` down to its place */
+void _heap_sift_down(void* vec, size_t item_size, size_t index, size_t arity,
+                     int (*cmp)(const void*, const void*));
+
+/* Removes the smallest element of a heap `vec` */
+void _heap_pop(void* vec, size_t item_size, size_t arity,
+               int (*cmp)(const void*, const void*));
+
+/* Arranges the elements of a vector `vec` into a heap */
+void _heap_heapify(void* vec, size_t item_size, size_t arity,
+                   int (*cmp)(const void*, const void*));
+
+/* Offers an element to a heap `vec` that keeps the `k` greatest elements.
+ * Returns the vector, which may have been reallocated, or NULL on failure.
+ */
+void* _heap_topk_push(void* vec, size_t item_size, size_t k, const void* item, size_t arity,
+                      int (*cmp)(const void*, const void*));
+
+/* Sorts a heap `vec` in descending order */
+void _heap_sort(void* vec, size_t item_size, size_t arity,
+                int (*cmp)(const void*, const void*));
+
+#endif /* DATALIB_HEAP_H */
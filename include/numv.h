@@ -2,8 +2,14 @@
 #define DATALIB_NUMV_H
 
 #include "defs.h"
+#include "threadpool.h"
 
+#include <stddef.h> /* ptrdiff_t */
 
+
+/* Header stored before the items of a numv array.
+ * It is padded to `DATALIB_ALIGNMENT` bytes so that the items are aligned.
+ */
 struct numv {
     size_t size; /* Number of items in the array */
     double data[]; /* Pointer to the array items */
@@ -17,6 +23,29 @@ size_t numv_size(void* v);
 /* Returns a pointer to the end of a numv array */
 double* numv_end(double* nv);
 
+/* --- Threads --- */
+
+/* Number of items from which element-wise operations, `numv_apply`, reductions
+ * and expressions split the work across a thread pool.
+ * Reductions give the same results with any number of threads.
+ */
+#ifndef NUMV_PARALLEL_THRESHOLD
+    #define NUMV_PARALLEL_THRESHOLD 262144
+#endif
+
+/* Set the pool used for large arrays, or NULL for `threadpool_default()`.
+ * numv functions called from tasks of that pool, e.g. from the function passed to `numv_apply`
+ * or from a comparator of `array_sort_parallel`, run on the thread of the task.
+ * Should not be called while numv functions run on other threads.
+ */
+void numv_set_threadpool(threadpool_t* pool);
+
+/* Set the number of items from which numv uses several threads,
+ * `SIZE_MAX` to always run on the calling thread.
+ * Should not be called while numv functions run on other threads.
+ */
+void numv_set_parallel_threshold(size_t n);
+
 /* --- Destructor --- */
 /* Free a numv array */
 void numv_free(void* p);
@@ -49,6 +78,8 @@ double* numv_copy(double* nv);
 /* Create a new numv array from a 'slice' of another.
  * e.g. the items between two indices [i,j] inclusive.
  * The indices may be negative to indicate index from the back of the array.
+ * Returns NULL if the slice is empty or memory cannot be allocated.
+ * `numv_view_slice` selects the same items without copying them.
  */
 double* numv_slice(double* nv, long i, long j);
 
@@ -62,16 +93,57 @@ double* numv_concat_n(size_t n, ...);
 /* --- Transforms --- */
 
 /* Self */
-/* Apply a function `fn` that takes extra arguments to a numv array */
+/* Apply a function `fn` that takes extra arguments to a numv array.
+ * On large arrays `fn` is called from several threads at once.
+ */
 double* numv_apply_args(double* nv, double (*fn)(double,void*), void* args);
 
-/* Apply a function `fn` to a numv array */
+/* Apply a function `fn` to a numv array.
+ * On large arrays `fn` is called from several threads at once.
+ */
 double* numv_apply(double* nv, double (*fn)(double));
 
+/* Number of items passed at once to the function of `numv_apply_block`,
+ * so that a block of input and output stays in the L1 cache.
+ */
+#ifndef NUMV_APPLY_BLOCK
+    #define NUMV_APPLY_BLOCK 1024
+#endif
+
+/* Apply a function `fn` to a numv array in blocks of at most `NUMV_APPLY_BLOCK` items.
+ * `fn(in, out, n, args)` writes the results for the `n` items of `in` to `out`,
+ * which here is the same buffer as `in`.
+ * Unlike a call per item, the loop of `fn` over a block can be vectorised by the compiler.
+ * On large arrays `fn` is called from several threads at once.
+ */
+double* numv_apply_block(double* nv, void (*fn)(const double* in, double* out, size_t n, void* args), void* args);
+
+/* Same as `numv_apply_block`, writing the results into an array `dst` of the same size as `a`.
+ * Returns `dst`, or NULL if an input is NULL or the sizes differ.
+ * `dst` may be `a`, then `in` and `out` are the same buffer.
+ */
+double* numv_apply_block_into(double* dst, double* a,
+                              void (*fn)(const double* in, double* out, size_t n, void* args), void* args);
+
+/* Element-wise functions computed in place, returning `nv`.
+ * sqrt uses SIMD instructions, cbrt, exp and log give the same results as the C library.
+ */
 double* numv_sqrt(double* nv);
 double* numv_cbrt(double* nv);
+double* numv_exp(double* nv);
+double* numv_log(double* nv);
+
+/* Replace the NaNs of a numv array with `value`, in place, and return it */
 double* numv_replace_nans(double* nv, double value);
 
+/* Element-wise arithmetic.
+ * Each operation returns a new array, or NULL if an input is NULL,
+ * the sizes of `a` and `b` differ, or memory cannot be allocated.
+ * Additions, subtractions, multiplications and divisions use the widest SIMD
+ * instructions supported by the CPU (SSE2, AVX2 or AVX-512), selected at startup,
+ * and give the same results as a scalar loop.
+ */
+
 /* array - array */
 double* numv_add(double* a, double* b);
 double* numv_sub(double* a, double* b);
@@ -87,21 +159,224 @@ double* numv_mults(double* a, double value);
 double* numv_divs(double* a, double value);
 double* numv_pows(double* a, double value);
 
+/* Destination forms of the element-wise arithmetic.
+ * They write the result into an existing array `dst` instead of allocating one,
+ * and return `dst`, or NULL if an input is NULL or the sizes differ (then `dst` is unchanged).
+ * `dst` may be the same array as `a` or `b`, e.g. `numv_mult_into(a, a, b)` computes a *= b.
+ * Any other overlap between `dst` and the inputs gives undefined results.
+ */
+double* numv_add_into(double* dst, double* a, double* b);
+double* numv_sub_into(double* dst, double* a, double* b);
+double* numv_mult_into(double* dst, double* a, double* b);
+double* numv_div_into(double* dst, double* a, double* b);
+double* numv_pow_into(double* dst, double* a, double* b);
+double* numv_hypot_into(double* dst, double* a, double* b);
+
+double* numv_adds_into(double* dst, double* a, double value);
+double* numv_subs_into(double* dst, double* a, double value);
+double* numv_mults_into(double* dst, double* a, double value);
+double* numv_divs_into(double* dst, double* a, double value);
+double* numv_pows_into(double* dst, double* a, double value);
+
+/* In-place forms, which store the result in `a` and return it.
+ * Same as the `_into` forms with `dst` equal to `a`.
+ */
+double* numv_add_inplace(double* a, double* b);
+double* numv_sub_inplace(double* a, double* b);
+double* numv_mult_inplace(double* a, double* b);
+double* numv_div_inplace(double* a, double* b);
+double* numv_pow_inplace(double* a, double* b);
+double* numv_hypot_inplace(double* a, double* b);
+
+double* numv_adds_inplace(double* a, double value);
+double* numv_subs_inplace(double* a, double value);
+double* numv_mults_inplace(double* a, double value);
+double* numv_divs_inplace(double* a, double value);
+double* numv_pows_inplace(double* a, double value);
+
 
 
 /* --- Aggregate --- */
 
+/* Summary statistics of a numv array, see `numv_describe` */
+struct numv_stats {
+    size_t count; /* Number of items */
+    double min; /* Smallest item, ignoring NaNs */
+    double max; /* Largest item, ignoring NaNs */
+    double mean; /* Arithmetic mean */
+    double std; /* Population standard deviation */
+};
+
+/* Fold a numv array with a function `fn`, from the first item to the last.
+ * Returns NAN if the array is empty.
+ */
 double numv_agg(double* nv, double (*fn)(double,double));
 
-double numv_mean();
-double numv_median();
-double numv_mode();
-double numv_std();
-double numv_max();
-double numv_min();
-double numv_sum();
-size_t numv_imax();
-size_t numv_imin();
+/* Sums use SIMD partial sums over blocks of items that are combined pairwise,
+ * so that the rounding error grows with the logarithm of the size instead of the size.
+ * The order of the operations does not depend on the CPU, so results are reproducible.
+ * NaNs propagate to the sum, mean and standard deviation.
+ */
+double numv_sum(double* nv); /* 0 if the array is empty */
+double numv_mean(double* nv); /* NAN if the array is empty */
+double numv_std(double* nv); /* Population standard deviation, NAN if the array is empty */
+
+/* Compute the count, min, max, mean and standard deviation of an array in one pass.
+ * The mean and the variance of each block are merged with Chan's pairwise update.
+ */
+struct numv_stats numv_describe(double* nv);
+
+/* Smallest and largest items, ignoring NaNs.
+ * Return NAN if the array is empty or only contains NaNs.
+ */
+double numv_min(double* nv);
+double numv_max(double* nv);
+
+/* Index of the first smallest or largest item, ignoring NaNs.
+ * Return the size of the array if it is empty or only contains NaNs.
+ */
+size_t numv_imin(double* nv);
+size_t numv_imax(double* nv);
+
+
+/* --- Order statistics --- */
+
+/* Order statistics run in linear time on average: the items are partially ordered
+ * with an introselect, which partitions like quicksort but only recurses
+ * into the ranges holding the wanted ranks, and falls back to sorting a range
+ * that is partitioned too unevenly.
+ * They return NAN if the array contains a NaN.
+ * The `_inplace` forms reorder the items of the array instead of working on a copy.
+ */
+
+/* Middle item, or the mean of the two middle items if the size is even.
+ * Returns NAN if the array is empty.
+ */
+double numv_median(double* nv);
+double numv_median_inplace(double* nv);
+
+/* Quantiles of the array for the `k` probabilities `probs` between 0 and 1,
+ * interpolated linearly between the two nearest items, e.g. 0.5 is the median.
+ * All the quantiles are selected in one partitioning pass over the array.
+ * Returns a new numv array of `k` items, or NULL if the array is empty, `k` is 0,
+ * a probability is not between 0 and 1, or memory cannot be allocated.
+ */
+double* numv_quantiles(double* nv, const double* probs, size_t k);
+double* numv_quantiles_inplace(double* nv, const double* probs, size_t k);
+
+/* Most frequent item, or the smallest of them on a tie, with -0 counted as 0.
+ * The items are counted in a hash table, which needs no copy of the array.
+ * Returns NAN if the array is empty or memory cannot be allocated.
+ */
+double numv_mode(double* nv);
+
+
+/* --- Sorting --- */
+
+/* Number of items from which `numv_sort` and `numv_argsort` use a radix sort */
+#ifndef NUMV_SORT_RADIX_THRESHOLD
+    #define NUMV_SORT_RADIX_THRESHOLD 1024
+#endif
+
+/* Sort the items of an array in ascending order, in place, with NaNs last.
+ * Arrays of at least `NUMV_SORT_RADIX_THRESHOLD` items are sorted with an LSD radix sort
+ * over the IEEE-754 bit patterns, mapped to integers in the same order as the values,
+ * 11 bits per pass; passes over bits that are the same for all items are skipped.
+ * The radix sort needs a temporary buffer of the size of the array;
+ * smaller arrays, or those for which the buffer cannot be allocated,
+ * are sorted in place with an introsort. Both place -0 before 0.
+ * Returns `nv`.
+ */
+double* numv_sort(double* nv);
+
+/* Indices of the items of an array in ascending order of their values, with NaNs last.
+ * The sort is stable: equal items, including -0 and 0, keep their order.
+ * Returns a new array of `numv_size(nv)` indices, freed with `numv_free`,
+ * or NULL if the array is empty or memory cannot be allocated.
+ */
+size_t* numv_argsort(double* nv);
+
+
+/* --- Views --- */
+
+/* Items of a buffer spaced `stride` items apart, e.g. a window, every other item,
+ * or the items in reverse order of a numv array.
+ * A view does not own its items, which must stay valid while it is used,
+ * and is passed by value. Creating and slicing views copies no items.
+ */
+typedef struct numv_view {
+    double* data; /* First item, NULL if the view is empty */
+    size_t size; /* Number of items */
+    ptrdiff_t stride; /* Distance in items from an item to the next, may be negative or 0 */
+} numv_view_t;
+
+/* View of all the items of a numv array, empty if it is NULL */
+numv_view_t numv_view(double* nv);
+
+/* View of `n` items of any buffer starting at `data`, e.g. a column of a struct of arrays.
+ * A stride of 0 repeats the first item `n` times.
+ */
+numv_view_t numv_view_of(double* data, size_t n, ptrdiff_t stride);
+
+/* View of the items from index `i` to index `j` inclusive, every `step` items.
+ * The indices may be negative to index from the back of the view.
+ * A negative step goes backwards from `i` down to `j`, e.g. (-1, 0, -1) reverses the view.
+ * Returns an empty view if an index is out of range, the step is 0,
+ * or it does not go from `i` toward `j`.
+ */
+numv_view_t numv_view_slice(numv_view_t v, long i, long j, long step);
+
+/* Copy the items of a view into a new numv array.
+ * Returns NULL if the view is empty or memory cannot be allocated.
+ */
+double* numv_materialize(numv_view_t v);
+
+/* Element-wise arithmetic on views, returning a new numv array,
+ * or NULL if a view is empty, the sizes differ, or memory cannot be allocated.
+ * Strided views are gathered in blocks that stay in cache and computed with the same kernels.
+ */
+double* numv_view_add(numv_view_t a, numv_view_t b);
+double* numv_view_sub(numv_view_t a, numv_view_t b);
+double* numv_view_mult(numv_view_t a, numv_view_t b);
+double* numv_view_div(numv_view_t a, numv_view_t b);
+double* numv_view_pow(numv_view_t a, numv_view_t b);
+double* numv_view_hypot(numv_view_t a, numv_view_t b);
+
+double* numv_view_adds(numv_view_t a, double value);
+double* numv_view_subs(numv_view_t a, double value);
+double* numv_view_mults(numv_view_t a, double value);
+double* numv_view_divs(numv_view_t a, double value);
+double* numv_view_pows(numv_view_t a, double value);
+
+/* Destination forms, writing the result into the items of the view `dst`.
+ * Return `dst.data`, or NULL if a view is empty or the sizes differ (then `dst` is unchanged).
+ * `dst` may be the same view as `a` or `b`, e.g. `numv_view_adds_into(v, v, 1.0)`
+ * adds 1 to every item of a window. Any other overlap gives undefined results.
+ */
+double* numv_view_add_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+double* numv_view_sub_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+double* numv_view_mult_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+double* numv_view_div_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+double* numv_view_pow_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+double* numv_view_hypot_into(numv_view_t dst, numv_view_t a, numv_view_t b);
+
+double* numv_view_adds_into(numv_view_t dst, numv_view_t a, double value);
+double* numv_view_subs_into(numv_view_t dst, numv_view_t a, double value);
+double* numv_view_mults_into(numv_view_t dst, numv_view_t a, double value);
+double* numv_view_divs_into(numv_view_t dst, numv_view_t a, double value);
+double* numv_view_pows_into(numv_view_t dst, numv_view_t a, double value);
+
+/* Reductions over views, as for numv arrays.
+ * Sums, means and standard deviations are the same as those of the materialised items.
+ */
+double numv_view_sum(numv_view_t v);
+double numv_view_mean(numv_view_t v);
+double numv_view_std(numv_view_t v);
+struct numv_stats numv_view_describe(numv_view_t v);
+double numv_view_min(numv_view_t v);
+double numv_view_max(numv_view_t v);
+size_t numv_view_imin(numv_view_t v);
+size_t numv_view_imax(numv_view_t v);
 
 
 
@@ -0,0 +1,94 @@
+#ifndef DATALIB_NUMV_EXPR_H
+#define DATALIB_NUMV_EXPR_H
+
+#include "numv.h"
+
+/* Lazy element-wise expressions over numv arrays.
+ * An expression records a tree of operations without computing anything.
+ * Evaluating it makes a single pass over the inputs in tiles of `NUMV_EXPR_TILE`
+ * items, computing every operation on a tile while it is in cache,
+ * so no intermediate array is allocated.
+ *
+ * e.g. sqrt(a*a + b*b) - 1:
+ *     numv_expr_t* e = numv_expr_subs(
+ *         numv_expr_sqrt(numv_expr_add(
+ *             numv_expr_mult(numv_expr_array(a), numv_expr_array(a)),
+ *             numv_expr_mult(numv_expr_array(b), numv_expr_array(b)))),
+ *         1.0);
+ *     double* result = numv_expr_eval(e);
+ *     numv_expr_free(e);
+ *
+ * Building a node takes ownership of its operands, which are freed with it,
+ * so a node can only be used once as an operand.
+ * If an operand is NULL or memory cannot be allocated, the other operands are
+ * freed and NULL is returned, so that nested calls need a single check at the end.
+ */
+
+/* Number of items computed per operation before moving to the next one */
+#ifndef NUMV_EXPR_TILE
+    #define NUMV_EXPR_TILE 512
+#endif
+
+typedef struct numv_expr numv_expr_t;
+
+/* Free an expression and all its operands. The arrays it refers to are not freed. */
+void numv_expr_free(numv_expr_t* e);
+
+/* --- Leaves --- */
+
+/* Expression reading the items of a numv array, which is not copied
+ * and must stay valid until the expression is evaluated.
+ */
+numv_expr_t* numv_expr_array(double* nv);
+
+/* Expression with the same value for every item */
+numv_expr_t* numv_expr_scalar(double value);
+
+/* --- Operations --- */
+
+numv_expr_t* numv_expr_add(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_sub(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_mult(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_div(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_pow(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_hypot(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_sqrt(numv_expr_t* a);
+
+/* Shorthands for an operation with a scalar */
+numv_expr_t* numv_expr_adds(numv_expr_t* a, double value);
+numv_expr_t* numv_expr_subs(numv_expr_t* a, double value);
+numv_expr_t* numv_expr_mults(numv_expr_t* a, double value);
+numv_expr_t* numv_expr_divs(numv_expr_t* a, double value);
+numv_expr_t* numv_expr_pows(numv_expr_t* a, double value);
+
+/* Comparisons, giving 1.0 where they hold and 0.0 elsewhere.
+ * Comparisons with NaN are false, except for `ne`.
+ */
+numv_expr_t* numv_expr_lt(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_le(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_gt(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_ge(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_eq(numv_expr_t* a, numv_expr_t* b);
+numv_expr_t* numv_expr_ne(numv_expr_t* a, numv_expr_t* b);
+
+/* --- Evaluation --- */
+
+/* Size of the arrays of an expression,
+ * or 0 if it has no array or its arrays have different sizes.
+ */
+size_t numv_expr_size(numv_expr_t* e);
+
+/* Evaluate an expression into a new numv array.
+ * Returns NULL if the expression is NULL, its size is 0, or memory cannot be allocated.
+ * The expression is not freed and can be evaluated again.
+ */
+double* numv_expr_eval(numv_expr_t* e);
+
+/* Evaluate an expression into an existing array `dst` of the same size, and return it.
+ * An expression of scalars only fills `dst`.
+ * `dst` may be one of the arrays of the expression.
+ * Returns NULL if the sizes differ or memory cannot be allocated, leaving `dst` unchanged.
+ */
+double* numv_expr_eval_into(double* dst, numv_expr_t* e);
+
+#endif /* DATALIB_NUMV_EXPR_H */
@@ -0,0 +1,113 @@
+#ifndef DATALIB_NUMV_TYPES_H
+#define DATALIB_NUMV_TYPES_H
+
+#include "numv.h"
+
+/* numv arrays of other item types:
+ *     numv_f32 holds `float`, numv_i32 holds `int32_t` and numv_i64 holds `int64_t`.
+ * They have the same layout as numv arrays, so `numv_size`, `numv_free` and `numv_free_n`
+ * work on them, and the same functions with the type after `numv_`, e.g. `numv_f32_add`.
+ *
+ * Single-precision arithmetic and reductions use SIMD kernels like numv,
+ * with twice as many items per instruction and half the memory traffic.
+ * Sums of floats are computed in double precision.
+ * Integer arithmetic wraps around on overflow, and integer division by zero gives 0.
+ * These functions run on the calling thread.
+ */
+
+/* Functions of each type, where T is the item type and SUM_T the type of sums
+ * (double for f32, int64_t for the integer types):
+ *
+ * Constructors, returning NULL if `n` is 0 or memory cannot be allocated:
+ *     T* numv_<type>_empty(size_t n)
+ *     T* numv_<type>_full(size_t n, T value)
+ *     T* numv_<type>_zeros(size_t n)
+ *     T* numv_<type>_range(double start, double end, size_t n), converted as below
+ *     T* numv_<type>_from_array(size_t n, const T* data)
+ *     T* numv_<type>_copy(T* nv)
+ *
+ * Element-wise arithmetic, as for numv: `add`, `sub`, `mult` and `div` on two arrays,
+ * `adds`, `subs`, `mults` and `divs` with a scalar, each with `_into` and `_inplace` forms.
+ *
+ * Reductions:
+ *     SUM_T numv_<type>_sum(T* nv), 0 if the array is empty, wrapping around for integers
+ *     double numv_<type>_mean(T* nv), NAN if the array is empty
+ *     double numv_<type>_std(T* nv), population standard deviation, NAN if the array is empty
+ *     T numv_<type>_min(T* nv), T numv_<type>_max(T* nv), ignoring NaNs,
+ *         NAN for f32 and 0 for integers if there is no item
+ *     size_t numv_<type>_imin(T* nv), size_t numv_<type>_imax(T* nv),
+ *         index of the first min or max, or the size of the array if there is none
+ */
+#define NUMV__DECLARE_TYPE(PREFIX, T, SUM_T) \
+T* PREFIX##_empty(size_t n); \
+T* PREFIX##_full(size_t n, T value); \
+T* PREFIX##_zeros(size_t n); \
+T* PREFIX##_range(double start, double end, size_t n); \
+T* PREFIX##_from_array(size_t n, const T* data); \
+T* PREFIX##_copy(T* nv); \
+\
+T* PREFIX##_add(T* a, T* b); \
+T* PREFIX##_sub(T* a, T* b); \
+T* PREFIX##_mult(T* a, T* b); \
+T* PREFIX##_div(T* a, T* b); \
+T* PREFIX##_adds(T* a, T value); \
+T* PREFIX##_subs(T* a, T value); \
+T* PREFIX##_mults(T* a, T value); \
+T* PREFIX##_divs(T* a, T value); \
+\
+T* PREFIX##_add_into(T* dst, T* a, T* b); \
+T* PREFIX##_sub_into(T* dst, T* a, T* b); \
+T* PREFIX##_mult_into(T* dst, T* a, T* b); \
+T* PREFIX##_div_into(T* dst, T* a, T* b); \
+T* PREFIX##_adds_into(T* dst, T* a, T value); \
+T* PREFIX##_subs_into(T* dst, T* a, T value); \
+T* PREFIX##_mults_into(T* dst, T* a, T value); \
+T* PREFIX##_divs_into(T* dst, T* a, T value); \
+\
+T* PREFIX##_add_inplace(T* a, T* b); \
+T* PREFIX##_sub_inplace(T* a, T* b); \
+T* PREFIX##_mult_inplace(T* a, T* b); \
+T* PREFIX##_div_inplace(T* a, T* b); \
+T* PREFIX##_adds_inplace(T* a, T value); \
+T* PREFIX##_subs_inplace(T* a, T value); \
+T* PREFIX##_mults_inplace(T* a, T value); \
+T* PREFIX##_divs_inplace(T* a, T value); \
+\
+SUM_T PREFIX##_sum(T* nv); \
+double PREFIX##_mean(T* nv); \
+double PREFIX##_std(T* nv); \
+T PREFIX##_min(T* nv); \
+T PREFIX##_max(T* nv); \
+size_t PREFIX##_imin(T* nv); \
+size_t PREFIX##_imax(T* nv);
+
+NUMV__DECLARE_TYPE(numv_f32, float, double)
+NUMV__DECLARE_TYPE(numv_i32, int32_t, int64_t)
+NUMV__DECLARE_TYPE(numv_i64, int64_t, int64_t)
+
+
+/* --- Conversions --- */
+
+/* Each conversion returns a new array of the same size, or NULL if `nv` is NULL
+ * or memory cannot be allocated.
+ * Floating-point values are rounded toward zero when converted to integers,
+ * values out of the range of the integer type saturate to its min or max, and NaNs become 0.
+ * Conversions to floating point round to the nearest representable value.
+ */
+float* numv_f32_from_f64(double* nv);
+float* numv_f32_from_i32(int32_t* nv);
+float* numv_f32_from_i64(int64_t* nv);
+
+int32_t* numv_i32_from_f64(double* nv);
+int32_t* numv_i32_from_f32(float* nv);
+int32_t* numv_i32_from_i64(int64_t* nv);
+
+int64_t* numv_i64_from_f64(double* nv);
+int64_t* numv_i64_from_f32(float* nv);
+int64_t* numv_i64_from_i32(int32_t* nv);
+
+double* numv_from_f32(float* nv);
+double* numv_from_i32(int32_t* nv);
+double* numv_from_i64(int64_t* nv);
+
+#endif /* DATALIB_NUMV_TYPES_H */
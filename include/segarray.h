@@ -0,0 +1,109 @@
+/** @file segarray.h
+* Segmented array of generic elements.
+* Elements are stored in fixed-capacity blocks referenced by a small directory,
+* so inserting or removing an element only displaces the elements of one block
+* instead of the whole tail of the array.
+* Blocks are split when full and merged when they become sparse.
+*
+* Example code:
+* ```c
+*     segarray_t s;
+*     segarray_init(&s, sizeof(int));
+*
+*     int x = 10, y = 20;
+*     segarray_push_back(&s, &x);
+*     segarray_insert(&s, &y, 0);
+*
+*     int a = *(int*)segarray_get(&s, 0); // 20
+*
+*     segarray_uninit(&s);
+* ```
+*/
+
+#ifndef DATALIB_SEGARRAY_H
+#define DATALIB_SEGARRAY_H
+
+#include "defs.h"
+#include "array.h"
+
+/* Target size in bytes of the storage of a block */
+#ifndef SEGARRAY_BLOCK_BYTES
+	#define SEGARRAY_BLOCK_BYTES 4096
+#endif
+
+/** @struct segarray_block
+* @brief Block of contiguous elements within a segmented array.
+*/
+struct segarray_block {
+	char* data;		/**< Storage for `block_capacity` elements */
+	size_t size;	/**< Number of elements in the block */
+	size_t start;	/**< Index in the segmented array of the first element of the block */
+};
+
+/** @struct segarray_t
+* @brief Array of generic elements split into blocks.
+*/
+typedef struct segarray_container {
+	array_t blocks;			/**< Directory of blocks (struct segarray_block) in order */
+	size_t size;			/**< Number of stored elements */
+	size_t element_size;	/**< Size in bytes of an element */
+	size_t block_capacity;	/**< Max number of elements in a block */
+} segarray_t;
+
+/** @brief Initialises a segmented array via a given pointer.
+*   Should be freed with `segarray_uninit`.
+*	@param segarray the return segmented array.
+*	@param element_size size in bytes of an element.
+*   @returns input segmented array or NULL if element_size is zero.
+*/
+void* segarray_init(segarray_t* segarray, size_t element_size);
+
+/** @brief Resets the segmented array state and frees all blocks.
+*	@param segarray the segmented array to uninitialise.
+*/
+void segarray_uninit(segarray_t* segarray);
+
+/** @brief Returns a pointer to a new segmented array allocated on the heap.
+*   Should be later freed with `segarray_destroy`.
+*	@param element_size size in bytes of an element.
+*/
+segarray_t* segarray_create(size_t element_size);
+
+/** @brief Frees an allocated segmented array
+*	@param segarray the segmented array to deallocate.
+*/
+void segarray_destroy(segarray_t* segarray);
+
+/** @brief Returns a pointer to the element at the given index.
+* Returns NULL if the index is invalid.
+* The pointer is invalidated by any insertion or removal.
+*/
+void* segarray_get(segarray_t* segarray, size_t index);
+
+/** @brief Sets the value of an element.
+* If the given pointer to data is NULL, the element is filled with zeros.
+* Returns a pointer to the element, or NULL if the index is invalid.
+*/
+void* segarray_set(segarray_t* segarray, const void* element, size_t index);
+
+/** @brief Inserts an element at the given index.
+* If the given element is NULL, the inserted element is zeroed.
+* Only the elements of the block that receives the element are displaced.
+*/
+segarray_t* segarray_insert(segarray_t* segarray, const void* element, size_t index);
+
+/** @brief Inserts an element at the end of the segmented array */
+segarray_t* segarray_push_back(segarray_t* segarray, const void* element);
+
+/** @brief Removes the element at the given index.
+* Only the elements of the block that held the element are displaced.
+*/
+segarray_t* segarray_remove(segarray_t* segarray, size_t index);
+
+/** @brief Removes the last element of the segmented array */
+segarray_t* segarray_pop_back(segarray_t* segarray);
+
+/** @brief Removes all elements and frees all blocks */
+segarray_t* segarray_clear(segarray_t* segarray);
+
+#endif /* DATALIB_SEGARRAY_H */
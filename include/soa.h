@@ -0,0 +1,126 @@
+/** @file soa.h
+* Structure of arrays: a container of records whose fields are stored
+* in separate contiguous columns, one `array_t` per field.
+* Scanning a field only reads the bytes of that field.
+* The columns are described by a schema of named fields with their sizes.
+*
+* Example code:
+* ```c
+*     struct soa_field fields[] = {{"id", sizeof(int)}, {"price", sizeof(double)}};
+*     soa_t s;
+*     soa_init(&s, fields, 2);
+*
+*     int id = 7;
+*     double price = 9.5;
+*     const void* record[] = {&id, &price};
+*     soa_push_back(&s, record);
+*
+*     double* prices = soa_column_by_name(&s, "price");
+*     double p = prices[0]; // 9.5
+*
+*     soa_uninit(&s);
+* ```
+*/
+
+#ifndef DATALIB_SOA_H
+#define DATALIB_SOA_H
+
+#include "defs.h"
+#include "array.h"
+
+/** @struct soa_field
+* @brief Description of a field of the records.
+*/
+struct soa_field {
+	const char* name;	/**< Name of the field, copied by the container */
+	size_t size;		/**< Size in bytes of the field */
+};
+
+/** @struct soa_t
+* @brief Records stored as one column per field.
+*/
+typedef struct soa_container {
+	array_t* columns;	/**< One array per field, in schema order */
+	char** names;		/**< Names of the fields */
+	size_t n_columns;	/**< Number of fields */
+	size_t size;		/**< Number of records */
+} soa_t;
+
+/** @brief Initialises a structure of arrays with a schema of fields.
+*   Should be freed with `soa_uninit`.
+*	@param soa the return structure of arrays.
+*	@param fields names and sizes of the fields, one column per field.
+*	@param n_fields number of fields.
+*   @returns input structure of arrays, or NULL if the schema is empty,
+*   a field has no name, a size of zero, or the same name as another field.
+*/
+void* soa_init(soa_t* soa, const struct soa_field* fields, size_t n_fields);
+
+/** @brief Frees the columns and resets the structure of arrays.
+*	@param soa the structure of arrays to uninitialise.
+*/
+void soa_uninit(soa_t* soa);
+
+/** @brief Returns a pointer to a new structure of arrays allocated on the heap.
+*   Should be later freed with `soa_destroy`.
+*   Returns NULL if the schema is invalid (see `soa_init`).
+*/
+soa_t* soa_create(const struct soa_field* fields, size_t n_fields);
+
+/** @brief Frees an allocated structure of arrays
+*	@param soa the structure of arrays to deallocate.
+*/
+void soa_destroy(soa_t* soa);
+
+/** @brief Returns the index of the column of a field,
+* or `soa->n_columns` if there is no field with that name.
+*/
+size_t soa_column_index(soa_t* soa, const char* name);
+
+/** @brief Returns a pointer to the contiguous values of a column,
+* or NULL if the column index is invalid or there are no records.
+* The pointer is invalidated by any operation that changes the number of records.
+*/
+void* soa_column(soa_t* soa, size_t column);
+
+/** @brief Returns a pointer to the contiguous values of the column of a field,
+* or NULL if there is no such field or there are no records.
+*/
+void* soa_column_by_name(soa_t* soa, const char* name);
+
+/** @brief Returns a pointer to a field of a record,
+* or NULL if the column or the record index is invalid.
+*/
+void* soa_get(soa_t* soa, size_t column, size_t index);
+
+/** @brief Changes the number of records.
+* The fields of new records are not initialised.
+* On failure the structure of arrays is left unchanged.
+*/
+soa_t* soa_resize(soa_t* soa, size_t size);
+
+/** @brief Inserts a record at the given index.
+* `values[c]` points to the value of column `c`.
+* Columns whose value is NULL, or all of them if `values` is NULL, are zeroed.
+* On failure the structure of arrays is left unchanged.
+*/
+soa_t* soa_insert(soa_t* soa, const void* const* values, size_t index);
+
+/** @brief Inserts a record at the end (see `soa_insert`) */
+soa_t* soa_push_back(soa_t* soa, const void* const* values);
+
+/** @brief Removes the record at the given index from every column */
+soa_t* soa_remove(soa_t* soa, size_t index);
+
+/** @brief Removes the record at the given index by moving the last record into its place.
+* Takes constant time, but does not preserve the order of the records.
+*/
+soa_t* soa_swap_remove(soa_t* soa, size_t index);
+
+/** @brief Removes the last record */
+soa_t* soa_pop_back(soa_t* soa);
+
+/** @brief Removes all records */
+soa_t* soa_clear(soa_t* soa);
+
+#endif /* DATALIB_SOA_H */
@@ -0,0 +1,232 @@
+/** @file sort.h
+* Sorting and binary search over contiguous buffers of generic elements.
+*
+* `sort_buffer` is an introsort that takes a `qsort`-style comparator
+* and moves elements of 1, 2, 4, 8 and 16 bytes as integers instead of byte by byte.
+*
+* For the fastest sort, `SORT_DEFINE` generates a sort for a given type
+* where the comparison is a macro that is inlined into the sort:
+* ```c
+*     #define less_by_id(a, b) ((a).id < (b).id)
+*     SORT_DEFINE(sort_records, struct record, less_by_id)
+*     SORT_DEFINE_BOUNDS(search_records, struct record, less_by_id)
+*
+*     sort_records(records, n);
+*     size_t i = search_records_lower_bound(records, n, key);
+* ```
+*/
+
+#ifndef DATALIB_SORT_H
+#define DATALIB_SORT_H
+
+#include "defs.h"
+#include "threadpool.h"
+
+/* Ranges with fewer elements than this are sorted with an insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+	#define SORT_INSERTION_THRESHOLD 24
+#endif
+
+/* Ranges with more elements than this choose the pivot from nine elements instead of three */
+#define SORT_NINTHER_THRESHOLD 128
+
+/* Buffers with fewer elements than this are sorted on a single thread by `sort_buffer_parallel` */
+#ifndef SORT_PARALLEL_THRESHOLD
+	#define SORT_PARALLEL_THRESHOLD 100000
+#endif
+
+/* Max number of elements moved when finishing an already partitioned range by insertion */
+#define SORT_PARTIAL_INSERTION_LIMIT 8
+
+/** @brief Sorts `n` elements of `size` bytes in ascending order.
+* The sort is not stable.
+* @param base buffer of elements.
+* @param n number of elements.
+* @param size size in bytes of an element.
+* @param cmp comparator with the same contract as that of `qsort`.
+*/
+void sort_buffer(void* base, size_t n, size_t size, int (*cmp)(const void*, const void*));
+
+/** @brief Sorts `n` elements of `size` bytes in ascending order across the threads of a pool.
+* Uses a sample sort: the elements are scattered into buckets delimited by splitters
+* chosen from a sorted sample, and the buckets are sorted concurrently with `sort_buffer`.
+* If the sample has repeated values, elements equal to a splitter get a bucket of their own,
+* which needs no sorting, so that inputs with few distinct values are still split across threads.
+* Buffers below `SORT_PARALLEL_THRESHOLD` elements are sorted on the calling thread.
+* Needs a temporary buffer of `n * (size + 1)` bytes.
+* The sort is not stable.
+* @param pool pool whose threads sort the buffer, or NULL for `threadpool_default()`.
+* @returns 1 on success, or 0 if the buffer is invalid or the temporary buffer cannot be allocated.
+*/
+int sort_buffer_parallel(void* base, size_t n, size_t size,
+                         int (*cmp)(const void*, const void*), threadpool_t* pool);
+
+/** @brief Returns the index of the first element not less than a key
+* in a buffer sorted in ascending order, or `n` if there is none.
+*/
+size_t sort_lower_bound(const void* base, size_t n, size_t size, const void* key,
+                        int (*cmp)(const void*, const void*));
+
+/** @brief Returns the index of the first element greater than a key
+* in a buffer sorted in ascending order, or `n` if there is none.
+*/
+size_t sort_upper_bound(const void* base, size_t n, size_t size, const void* key,
+                        int (*cmp)(const void*, const void*));
+
+
+/* --- Macro templates --- */
+
+/* Defines a function `static void NAME(T* base, size_t n)` that sorts
+ * an array of elements of type T in ascending order with an introsort.
+ * LESS(a, b) must evaluate to non-zero if the value `a` goes before the value `b`.
+ */
+#define SORT_DEFINE(NAME, T, LESS) SORT__DEFINE(NAME, T, LESS, SORT__NO_PARAM, SORT__NO_ARG)
+
+/* Defines the functions
+ * `static size_t NAME_lower_bound(const T* base, size_t n, T key)` and
+ * `static size_t NAME_upper_bound(const T* base, size_t n, T key)`,
+ * which return the index of the first element not less than (lower bound)
+ * or greater than (upper bound) the key in an array sorted with LESS.
+ */
+#define SORT_DEFINE_BOUNDS(NAME, T, LESS) \
+static size_t NAME##_lower_bound(const T* base, size_t n, T key){ \
+	const T* first = base; \
+	while(n > 0){ \
+		size_t half = n / 2; \
+		if(LESS(first[half], key)){ first += half + 1; n -= half + 1; } \
+		else { n = half; } \
+	} \
+	return (size_t)(first - base); \
+} \
+static size_t NAME##_upper_bound(const T* base, size_t n, T key){ \
+	const T* first = base; \
+	while(n > 0){ \
+		size_t half = n / 2; \
+		if(!LESS(key, first[half])){ first += half + 1; n -= half + 1; } \
+		else { n = half; } \
+	} \
+	return (size_t)(first - base); \
+}
+
+#define SORT__NO_PARAM
+#define SORT__NO_ARG
+
+/* Sort template where PARAM declares extra trailing parameters (with a leading comma)
+ * that are forwarded as ARG to nested calls, so that LESS can refer to them.
+ */
+#define SORT__DEFINE(NAME, T, LESS, PARAM, ARG) \
+static void NAME##_insertion(T* a, size_t n PARAM){ \
+	size_t i, j; \
+	for(i = 1; i < n; ++i){ \
+		T x = a[i]; \
+		for(j = i; j > 0 && LESS(x, a[j - 1]); --j) a[j] = a[j - 1]; \
+		a[j] = x; \
+	} \
+} \
+/* Insertion sort that gives up after moving too many elements */ \
+static int NAME##_partial_insertion(T* a, size_t n PARAM){ \
+	size_t i, j, moved = 0; \
+	for(i = 1; i < n; ++i){ \
+		if(!LESS(a[i], a[i - 1])) continue; \
+		T x = a[i]; \
+		for(j = i; j > 0 && LESS(x, a[j - 1]); --j) a[j] = a[j - 1]; \
+		a[j] = x; \
+		moved += i - j; \
+		if(moved > SORT_PARTIAL_INSERTION_LIMIT) return 0; \
+	} \
+	return 1; \
+} \
+static void NAME##_sift_down(T* a, size_t root, size_t n PARAM){ \
+	T x = a[root]; \
+	size_t child; \
+	while((child = 2 * root + 1) < n){ \
+		if(child + 1 < n && LESS(a[child], a[child + 1])) child++; \
+		if(!LESS(x, a[child])) break; \
+		a[root] = a[child]; \
+		root = child; \
+	} \
+	a[root] = x; \
+} \
+static void NAME##_heapsort(T* a, size_t n PARAM){ \
+	size_t i; \
+	for(i = n / 2; i-- > 0;) NAME##_sift_down(a, i, n ARG); \
+	for(i = n; i-- > 1;){ \
+		T x = a[0]; a[0] = a[i]; a[i] = x; \
+		NAME##_sift_down(a, 0, i ARG); \
+	} \
+} \
+/* Sorts three elements in place */ \
+static void NAME##_sort3(T* a, T* b, T* c PARAM){ \
+	T x; \
+	if(LESS(*b, *a)){ x = *a; *a = *b; *b = x; } \
+	if(LESS(*c, *b)){ x = *b; *b = *c; *c = x; \
+		if(LESS(*b, *a)){ x = *a; *a = *b; *b = x; } } \
+} \
+/* Partitions around the pivot at the front. \
+   Elements already on the correct side at both ends are skipped, \
+   and the rest are partitioned with a branchless Lomuto scheme. \
+   With `left` unset, elements equal to the pivot go to the right, otherwise to the left. \
+   Returns the final position of the pivot and whether any element was out of place. */ \
+static size_t NAME##_partition(T* a, size_t n, int left, int* disorder PARAM){ \
+	T pivot = a[0]; \
+	size_t i = 1, j = n - 1, lt; \
+	while(i < n && (left ? !LESS(pivot, a[i]) : LESS(a[i], pivot))) i++; \
+	while(j >= i && !(left ? !LESS(pivot, a[j]) : LESS(a[j], pivot))) j--; \
+	*disorder = i < j; \
+	for(lt = i; i <= j && i < n; ++i){ \
+		T x = a[i]; \
+		int c = left ? !LESS(pivot, x) : LESS(x, pivot); \
+		a[i] = a[lt]; \
+		a[lt] = x; \
+		lt += c; \
+	} \
+	a[0] = a[lt - 1]; \
+	a[lt - 1] = pivot; \
+	return lt - 1; \
+} \
+static void NAME##_introsort(T* a, size_t n, unsigned depth, int leftmost PARAM){ \
+	while(n > SORT_INSERTION_THRESHOLD){ \
+		if(depth-- == 0){ NAME##_heapsort(a, n ARG); return; } \
+		/* Moves the median of three (or of three medians of three) to the front */ \
+		size_t mid = n / 2; \
+		if(n > SORT_NINTHER_THRESHOLD){ \
+			NAME##_sort3(a, a + mid, a + n - 1 ARG); \
+			NAME##_sort3(a + 1, a + mid - 1, a + n - 2 ARG); \
+			NAME##_sort3(a + 2, a + mid + 1, a + n - 3 ARG); \
+			NAME##_sort3(a + mid - 1, a + mid, a + mid + 1 ARG); \
+		} else { \
+			NAME##_sort3(a, a + mid, a + n - 1 ARG); \
+		} \
+		T x = a[mid]; a[mid] = a[0]; a[0] = x; \
+		int disorder; \
+		/* A pivot equal to the element before the range (the pivot of the parent range) \
+		   is its smallest value, so the elements equal to it are already in place */ \
+		if(!leftmost && !LESS(a[-1], a[0])){ \
+			size_t p = NAME##_partition(a, n, 1, &disorder ARG); \
+			a += p + 1; n -= p + 1; \
+			continue; \
+		} \
+		size_t p = NAME##_partition(a, n, 0, &disorder ARG); \
+		T* right = a + p + 1; \
+		size_t nl = p, nr = n - p - 1; \
+		/* Ranges that were already partitioned are likely sorted */ \
+		if(!disorder && NAME##_partial_insertion(a, nl ARG) \
+			&& NAME##_partial_insertion(right, nr ARG)) return; \
+		if(nl < nr){ \
+			NAME##_introsort(a, nl, depth, leftmost ARG); \
+			a = right; n = nr; leftmost = 0; \
+		} else { \
+			NAME##_introsort(right, nr, depth, 0 ARG); \
+			n = nl; \
+		} \
+	} \
+	NAME##_insertion(a, n ARG); \
+} \
+static void NAME(T* base, size_t n PARAM){ \
+	unsigned depth = 0; \
+	size_t m; \
+	for(m = n; m > 1; m >>= 1) depth += 2; \
+	NAME##_introsort(base, n, depth, 1 ARG); \
+}
+
+#endif /* DATALIB_SORT_H */
@@ -0,0 +1,99 @@
+/** @file strvec.h
+* Packed vector of strings.
+* The characters of all strings are stored back to back in a single buffer,
+* each followed by a NUL terminator, and a parallel array keeps the offset
+* where each string starts. A string takes its length plus one byte for the
+* terminator and the size of an offset, without a heap allocation of its own.
+*
+* Example code:
+* ```c
+*     strvec_t s;
+*     strvec_init(&s);
+*
+*     strvec_push(&s, "hello");
+*     strvec_pushn(&s, "world!", 5);
+*
+*     const char* w = strvec_get(&s, 1); // "world"
+*     size_t n = strvec_len(&s, 1);      // 5
+*
+*     strvec_uninit(&s);
+* ```
+*/
+
+#ifndef DATALIB_STRVEC_H
+#define DATALIB_STRVEC_H
+
+#include "defs.h"
+#include "array.h"
+
+/** @struct strvec_t
+* @brief Vector of NUL-terminated strings packed in one buffer.
+*/
+typedef struct strvec_container {
+	array_t bytes;		/**< Characters of all strings, each followed by a NUL */
+	array_t offsets;	/**< Offset in `bytes` of the first character of each string (size_t) */
+} strvec_t;
+
+/** @brief Initialises an empty string vector via a given pointer.
+*   Should be freed with `strvec_uninit`.
+*   @returns input string vector, or NULL if it is NULL.
+*/
+void* strvec_init(strvec_t* strvec);
+
+/** @brief Frees the storage and resets the string vector */
+void strvec_uninit(strvec_t* strvec);
+
+/** @brief Returns a pointer to a new string vector allocated on the heap.
+*   Should be later freed with `strvec_destroy`.
+*/
+strvec_t* strvec_create(void);
+
+/** @brief Frees an allocated string vector */
+void strvec_destroy(strvec_t* strvec);
+
+/** @brief Returns the number of strings */
+size_t strvec_size(const strvec_t* strvec);
+
+/** @brief Returns the NUL-terminated string at the given index, or NULL if the index is invalid.
+* The pointer is invalidated when a string is added to the vector.
+*/
+const char* strvec_get(const strvec_t* strvec, size_t index);
+
+/** @brief Returns the length of the string at the given index, without the terminator.
+* Returns 0 if the index is invalid.
+*/
+size_t strvec_len(const strvec_t* strvec, size_t index);
+
+/** @brief Appends a copy of a NUL-terminated string */
+strvec_t* strvec_push(strvec_t* strvec, const char* str);
+
+/** @brief Appends a copy of the first `length` characters of a string.
+* The string may be one of the strvec itself, e.g. from `strvec_get`.
+*/
+strvec_t* strvec_pushn(strvec_t* strvec, const char* str, size_t length);
+
+/** @brief Removes the last string */
+strvec_t* strvec_pop_back(strvec_t* strvec);
+
+/** @brief Removes all strings, keeping the allocated storage */
+strvec_t* strvec_clear(strvec_t* strvec);
+
+/** @brief Returns a new string vector with copies of the strings in `[begin, end)`.
+*   Should be later freed with `strvec_destroy`.
+*   Returns NULL if the range is invalid or memory cannot be allocated.
+*/
+strvec_t* strvec_slice(const strvec_t* strvec, size_t begin, size_t end);
+
+/** @brief Appends the strings of a text separated by a delimiter.
+* The whole text is copied into the buffer at once, and the delimiters
+* become the terminators of the strings.
+* A delimiter at the end of the text does not start an empty string,
+* so that lines ending with `'\n'` yield one string per line.
+* @param text characters to split, which need not be NUL-terminated.
+* @param length number of characters of the text.
+* @param delimiter character that separates the strings.
+* @returns the input string vector, or NULL if memory cannot be allocated.
+*/
+strvec_t* strvec_from_text(strvec_t* strvec, const char* text, size_t length, char delimiter);
+
+#endif /* DATALIB_STRVEC_H */
@@ -0,0 +1,66 @@
+/** @file threadpool.h
+* Persistent pool of worker threads that run data-parallel tasks.
+* A job is a function applied to task indices `[0, n_tasks)`.
+* The tasks are shared between the workers and the calling thread,
+* and `threadpool_run` returns once all of them are done.
+*
+* Example code:
+* ```c
+*     void square(size_t task, void* args){
+*         double* x = args;
+*         x[task] *= x[task];
+*     }
+*
+*     threadpool_t* pool = threadpool_create(4);
+*     threadpool_run(pool, n, square, values);
+*     threadpool_destroy(pool);
+* ```
+*/
+
+#ifndef DATALIB_THREADPOOL_H
+#define DATALIB_THREADPOOL_H
+
+#include "defs.h"
+
+/** @struct threadpool_t
+* @brief Opaque pool of worker threads.
+*/
+typedef struct threadpool threadpool_t;
+
+/** @brief Creates a pool that runs tasks on `n_threads` threads,
+* including the thread that calls `threadpool_run`.
+* Should be freed with `threadpool_destroy`.
+* Without thread support, all tasks run on the calling thread.
+* @param n_threads number of threads, or zero for one per online processor.
+* @returns the new pool, or NULL if it could not be created.
+*/
+threadpool_t* threadpool_create(size_t n_threads);
+
+/** @brief Stops the workers of a pool and frees it.
+* Must not be called while a job is running.
+*/
+void threadpool_destroy(threadpool_t* pool);
+
+/** @brief Returns the number of threads that run tasks, including the caller */
+size_t threadpool_size(threadpool_t* pool);
+
+/** @brief Returns a pool shared by the library, with one thread per online processor.
+* It is created on first use and lives until the program exits.
+* Returns NULL if it could not be created.
+*/
+threadpool_t* threadpool_default(void);
+
+/** @brief Runs `fn(task, args)` for every task in `[0, n_tasks)` and waits for them to finish.
+* Tasks may run in any order and on any thread of the pool.
+* Jobs submitted to the same pool from several threads run one after another.
+* A job submitted from a task to the pool that runs it, directly or through
+* the tasks of other pools, runs on the calling thread instead of deadlocking.
+* @param pool pool that runs the tasks, or NULL to run them on the calling thread.
+* @param n_tasks number of tasks.
+* @param fn function that runs a task.
+* @param args argument passed to every task.
+*/
+void threadpool_run(threadpool_t* pool, size_t n_tasks,
+                    void (*fn)(size_t task, void* args), void* args);
+
+#endif /* DATALIB_THREADPOOL_H */
@@ -3,6 +3,8 @@
  * Resizeable array data structure allocated in the heap
  * where the size and capacity are stored in a header
  * located before the first element of the array.
+ * The header is padded so that the first element is aligned
+ * to `DATALIB_ALIGNMENT` bytes (see defs.h).
  * 
  * Can store primitive types and structs.
  * Cannot store arrays or typedefs of arrays.
@@ -61,9 +63,42 @@
 /* Removes the item at index I from a vector V */
 #define vec_delete(V, I) _vec_delete((V), sizeof(*(V)), (I))
 
+/* Removes the item at index I from a vector V by moving the last item into its place.
+ * Takes constant time but does not preserve the order of the items.
+ */
+#define vec_swap_remove(V, I) _vec_swap_remove((V), sizeof(*(V)), (I))
+
+/* Keeps only the items of a vector V for which `PRED(item, ARGS)` returns non-zero,
+ * preserving their order. Runs in a single pass over the vector,
+ * calling PRED exactly once per item, in order.
+ * Returns the number of removed items.
+ */
+#define vec_retain(V, PRED, ARGS) _vec_retain((V), sizeof(*(V)), (PRED), (ARGS))
+
 /* Makes a copy of a vector V */
 #define vec_copy(V) _vec_copy((V), sizeof(*(V)))
 
+/* Sorts a vector V in ascending order with a `qsort`-style comparator CMP */
+#define vec_sort(V, CMP) _vec_sort((V), sizeof(*(V)), (CMP))
+
+/* Returns the index of the first element not less than the value pointed to by K
+ * in a vector V sorted with a comparator CMP, or the vector size if there is none
+ */
+#define vec_lower_bound(V, K, CMP) _vec_lower_bound((V), sizeof(*(V)), (K), (CMP))
+
+/* Returns the index of the first element greater than the value pointed to by K
+ * in a vector V sorted with a comparator CMP, or the vector size if there is none
+ */
+#define vec_upper_bound(V, K, CMP) _vec_upper_bound((V), sizeof(*(V)), (K), (CMP))
+
+/* Maps the file at path P as a read-only vector of elements of type T.
+ * The elements are paged in from the file on demand.
+ * The vector must not be modified or resized, and must be freed with `vec_unmap`.
+ * Returns NULL if the file cannot be mapped or its size is not a multiple of the element size.
+ * Only available on POSIX systems.
+ */
+#define vec_map_file(T, P) _vec_map_file((P), sizeof(T))
+
 
 /* --- Public functions --- */
 
@@ -85,6 +120,9 @@ void vec_free(void* vec);
 /* Removes the last element of a vector `vec` */
 void vec_pop(void* vec);
 
+/* Unmaps a vector `vec` created with `vec_map_file` */
+void vec_unmap(void* vec);
+
 
 /* --- Private functions --- */ 
 /*       Use via macros     */
@@ -107,9 +145,30 @@ void _vec_pop_front(void* vec, size_t item_size);
 /* Removes the item at index `index` from a vector `vec` */
 void _vec_delete(void* vec, size_t item_size, size_t index);
 
+/* Removes the item at index `index` from a vector `vec` by moving the last item into its place */
+void _vec_swap_remove(void* vec, size_t item_size, size_t index);
+
+/* Keeps only the items of a vector `vec` that satisfy a predicate */
+size_t _vec_retain(void* vec, size_t item_size,
+                   int (*pred)(const void* item, void* args), void* args);
+
 /* Makes a copy of a vector `vec` */
 void* _vec_copy(void* vec, size_t item_size);
 
+/* Sorts a vector `vec` in ascending order */
+void _vec_sort(void* vec, size_t item_size, int (*cmp)(const void*, const void*));
+
+/* Returns the index of the first element not less than a key in a sorted vector `vec` */
+size_t _vec_lower_bound(void* vec, size_t item_size, const void* key,
+                        int (*cmp)(const void*, const void*));
+
+/* Returns the index of the first element greater than a key in a sorted vector `vec` */
+size_t _vec_upper_bound(void* vec, size_t item_size, const void* key,
+                        int (*cmp)(const void*, const void*));
+
+/* Maps a file as a read-only vector with a given element size */
+void* _vec_map_file(const char* path, size_t item_size);
+
 
 
 #endif /* DATALIB_VEC_H */
\ No newline at end of file
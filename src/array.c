@@ -1,24 +1,128 @@
+#ifdef __linux__
+	#define _GNU_SOURCE /* mremap */
+#endif
+
 #include "array.h"
+#include "sort.h"
+
+#ifdef DATALIB_HAS_MMAP
+	#include <fcntl.h>    /* open */
+	#include <unistd.h>   /* ftruncate, close */
+	#include <sys/mman.h> /* mmap, madvise, msync */
+	#include <sys/stat.h> /* fstat */
+#endif
 
+/* File mapping that backs the memory pool of an array */
+struct array_mapping {
+	int fd;			/* Descriptor of the mapped file */
+	size_t length;	/* Number of mapped bytes */
+};
 
-/* Returns the nearest highest power of two of an integer */
-static uint32_t array_nearest_power_of_two(uint32_t n){
+
+/* Returns the nearest highest power of two of an integer,
+   or the integer itself if the power of two does not fit in a size_t */
+static size_t array_nearest_power_of_two(size_t n){
     if(n <= 1) return 1;
-    uint32_t x = 2;
+    if(n > SIZE_MAX / 2 + 1) return n;
+    size_t x = 2;
     n--;
 	while (n >>= 1) x <<= 1;
 	return x;
 }
 
-/* Increments capacity of an array */
-static array_t* array_extend_capacity(array_t* array, uint32_t capacity){
+/* Overwrites an element with the given data, or with zeros if it is NULL.
+   Common element sizes are copied with a constant size,
+   which the compiler replaces with plain loads and stores. */
+static void array_write(array_t* array, char* addr, const void* element){
+	if(!element){
+		memset(addr, 0, array->element_size);
+		return;
+	}
+	switch(array->element_size){
+		case 1:  memcpy(addr, element, 1); break;
+		case 2:  memcpy(addr, element, 2); break;
+		case 4:  memcpy(addr, element, 4); break;
+		case 8:  memcpy(addr, element, 8); break;
+		case 16: memcpy(addr, element, 16); break;
+		default: memmove(addr, element, array->element_size); break;
+	}
+}
+
+/* Computes the bytes taken by `n` elements.
+   Returns 0 if the result does not fit in a size_t, and 1 otherwise. */
+static int array_bytes(const array_t* array, size_t n, size_t* bytes){
+	if(n > (SIZE_MAX - DATALIB_ALIGNMENT - sizeof(void*)) / array->element_size){
+		return 0;
+	}
+	*bytes = n * array->element_size;
+	return 1;
+}
+
+/* Maps the file that backs an array again with a given number of bytes,
+   growing the file first if needed. A file longer than the mapping is not trimmed. */
+static array_t* array_remap(array_t* array, size_t bytes){
+#ifdef DATALIB_HAS_MMAP
+	struct array_mapping* mapping = array->mapping;
+	if(bytes > mapping->length && ftruncate(mapping->fd, (off_t)bytes) != 0) return NULL;
+
+	void* data;
+	#ifdef MREMAP_MAYMOVE
+	if(array->data){
+		data = mremap(array->data, mapping->length, bytes, MREMAP_MAYMOVE);
+	} else
+	#endif
+	{
+		/* The old mapping is only removed once the new one exists,
+		   so that the array keeps its elements if mapping fails */
+		data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, mapping->fd, 0);
+		if(data != MAP_FAILED && array->data) munmap(array->data, mapping->length);
+	}
+	if(data == MAP_FAILED) return NULL;
+
+	array->data = data;
+	mapping->length = bytes;
+	return array;
+#else
+	(void)array; (void)bytes;
+	return NULL;
+#endif
+}
+
+/* Unmaps the memory pool of a file-backed array and trims the file to its elements */
+static void array_unmap(array_t* array){
+#ifdef DATALIB_HAS_MMAP
+	struct array_mapping* mapping = array->mapping;
+	if(array->data) munmap(array->data, mapping->length);
+	/* Failing to trim only leaves the unused capacity at the end of the file */
+	int r = ftruncate(mapping->fd, (off_t)(array->size * array->element_size));
+	(void)r;
+	close(mapping->fd);
+#endif
+	DATALIB_FREE(array->mapping);
+	array->mapping = NULL;
+	array->data = NULL;
+}
+
+/* Increments capacity of an array.
+   Once the capacity is allocated, the byte offset of any element fits in a size_t. */
+static array_t* array_extend_capacity(array_t* array, size_t capacity){
 	if(!array) return NULL;
 
-	void* data = DATALIB_ALLOC(capacity * array->element_size);
+	size_t bytes;
+	if(!array_bytes(array, capacity, &bytes)) return NULL;
+	if(array->mapping){
+		if(!array_remap(array, bytes)) return NULL;
+		array->capacity = capacity;
+		return array;
+	}
+
+	void* data = DATALIB_ALIGNED_ALLOC(bytes);
 	if(!data) return NULL;
 	
-	memmove(data, array->data, array->size * array->element_size);
-	DATALIB_FREE(array->data);
+	if(array->data){
+		memmove(data, array->data, array->size * array->element_size);
+	}
+	DATALIB_ALIGNED_FREE(array->data);
 	array->data = data;
 	array->capacity = capacity;
 	return array;
@@ -31,9 +135,10 @@ static array_t* array_extend_capacity(array_t* array, uint32_t capacity){
 Initialises an array via a given pointer.
 Should be later freed using `array_uninit`.
 */
-void* array_init(array_t* array, uint32_t element_size){
-	if(!array || element_size == 0) return NULL ;
+void* array_init(array_t* array, size_t element_size){
+	if(!array) return NULL;
 	*array = (array_t){0};
+	if(element_size == 0) return NULL;
 	array->element_size = element_size;
 	return array;
 }
@@ -43,26 +148,28 @@ Deallocates and resets the array data without freeing the array object itself.
 */
 void array_uninit(array_t* array){
 	if(!array) return;
-	if(array->data) DATALIB_FREE(array->data);
+	if(array->mapping){
+		array_unmap(array);
+	} else if(array->data){
+		DATALIB_ALIGNED_FREE(array->data);
+	}
 	*array = (array_t){0};
 }
 
 
 /* Creates a new array of size zero */
-array_t* array_create(uint32_t element_size){
+array_t* array_create(size_t element_size){
 	if(element_size == 0) return NULL;
 	array_t* array = DATALIB_ALLOC(sizeof(array_t));
 	if(!array) return NULL;
-	array->size = 0;
-	array->data = NULL;
-	array->element_size = element_size;
+	array_init(array, element_size);
 	return array;
 }
 
 /* Frees all the elements of an array */
 void array_destroy(array_t* array){
 	if(!array) return;
-	if(array->data) DATALIB_FREE(array->data);
+	array_uninit(array);
 	DATALIB_FREE(array);
 }
 
@@ -71,19 +178,37 @@ array_t* array_copy(array_t* orig){
 	array_t* new = malloc(sizeof(array_t));
 	if(!new) return NULL;
 	memmove(new, orig, sizeof(array_t));
+	new->mapping = NULL;
 
 	if(!orig->data){
 		return new;
 	}
 
 	size_t bytes = orig->capacity * orig->element_size;
-	new->data = DATALIB_ALLOC(bytes);
+	new->data = DATALIB_ALIGNED_ALLOC(bytes);
+	if(!new->data){
+		DATALIB_FREE(new);
+		return NULL;
+	}
 	memmove(new->data, orig->data, bytes);
 	return new;
 }
 
+/* Creates a new array from existing data */
+array_t* array_from_data(const void* data, size_t size, size_t element_size){
+	array_t* array = array_create(element_size);
+	if(!array) return NULL;
+	if(size == 0 || !data) return array;
+
+	if(!array_push_back_n(array, data, size)){
+		array_destroy(array);
+		return NULL;
+	}
+	return array;
+}
+
 /* Pre-allocates a given number of elements but does not initialise them */
-array_t* array_resize(array_t* array, uint32_t size){
+array_t* array_resize(array_t* array, size_t size){
 	if(!array || array->element_size == 0) return NULL;
 
 	if(size <= array->size){
@@ -95,7 +220,7 @@ array_t* array_resize(array_t* array, uint32_t size){
 	
 	/* Round up new capacity to the highest power of two closest to the size */
 	if(size >= array->capacity){
-		array_extend_capacity(array, array_nearest_power_of_two(size));
+		if(!array_extend_capacity(array, array_nearest_power_of_two(size))) return NULL;
 	}
 
 	array->size = size;
@@ -104,20 +229,16 @@ array_t* array_resize(array_t* array, uint32_t size){
 
 /* -- SETTERS -- */
 /* Overwrites an element at the given index with the given data */
-void* array_set(array_t* array, void* element, uint32_t index){
+void* array_set(array_t* array, void* element, size_t index){
 	if(!array || array->element_size == 0 || index >= array->size) return NULL;
 	char* addr = array->data + index * array->element_size;
-	if(!element){
-		memset(addr, 0, array->element_size);
-	} else {
-		memmove(addr, element, array->element_size);
-	}
+	array_write(array, addr, element);
 	return addr;
 }
 
 /* -- RETRIEVALS -- */
 /* Returns a pointer to the element at the specified index */
-void* array_get(array_t* array, uint32_t index){
+void* array_get(array_t* array, size_t index){
 	if(!array || array->element_size == 0 || index >= array->size) return NULL;
 	char* addr = array->data + index * array->element_size;
 	return addr;
@@ -146,18 +267,19 @@ void* array_end(array_t* array){
 
 /* -- INSERTING -- */
 /* Inserts an element at the given index */
-array_t* array_insert(array_t* array, void* element, uint32_t index){
+array_t* array_insert(array_t* array, void* element, size_t index){
 	if(!array || array->element_size == 0 || index > array->size){
 		return NULL;
 	}
 
 	if(array->size >= array->capacity || !array->data){
-		array_t* r = array_extend_capacity(array, array_nearest_power_of_two(array->size));
+		if(array->size == SIZE_MAX) return NULL;
+		array_t* r = array_extend_capacity(array, array_nearest_power_of_two(array->size + 1));
 		if(!r) return NULL;
 	}
 	
 	char* addr = array->data + index * array->element_size;
-	uint32_t move_bytes = (array->size - index) * array->element_size;
+	size_t move_bytes = (array->size - index) * array->element_size;
 	
 	if(move_bytes > 0){
 		/* Displace elements to make space for new one
@@ -166,15 +288,68 @@ array_t* array_insert(array_t* array, void* element, uint32_t index){
 		memmove(addr + array->element_size, addr, move_bytes);
 	}
 
-	if(!element){
-		memset(addr, 0, array->element_size);
+	array_write(array, addr, element);
+	array->size++;
+	return array;
+}
+
+/* Returns whether a pointer points into the elements of an array,
+   which move when they grow or are displaced, and stores its offset in bytes if it does */
+static int array_inner_offset(const array_t* array, const void* p, size_t* offset){
+	uintptr_t begin = (uintptr_t)array->data;
+	if(!p || !begin || (uintptr_t)p < begin || (uintptr_t)p >= begin + array->size * array->element_size) return 0;
+	*offset = (size_t)((uintptr_t)p - begin);
+	return 1;
+}
+
+/* Inserts `count` elements at the given index with a single displacement */
+array_t* array_insert_range(array_t* array, const void* elements, size_t count, size_t index){
+	if(!array || array->element_size == 0 || index > array->size){
+		return NULL;
+	}
+	if(count == 0) return array;
+	if(count > SIZE_MAX - array->size) return NULL;
+
+	/* Elements of the array itself are found again after it grows */
+	size_t inner;
+	int is_inner = array_inner_offset(array, elements, &inner);
+	size_t size = array->size + count;
+	if(size > array->capacity || !array->data){
+		array_t* r = array_extend_capacity(array, array_nearest_power_of_two(size));
+		if(!r) return NULL;
+	}
+
+	char* addr = array->data + index * array->element_size;
+	size_t block_bytes = count * array->element_size;
+	size_t move_bytes = (array->size - index) * array->element_size;
+
+	if(move_bytes > 0){
+		memmove(addr + block_bytes, addr, move_bytes);
+	}
+
+	if(!elements){
+		memset(addr, 0, block_bytes);
+	} else if(is_inner){
+		/* The elements before the index stay in place, and those after it
+		   were displaced past the block: neither overlaps the block */
+		size_t split = index * array->element_size;
+		size_t before = inner < split ? split - inner : 0;
+		if(before > block_bytes) before = block_bytes;
+		memcpy(addr, array->data + inner, before);
+		memcpy(addr + before, array->data + inner + before + block_bytes, block_bytes - before);
 	} else {
-		memmove(addr, element, array->element_size);
+		memcpy(addr, elements, block_bytes);
 	}
-	array->size++;
+	array->size = size;
 	return array;
 }
 
+/* Inserts `count` elements to the end of the array */
+array_t* array_push_back_n(array_t* array, const void* elements, size_t count){
+	if(!array) return NULL;
+	return array_insert_range(array, elements, count, array->size);
+}
+
 /* Inserts the element to the end of the array */
 array_t* array_push_back(array_t* array, void* element){
 	return array_insert(array, element, array->size);
@@ -187,26 +362,67 @@ array_t* array_push_front(array_t* array, void* element){
 
 /* -- DELETING -- */
 /* Removes the element at the given index */
-array_t* array_remove(array_t* array, uint32_t index){
-	if(!array || !array->data || index >= array->size){
+array_t* array_remove(array_t* array, size_t index){
+	return array_remove_range(array, index, 1);
+}
+
+/* Removes `count` elements starting at the given index with a single displacement */
+array_t* array_remove_range(array_t* array, size_t index, size_t count){
+	if(!array || !array->data || index >= array->size || count > array->size - index){
 		return NULL;
 	}
 
-	if (index == array->size - 1){
-		array->size--;
-		return array;
-	}
-	
 	char* dest = array->data + index * array->element_size;
-	char* orig = dest + array->element_size;
-	uint32_t move_bytes = (array->size - index) * array->element_size;
+	char* orig = dest + count * array->element_size;
+	size_t move_bytes = (array->size - index - count) * array->element_size;
 
-	memmove(dest, orig, move_bytes);
+	if(move_bytes > 0){
+		memmove(dest, orig, move_bytes);
+	}
 
+	array->size -= count;
+	return array;
+}
+
+/* Removes the element at the given index by moving the last element into its place */
+array_t* array_swap_remove(array_t* array, size_t index){
+	if(!array || index >= array->size) return NULL;
+
+	size_t last = array->size - 1;
+	if(index != last){
+		array_write(array, array_at(array, index), array_at(array, last));
+	}
 	array->size--;
 	return array;
 }
 
+/* Keeps only the elements that satisfy a predicate, calling it once per element.
+   A run of kept elements is moved to the write cursor with a single `memmove`
+   when the first removed element after it is found. */
+size_t array_retain(array_t* array, int (*pred)(const void* element, void* args), void* args){
+	if(!array || !pred) return 0;
+
+	size_t size = array->size;
+	size_t read, write = 0, run_start = 0;
+
+	for(read = 0; read != size; ++read){
+		if(pred(array_at(array, read), args)) continue;
+		/* The run before this element is moved, unless no element was removed before it */
+		if(write != run_start){
+			memmove(array_at(array, write), array_at(array, run_start), (read - run_start) * array->element_size);
+		}
+		write += read - run_start;
+		run_start = read + 1;
+	}
+	if(write != run_start){
+		memmove(array_at(array, write), array_at(array, run_start), (size - run_start) * array->element_size);
+	}
+	write += size - run_start;
+
+	array->size = write;
+	return size - write;
+}
+
 /* Removes the element last element of the array */
 array_t* array_pop_back(array_t* array){
 	if(array->size == 0) return NULL;
@@ -225,3 +441,113 @@ array_t* array_clear(array_t* array){
 	return array;
 }
 
+
+/* -- SORTING -- */
+/* Sorts the elements of the array in ascending order */
+array_t* array_sort(array_t* array, int (*cmp)(const void*, const void*)){
+	if(!array || !cmp) return NULL;
+	sort_buffer(array->data, array->size, array->element_size, cmp);
+	return array;
+}
+
+/* Sorts the elements of the array in ascending order across the threads of a pool */
+array_t* array_sort_parallel(array_t* array, int (*cmp)(const void*, const void*), threadpool_t* pool){
+	if(!array || !cmp) return NULL;
+	if(array->size < 2) return array;
+	if(!sort_buffer_parallel(array->data, array->size, array->element_size, cmp, pool)) return NULL;
+	return array;
+}
+
+/* Returns the index of the first element not less than a key */
+size_t array_lower_bound(array_t* array, const void* key, int (*cmp)(const void*, const void*)){
+	if(!array || !array->data) return 0;
+	return sort_lower_bound(array->data, array->size, array->element_size, key, cmp);
+}
+
+/* Returns the index of the first element greater than a key */
+size_t array_upper_bound(array_t* array, const void* key, int (*cmp)(const void*, const void*)){
+	if(!array || !array->data) return 0;
+	return sort_upper_bound(array->data, array->size, array->element_size, key, cmp);
+}
+
+
+/* -- FILE MAPPING -- */
+/* Initialises an array backed by a memory-mapped file */
+array_t* array_map_file(array_t* array, const char* path, size_t element_size){
+	if(!array_init(array, element_size) || !path) return NULL;
+#ifdef DATALIB_HAS_MMAP
+	struct array_mapping* mapping = DATALIB_ALLOC(sizeof(struct array_mapping));
+	if(!mapping) return NULL;
+	mapping->length = 0;
+	mapping->fd = open(path, O_RDWR | O_CREAT, 0644);
+	if(mapping->fd < 0){
+		DATALIB_FREE(mapping);
+		return NULL;
+	}
+
+	struct stat st;
+	if(fstat(mapping->fd, &st) != 0 || (size_t)st.st_size % element_size != 0){
+		close(mapping->fd);
+		DATALIB_FREE(mapping);
+		return NULL;
+	}
+
+	array->mapping = mapping;
+	size_t size = (size_t)st.st_size / element_size;
+	if(size > 0){
+		if(!array_remap(array, (size_t)st.st_size)){
+			array_uninit(array);
+			return NULL;
+		}
+	}
+	array->size = size;
+	array->capacity = size;
+	return array;
+#else
+	return NULL;
+#endif
+}
+
+/* Writes the elements of a file-backed array to its file */
+array_t* array_sync(array_t* array){
+	if(!array || !array->mapping) return NULL;
+#ifdef DATALIB_HAS_MMAP
+	struct array_mapping* mapping = array->mapping;
+	size_t bytes = array->size * array->element_size;
+	/* The mapping and the file are trimmed to the elements,
+	   so that the file has no trailing garbage if the process stops before `array_uninit` */
+	if(bytes == 0 && array->data){
+		munmap(array->data, mapping->length);
+		array->data = NULL;
+		mapping->length = 0;
+	} else if(bytes != mapping->length && !array_remap(array, bytes)){
+		return NULL;
+	}
+	array->capacity = array->size;
+	if(array->data && msync(array->data, mapping->length, MS_SYNC) != 0) return NULL;
+	if(ftruncate(mapping->fd, (off_t)bytes) != 0) return NULL;
+	return array;
+#else
+	return NULL;
+#endif
+}
+
+/* Informs the system of how the elements of a file-backed array will be accessed */
+array_t* array_advise(array_t* array, enum array_advice advice){
+	if(!array || !array->mapping) return NULL;
+#ifdef DATALIB_HAS_MMAP
+	if(!array->data) return array;
+	int flag;
+	switch(advice){
+		case ARRAY_ADVICE_SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+		case ARRAY_ADVICE_RANDOM:     flag = MADV_RANDOM;     break;
+		case ARRAY_ADVICE_WILLNEED:   flag = MADV_WILLNEED;   break;
+		default:                      flag = MADV_NORMAL;     break;
+	}
+	if(madvise(array->data, array->mapping->length, flag) != 0) return NULL;
+	return array;
+#else
+	(void)advice;
+	return NULL;
+#endif
+}
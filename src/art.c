@@ -0,0 +1,804 @@
+#include "art.h"
+#include "array.h"
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+/* Layouts of the inner nodes, by maximum number of children */
+enum art_node_type {
+	ART_NODE4,
+	ART_NODE16,
+	ART_NODE48,
+	ART_NODE256
+};
+
+/* Header common to all inner nodes.
+   The compressed prefix is stored right after the layout-specific part. */
+struct art_node {
+	uint8_t type;			/* Layout (enum art_node_type) */
+	uint8_t has_value;		/* 1 if a key ends at this node */
+	uint16_t n_children;	/* Number of children */
+	uint32_t prefix_len;	/* Number of bytes of the compressed prefix */
+	void* value;			/* Value of the key that ends at this node */
+};
+
+/* Up to 4 children, with their bytes sorted */
+struct art_node4 {
+	struct art_node header;
+	unsigned char keys[4];
+	void* children[4];
+};
+
+/* Up to 16 children, with their bytes sorted */
+struct art_node16 {
+	struct art_node header;
+	unsigned char keys[16];
+	void* children[16];
+};
+
+/* Up to 48 children, found through a byte-indexed table of slots (0 for none) */
+struct art_node48 {
+	struct art_node header;
+	unsigned char index[256];
+	void* children[48];
+};
+
+/* Up to 256 children, indexed directly by byte */
+struct art_node256 {
+	struct art_node header;
+	void* children[256];
+};
+
+/* Leaf holding the bytes of a key below its parent node.
+   Leaves are distinguished from inner nodes by the lowest bit of their pointers. */
+struct art_leaf {
+	void* value;
+	uint32_t len;
+	unsigned char suffix[];
+};
+
+static const size_t art_node_sizes[] = {
+	sizeof(struct art_node4),
+	sizeof(struct art_node16),
+	sizeof(struct art_node48),
+	sizeof(struct art_node256)
+};
+
+/* Number of children below which a node shrinks to the previous layout */
+static const uint16_t art_shrink_sizes[] = {0, 4, 13, 40};
+
+
+/* -- NODES AND LEAVES -- */
+static int art_is_leaf(const void* p){
+	return (uintptr_t)p & 1;
+}
+
+static struct art_leaf* art_leaf(void* p){
+	return (struct art_leaf*)((uintptr_t)p & ~(uintptr_t)1);
+}
+
+/* Returns a tagged pointer to a new leaf, or NULL if it cannot be allocated */
+static void* art_new_leaf(const unsigned char* suffix, uint32_t len, void* value){
+	struct art_leaf* leaf = DATALIB_ALLOC(sizeof(struct art_leaf) + len);
+	if(!leaf) return NULL;
+	leaf->value = value;
+	leaf->len = len;
+	if(len) memcpy(leaf->suffix, suffix, len);
+	return (void*)((uintptr_t)leaf | 1);
+}
+
+static unsigned char* art_prefix(struct art_node* node){
+	return (unsigned char*)node + art_node_sizes[node->type];
+}
+
+/* Returns a new empty inner node with a given prefix */
+static struct art_node* art_new_node(enum art_node_type type, const unsigned char* prefix, uint32_t prefix_len){
+	struct art_node* node = DATALIB_ALLOC(art_node_sizes[type] + prefix_len);
+	if(!node) return NULL;
+	memset(node, 0, art_node_sizes[type]);
+	node->type = (uint8_t)type;
+	node->prefix_len = prefix_len;
+	if(prefix_len) memcpy(art_prefix(node), prefix, prefix_len);
+	return node;
+}
+
+/* Returns a new node of another layout with the same prefix and value, but no children */
+static struct art_node* art_new_node_like(enum art_node_type type, struct art_node* node){
+	struct art_node* copy = art_new_node(type, art_prefix(node), node->prefix_len);
+	if(!copy) return NULL;
+	copy->has_value = node->has_value;
+	copy->value = node->value;
+	copy->n_children = node->n_children;
+	return copy;
+}
+
+/* Frees a subtree */
+static void art_free(void* p){
+	if(!p) return;
+	if(art_is_leaf(p)){
+		DATALIB_FREE(art_leaf(p));
+		return;
+	}
+	struct art_node* node = p;
+	int i;
+	switch(node->type){
+	case ART_NODE4:
+		for(i = 0; i != node->n_children; ++i) art_free(((struct art_node4*)node)->children[i]);
+		break;
+	case ART_NODE16:
+		for(i = 0; i != node->n_children; ++i) art_free(((struct art_node16*)node)->children[i]);
+		break;
+	case ART_NODE48:
+		for(i = 0; i != 48; ++i) art_free(((struct art_node48*)node)->children[i]);
+		break;
+	case ART_NODE256:
+		for(i = 0; i != 256; ++i) art_free(((struct art_node256*)node)->children[i]);
+		break;
+	}
+	DATALIB_FREE(node);
+}
+
+/* Returns the position of a byte among the sorted bytes of a node16, or 16 if it is missing */
+static unsigned art_node16_find(const struct art_node16* node, unsigned char byte){
+#ifdef __SSE2__
+	__m128i keys = _mm_loadu_si128((const __m128i*)node->keys);
+	unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8((char)byte)));
+	mask &= (1u << node->header.n_children) - 1;
+	return mask ? (unsigned)__builtin_ctz(mask) : 16;
+#else
+	unsigned i;
+	for(i = 0; i != node->header.n_children; ++i){
+		if(node->keys[i] == byte) return i;
+	}
+	return 16;
+#endif
+}
+
+/* Returns a reference to the child of a node for a byte, or NULL if there is none */
+static void** art_child_ref(struct art_node* node, unsigned char byte){
+	unsigned i;
+	switch(node->type){
+	case ART_NODE4: {
+		struct art_node4* n = (struct art_node4*)node;
+		for(i = 0; i != node->n_children; ++i){
+			if(n->keys[i] == byte) return &n->children[i];
+		}
+		return NULL;
+	}
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		i = art_node16_find(n, byte);
+		return i < 16 ? &n->children[i] : NULL;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		return n->index[byte] ? &n->children[n->index[byte] - 1] : NULL;
+	}
+	case ART_NODE256: {
+		struct art_node256* n = (struct art_node256*)node;
+		return n->children[byte] ? &n->children[byte] : NULL;
+	}
+	}
+	return NULL;
+}
+
+/* Returns the next child of a node in byte order.
+   `pos` starts at zero and is advanced past the returned child.
+   Returns 0 once there are no more children. */
+static int art_child_next(struct art_node* node, unsigned* pos, unsigned char* byte, void** child){
+	switch(node->type){
+	case ART_NODE4: {
+		struct art_node4* n = (struct art_node4*)node;
+		if(*pos >= node->n_children) return 0;
+		*byte = n->keys[*pos];
+		*child = n->children[(*pos)++];
+		return 1;
+	}
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		if(*pos >= node->n_children) return 0;
+		*byte = n->keys[*pos];
+		*child = n->children[(*pos)++];
+		return 1;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		for(; *pos < 256; ++*pos){
+			if(n->index[*pos]){
+				*byte = (unsigned char)*pos;
+				*child = n->children[n->index[(*pos)++] - 1];
+				return 1;
+			}
+		}
+		return 0;
+	}
+	case ART_NODE256: {
+		struct art_node256* n = (struct art_node256*)node;
+		for(; *pos < 256; ++*pos){
+			if(n->children[*pos]){
+				*byte = (unsigned char)*pos;
+				*child = n->children[(*pos)++];
+				return 1;
+			}
+		}
+		return 0;
+	}
+	}
+	return 0;
+}
+
+/* Inserts a child in the sorted bytes of a node4 or node16 with room for it */
+static void art_insert_sorted(unsigned char* keys, void** children, uint16_t n, unsigned char byte, void* child){
+	uint16_t i = 0;
+	while(i < n && keys[i] < byte) i++;
+	memmove(keys + i + 1, keys + i, n - i);
+	memmove(children + i + 1, children + i, (n - i) * sizeof(void*));
+	keys[i] = byte;
+	children[i] = child;
+}
+
+/* Moves the children of a full node into a new node of the next layout */
+static struct art_node* art_grow(struct art_node* node){
+	unsigned i;
+	struct art_node* bigger = art_new_node_like((enum art_node_type)(node->type + 1), node);
+	if(!bigger) return NULL;
+
+	switch(node->type){
+	case ART_NODE4: {
+		struct art_node4* n = (struct art_node4*)node;
+		struct art_node16* b = (struct art_node16*)bigger;
+		memcpy(b->keys, n->keys, sizeof(n->keys));
+		memcpy(b->children, n->children, sizeof(n->children));
+		break;
+	}
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		struct art_node48* b = (struct art_node48*)bigger;
+		for(i = 0; i != 16; ++i){
+			b->index[n->keys[i]] = (unsigned char)(i + 1);
+			b->children[i] = n->children[i];
+		}
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		struct art_node256* b = (struct art_node256*)bigger;
+		for(i = 0; i != 256; ++i){
+			if(n->index[i]) b->children[i] = n->children[n->index[i] - 1];
+		}
+		break;
+	}
+	}
+	DATALIB_FREE(node);
+	return bigger;
+}
+
+/* Moves the children of a sparse node into a new node of the previous layout.
+   Returns the input node if the new node cannot be allocated. */
+static struct art_node* art_shrink(struct art_node* node){
+	unsigned i, j = 0;
+	struct art_node* smaller = art_new_node_like((enum art_node_type)(node->type - 1), node);
+	if(!smaller) return node;
+
+	switch(node->type){
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		struct art_node4* s = (struct art_node4*)smaller;
+		memcpy(s->keys, n->keys, node->n_children);
+		memcpy(s->children, n->children, node->n_children * sizeof(void*));
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		struct art_node16* s = (struct art_node16*)smaller;
+		for(i = 0; i != 256; ++i){
+			if(n->index[i]){
+				s->keys[j] = (unsigned char)i;
+				s->children[j++] = n->children[n->index[i] - 1];
+			}
+		}
+		break;
+	}
+	case ART_NODE256: {
+		struct art_node256* n = (struct art_node256*)node;
+		struct art_node48* s = (struct art_node48*)smaller;
+		for(i = 0; i != 256; ++i){
+			if(n->children[i]){
+				s->index[i] = (unsigned char)(j + 1);
+				s->children[j++] = n->children[i];
+			}
+		}
+		break;
+	}
+	}
+	DATALIB_FREE(node);
+	return smaller;
+}
+
+/* Adds a child to the node referenced by `ref`, growing it if it is full.
+   Returns 0 if a bigger node cannot be allocated. */
+static int art_add_child(void** ref, unsigned char byte, void* child){
+	struct art_node* node = *ref;
+	static const uint16_t capacities[] = {4, 16, 48, 256};
+	if(node->n_children == capacities[node->type]){
+		node = art_grow(node);
+		if(!node) return 0;
+		*ref = node;
+	}
+
+	switch(node->type){
+	case ART_NODE4: {
+		struct art_node4* n = (struct art_node4*)node;
+		art_insert_sorted(n->keys, n->children, node->n_children, byte, child);
+		break;
+	}
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		art_insert_sorted(n->keys, n->children, node->n_children, byte, child);
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		unsigned slot = 0;
+		while(n->children[slot]) slot++;
+		n->children[slot] = child;
+		n->index[byte] = (unsigned char)(slot + 1);
+		break;
+	}
+	case ART_NODE256:
+		((struct art_node256*)node)->children[byte] = child;
+		break;
+	}
+	node->n_children++;
+	return 1;
+}
+
+/* Removes the child for a byte from the node referenced by `ref`,
+   shrinking the node if it becomes sparse */
+static void art_remove_child(void** ref, unsigned char byte){
+	struct art_node* node = *ref;
+	unsigned i;
+	switch(node->type){
+	case ART_NODE4: {
+		struct art_node4* n = (struct art_node4*)node;
+		for(i = 0; n->keys[i] != byte; ++i);
+		memmove(n->keys + i, n->keys + i + 1, node->n_children - i - 1);
+		memmove(n->children + i, n->children + i + 1, (node->n_children - i - 1) * sizeof(void*));
+		break;
+	}
+	case ART_NODE16: {
+		struct art_node16* n = (struct art_node16*)node;
+		i = art_node16_find(n, byte);
+		memmove(n->keys + i, n->keys + i + 1, node->n_children - i - 1);
+		memmove(n->children + i, n->children + i + 1, (node->n_children - i - 1) * sizeof(void*));
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48* n = (struct art_node48*)node;
+		n->children[n->index[byte] - 1] = NULL;
+		n->index[byte] = 0;
+		break;
+	}
+	case ART_NODE256:
+		((struct art_node256*)node)->children[byte] = NULL;
+		break;
+	}
+	node->n_children--;
+	if(node->n_children < art_shrink_sizes[node->type]){
+		*ref = art_shrink(node);
+	}
+}
+
+/* Replaces a node that has no value and a single child, or a value and no children,
+   by a merged node or leaf. The node is left as it is if memory cannot be allocated. */
+static void art_collapse(void** ref){
+	struct art_node* node = *ref;
+	if(node->n_children == 0){
+		if(!node->has_value){
+			DATALIB_FREE(node);
+			*ref = NULL;
+			return;
+		}
+		void* leaf = art_new_leaf(art_prefix(node), node->prefix_len, node->value);
+		if(!leaf) return;
+		DATALIB_FREE(node);
+		*ref = leaf;
+		return;
+	}
+	if(node->n_children != 1 || node->has_value) return;
+
+	unsigned pos = 0;
+	unsigned char byte;
+	void* child;
+	art_child_next(node, &pos, &byte, &child);
+
+	/* The merged prefix is the node prefix, the byte of the child and the child prefix */
+	if(art_is_leaf(child)){
+		struct art_leaf* leaf = art_leaf(child);
+		uint32_t len = node->prefix_len + 1 + leaf->len;
+		struct art_leaf* merged = DATALIB_ALLOC(sizeof(struct art_leaf) + len);
+		if(!merged) return;
+		merged->value = leaf->value;
+		merged->len = len;
+		memcpy(merged->suffix, art_prefix(node), node->prefix_len);
+		merged->suffix[node->prefix_len] = byte;
+		memcpy(merged->suffix + node->prefix_len + 1, leaf->suffix, leaf->len);
+		DATALIB_FREE(leaf);
+		*ref = (void*)((uintptr_t)merged | 1);
+	} else {
+		struct art_node* inner = child;
+		size_t size = art_node_sizes[inner->type];
+		uint32_t len = node->prefix_len + 1 + inner->prefix_len;
+		struct art_node* merged = DATALIB_ALLOC(size + len);
+		if(!merged) return;
+		memcpy(merged, inner, size);
+		merged->prefix_len = len;
+		memcpy(art_prefix(merged), art_prefix(node), node->prefix_len);
+		art_prefix(merged)[node->prefix_len] = byte;
+		memcpy(art_prefix(merged) + node->prefix_len + 1, art_prefix(inner), inner->prefix_len);
+		DATALIB_FREE(inner);
+		*ref = merged;
+	}
+	DATALIB_FREE(node);
+}
+
+/* Returns the number of leading bytes of a node prefix that match a key */
+static uint32_t art_prefix_match(struct art_node* node, const unsigned char* key, uint32_t len){
+	const unsigned char* prefix = art_prefix(node);
+	uint32_t i, n = node->prefix_len < len ? node->prefix_len : len;
+	for(i = 0; i != n && prefix[i] == key[i]; ++i);
+	return i;
+}
+
+
+/* -- INSERTION -- */
+/* Replaces the leaf referenced by `ref` by a node4 that holds both the leaf
+   and a new key, branching where they differ. `key` is the rest of the new key. */
+static art_t* art_split_leaf(art_t* tree, void** ref, const unsigned char* key, uint32_t len, void* value){
+	struct art_leaf* old = art_leaf(*ref);
+	uint32_t common = 0;
+	while(common < old->len && common < len && old->suffix[common] == key[common]) common++;
+
+	struct art_node* node = art_new_node(ART_NODE4, key, common);
+	void* old_leaf = NULL;
+	void* new_leaf = NULL;
+	if(node && common < old->len){
+		old_leaf = art_new_leaf(old->suffix + common + 1, old->len - common - 1, old->value);
+	}
+	if(node && common < len){
+		new_leaf = art_new_leaf(key + common + 1, len - common - 1, value);
+	}
+	if(!node || (common < old->len && !old_leaf) || (common < len && !new_leaf)){
+		DATALIB_FREE(node);
+		art_free(old_leaf);
+		art_free(new_leaf);
+		return NULL;
+	}
+
+	void* inner = node;
+	if(old_leaf){
+		art_add_child(&inner, old->suffix[common], old_leaf);
+	} else {
+		node->has_value = 1;
+		node->value = old->value;
+	}
+	if(new_leaf){
+		art_add_child(&inner, key[common], new_leaf);
+	} else {
+		node->has_value = 1;
+		node->value = value;
+	}
+	DATALIB_FREE(old);
+	*ref = node;
+	tree->size++;
+	return tree;
+}
+
+/* Splits the prefix of the node referenced by `ref` at the first `common` bytes,
+   where it differs from the rest of a new key. */
+static art_t* art_split_prefix(art_t* tree, void** ref, uint32_t common,
+                               const unsigned char* key, uint32_t len, void* value){
+	struct art_node* old = *ref;
+	unsigned char* prefix = art_prefix(old);
+	struct art_node* node = art_new_node(ART_NODE4, prefix, common);
+	void* leaf = NULL;
+	if(node && common < len){
+		leaf = art_new_leaf(key + common + 1, len - common - 1, value);
+		if(!leaf){
+			DATALIB_FREE(node);
+			return NULL;
+		}
+	}
+	if(!node) return NULL;
+
+	/* The old node keeps the bytes after the branching byte */
+	unsigned char byte = prefix[common];
+	old->prefix_len -= common + 1;
+	memmove(prefix, prefix + common + 1, old->prefix_len);
+
+	void* inner = node;
+	art_add_child(&inner, byte, old);
+	if(leaf){
+		art_add_child(&inner, key[common], leaf);
+	} else {
+		node->has_value = 1;
+		node->value = value;
+	}
+	*ref = node;
+	tree->size++;
+	return tree;
+}
+
+art_t* art_setb(art_t* tree, const void* key_bytes, uint32_t key_length, void* value){
+	if(!tree || (!key_bytes && key_length)) return NULL;
+	const unsigned char* key = key_bytes;
+	void** ref = &tree->root;
+	uint32_t depth = 0;
+
+	for(;;){
+		void* p = *ref;
+		if(!p){
+			void* leaf = art_new_leaf(key + depth, key_length - depth, value);
+			if(!leaf) return NULL;
+			*ref = leaf;
+			tree->size++;
+			return tree;
+		}
+
+		if(art_is_leaf(p)){
+			struct art_leaf* leaf = art_leaf(p);
+			uint32_t rest = key_length - depth;
+			if(leaf->len == rest && (rest == 0 || memcmp(leaf->suffix, key + depth, rest) == 0)){
+				leaf->value = value;
+				return tree;
+			}
+			return art_split_leaf(tree, ref, key + depth, rest, value);
+		}
+
+		struct art_node* node = p;
+		uint32_t common = art_prefix_match(node, key + depth, key_length - depth);
+		if(common < node->prefix_len){
+			return art_split_prefix(tree, ref, common, key + depth, key_length - depth, value);
+		}
+		depth += node->prefix_len;
+		if(depth == key_length){
+			if(!node->has_value) tree->size++;
+			node->has_value = 1;
+			node->value = value;
+			return tree;
+		}
+
+		void** child = art_child_ref(node, key[depth]);
+		if(child){
+			ref = child;
+			depth++;
+			continue;
+		}
+		void* leaf = art_new_leaf(key + depth + 1, key_length - depth - 1, value);
+		if(!leaf) return NULL;
+		if(!art_add_child(ref, key[depth], leaf)){
+			art_free(leaf);
+			return NULL;
+		}
+		tree->size++;
+		return tree;
+	}
+}
+
+
+/* -- INITIALISATION -- */
+art_t* art_init(art_t* tree){
+	if(!tree) return NULL;
+	tree->root = NULL;
+	tree->size = 0;
+	return tree;
+}
+
+void art_uninit(art_t* tree){
+	if(!tree) return;
+	art_free(tree->root);
+	art_init(tree);
+}
+
+art_t* art_create(void){
+	art_t* tree = DATALIB_ALLOC(sizeof(art_t));
+	return art_init(tree);
+}
+
+void art_destroy(art_t* tree){
+	if(!tree) return;
+	art_uninit(tree);
+	DATALIB_FREE(tree);
+}
+
+
+/* -- LOOKUP -- */
+void* art_getb(art_t* tree, const void* key_bytes, uint32_t key_length){
+	if(!tree || (!key_bytes && key_length)) return NULL;
+	const unsigned char* key = key_bytes;
+	void* p = tree->root;
+	uint32_t depth = 0;
+
+	while(p){
+		if(art_is_leaf(p)){
+			struct art_leaf* leaf = art_leaf(p);
+			uint32_t rest = key_length - depth;
+			if(leaf->len != rest) return NULL;
+			if(rest && memcmp(leaf->suffix, key + depth, rest) != 0) return NULL;
+			return leaf->value;
+		}
+		struct art_node* node = p;
+		if(art_prefix_match(node, key + depth, key_length - depth) != node->prefix_len) return NULL;
+		depth += node->prefix_len;
+		if(depth == key_length) return node->has_value ? node->value : NULL;
+		void** child = art_child_ref(node, key[depth++]);
+		p = child ? *child : NULL;
+	}
+	return NULL;
+}
+
+void* art_longest_prefix(art_t* tree, const void* key_bytes, uint32_t key_length, uint32_t* match_length){
+	void* best = NULL;
+	uint32_t best_length = 0;
+	if(match_length) *match_length = 0;
+	if(!tree || (!key_bytes && key_length)) return NULL;
+	const unsigned char* key = key_bytes;
+	void* p = tree->root;
+	uint32_t depth = 0;
+
+	while(p){
+		if(art_is_leaf(p)){
+			struct art_leaf* leaf = art_leaf(p);
+			if(leaf->len <= key_length - depth
+			&& (leaf->len == 0 || memcmp(leaf->suffix, key + depth, leaf->len) == 0)){
+				best = leaf->value;
+				best_length = depth + leaf->len;
+			}
+			break;
+		}
+		struct art_node* node = p;
+		if(art_prefix_match(node, key + depth, key_length - depth) != node->prefix_len) break;
+		depth += node->prefix_len;
+		if(node->has_value){
+			best = node->value;
+			best_length = depth;
+		}
+		if(depth == key_length) break;
+		void** child = art_child_ref(node, key[depth++]);
+		p = child ? *child : NULL;
+	}
+	if(match_length) *match_length = best_length;
+	return best;
+}
+
+
+/* -- REMOVAL -- */
+/* Removes a key from the subtree referenced by `ref`.
+   Returns 1 and sets `value` if the key was found. */
+static int art_remove(void** ref, const unsigned char* key, uint32_t key_length, uint32_t depth, void** value){
+	void* p = *ref;
+	if(!p) return 0;
+
+	if(art_is_leaf(p)){
+		struct art_leaf* leaf = art_leaf(p);
+		uint32_t rest = key_length - depth;
+		if(leaf->len != rest || (rest && memcmp(leaf->suffix, key + depth, rest) != 0)) return 0;
+		*value = leaf->value;
+		DATALIB_FREE(leaf);
+		*ref = NULL;
+		return 1;
+	}
+
+	struct art_node* node = p;
+	if(art_prefix_match(node, key + depth, key_length - depth) != node->prefix_len) return 0;
+	depth += node->prefix_len;
+	if(depth == key_length){
+		if(!node->has_value) return 0;
+		*value = node->value;
+		node->has_value = 0;
+		node->value = NULL;
+	} else {
+		unsigned char byte = key[depth];
+		void** child = art_child_ref(node, byte);
+		if(!child || !art_remove(child, key, key_length, depth + 1, value)) return 0;
+		if(!*child) art_remove_child(ref, byte);
+	}
+	art_collapse(ref);
+	return 1;
+}
+
+void* art_removeb(art_t* tree, const void* key, uint32_t key_length){
+	if(!tree || (!key && key_length)) return NULL;
+	void* value = NULL;
+	if(art_remove(&tree->root, key, key_length, 0, &value)) tree->size--;
+	return value;
+}
+
+
+/* -- ITERATION -- */
+/* State of a prefix iteration */
+struct art_walk {
+	array_t key;	/* Bytes of the current key */
+	int (*fn)(const void* key, uint32_t key_length, void* value, void* args);
+	void* args;
+	size_t calls;
+	int stop;
+};
+
+/* Appends bytes to the current key of a walk, stopping the walk if it cannot grow */
+static int art_walk_append(struct art_walk* walk, const void* bytes, size_t n){
+	if(n && !array_push_back_n(&walk->key, bytes, n)){
+		walk->stop = 1;
+		return 0;
+	}
+	return 1;
+}
+
+static void art_walk_emit(struct art_walk* walk, void* value){
+	walk->calls++;
+	const char* key = walk->key.size ? walk->key.data : "";
+	if(!walk->fn(key, (uint32_t)walk->key.size, value, walk->args)) walk->stop = 1;
+}
+
+/* Visits every key of a subtree in order */
+static void art_walk(struct art_walk* walk, void* p){
+	size_t size = walk->key.size;
+	if(art_is_leaf(p)){
+		struct art_leaf* leaf = art_leaf(p);
+		if(art_walk_append(walk, leaf->suffix, leaf->len)) art_walk_emit(walk, leaf->value);
+		array_resize(&walk->key, size);
+		return;
+	}
+
+	struct art_node* node = p;
+	if(!art_walk_append(walk, art_prefix(node), node->prefix_len)) return;
+	if(node->has_value) art_walk_emit(walk, node->value);
+
+	unsigned pos = 0;
+	unsigned char byte;
+	void* child;
+	while(!walk->stop && art_child_next(node, &pos, &byte, &child)){
+		if(!art_walk_append(walk, &byte, 1)) break;
+		art_walk(walk, child);
+		array_resize(&walk->key, size + node->prefix_len);
+	}
+	array_resize(&walk->key, size);
+}
+
+size_t art_foreach_prefix(art_t* tree, const void* prefix_bytes, uint32_t prefix_length,
+                          int (*fn)(const void* key, uint32_t key_length, void* value, void* args),
+                          void* args){
+	if(!tree || !fn || (!prefix_bytes && prefix_length)) return 0;
+	const unsigned char* prefix = prefix_bytes;
+	void* p = tree->root;
+	uint32_t depth = 0;
+
+	/* Finds the subtree of the keys that start with the prefix */
+	while(p && !art_is_leaf(p)){
+		struct art_node* node = p;
+		uint32_t rest = prefix_length - depth;
+		uint32_t common = art_prefix_match(node, prefix + depth, rest);
+		if(common == rest) break;
+		if(common != node->prefix_len) return 0;
+		depth += node->prefix_len;
+		void** child = art_child_ref(node, prefix[depth++]);
+		p = child ? *child : NULL;
+	}
+	if(!p) return 0;
+	if(art_is_leaf(p)){
+		struct art_leaf* leaf = art_leaf(p);
+		uint32_t rest = prefix_length - depth;
+		if(leaf->len < rest || (rest && memcmp(leaf->suffix, prefix + depth, rest) != 0)) return 0;
+	}
+
+	struct art_walk walk;
+	array_init(&walk.key, sizeof(char));
+	walk.fn = fn;
+	walk.args = args;
+	walk.calls = 0;
+	walk.stop = 0;
+	if(art_walk_append(&walk, prefix, depth)) art_walk(&walk, p);
+	array_uninit(&walk.key);
+	return walk.calls;
+}
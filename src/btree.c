@@ -0,0 +1,527 @@
+#include "btree.h"
+
+/* Max number of levels of a tree. Nodes split in halves have at least
+   `BTREE_NODE_KEYS / 2` children, so this is never reached in practice. */
+#define BTREE_MAX_HEIGHT 32
+
+/* Result of an insertion into a subtree that had to split */
+struct btree_split {
+	struct btree_key separator;	/* Smallest key of the new right node */
+	uint64_t prefix;			/* Prefix of the separator */
+	struct btree_node* right;	/* New node placed after the split one */
+};
+
+
+/* -- KEYS -- */
+/* Returns the first 8 bytes of a key as a big-endian integer, padded with zeros */
+static uint64_t btree_prefix(const void* key, uint32_t key_length){
+	const unsigned char* bytes = key;
+	uint64_t prefix = 0;
+	uint32_t i, n = key_length < 8 ? key_length : 8;
+	for(i = 0; i != n; ++i){
+		prefix |= (uint64_t)bytes[i] << (56 - 8 * i);
+	}
+	return prefix;
+}
+
+/* Compares the key at position `i` of a node with a key.
+   The full keys are only read if their prefixes are equal. */
+static int btree_compare(const struct btree_node* node, uint32_t i,
+                         const char* key, uint32_t key_length, uint64_t prefix){
+	if(node->prefixes[i] != prefix) return node->prefixes[i] < prefix ? -1 : 1;
+
+	const struct btree_key* k = &node->keys[i];
+	uint32_t n = k->len < key_length ? k->len : key_length;
+	if(n > 8){
+		int r = memcmp(k->data + 8, key + 8, n - 8);
+		if(r) return r;
+	}
+	return (k->len > key_length) - (k->len < key_length);
+}
+
+/* Counts the keys of a node whose prefix is less than, and not greater than, a prefix.
+   A branchless pass over the contiguous prefixes avoids the mispredictions of a binary search. */
+static void btree_prefix_range(const struct btree_node* node, uint64_t prefix, uint32_t* lo, uint32_t* hi){
+	uint32_t i, less = 0, equal = 0;
+	for(i = 0; i != node->n_keys; ++i){
+		less += node->prefixes[i] < prefix;
+		equal += node->prefixes[i] == prefix;
+	}
+	*lo = less;
+	*hi = less + equal;
+}
+
+/* Returns the position of the first key of a node not less than a key.
+   Full keys are only compared among those with the same prefix. */
+static uint32_t btree_node_lower_bound(const struct btree_node* node,
+                                       const char* key, uint32_t key_length, uint64_t prefix){
+	uint32_t lo, hi;
+	btree_prefix_range(node, prefix, &lo, &hi);
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo) / 2;
+		if(btree_compare(node, mid, key, key_length, prefix) < 0){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/* Returns the child of an internal node whose subtree may hold a key,
+   which is the number of separators not greater than the key */
+static uint32_t btree_child_index(const struct btree_node* node,
+                                  const char* key, uint32_t key_length, uint64_t prefix){
+	uint32_t lo, hi;
+	btree_prefix_range(node, prefix, &lo, &hi);
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo) / 2;
+		if(btree_compare(node, mid, key, key_length, prefix) <= 0){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/* Returns a copy of a key allocated on the heap */
+static int btree_copy_key(struct btree_key* dest, const void* key, uint32_t key_length){
+	dest->data = DATALIB_ALLOC(key_length ? key_length : 1);
+	if(!dest->data) return 0;
+	if(key_length) memcpy(dest->data, key, key_length);
+	dest->len = key_length;
+	return 1;
+}
+
+
+/* -- NODES -- */
+static struct btree_node* btree_new_node(uint32_t leaf){
+	struct btree_node* node = DATALIB_ALLOC(sizeof(struct btree_node));
+	if(!node) return NULL;
+	node->n_keys = 0;
+	node->leaf = leaf;
+	node->next = NULL;
+	return node;
+}
+
+/* Frees a subtree with all its keys */
+static void btree_free_node(struct btree_node* node){
+	uint32_t i;
+	if(!node->leaf){
+		for(i = 0; i <= node->n_keys; ++i){
+			btree_free_node(node->slots.children[i]);
+		}
+	}
+	for(i = 0; i != node->n_keys; ++i){
+		DATALIB_FREE(node->keys[i].data);
+	}
+	DATALIB_FREE(node);
+}
+
+/* Returns the leaf whose range holds a key */
+static struct btree_node* btree_find_leaf(btree_t* tree, const char* key, uint32_t key_length, uint64_t prefix){
+	struct btree_node* node = tree->root;
+	while(node && !node->leaf){
+		node = node->slots.children[btree_child_index(node, key, key_length, prefix)];
+	}
+	return node;
+}
+
+/* Opens a gap at position `i` of the keys of a node */
+static void btree_shift_keys(struct btree_node* node, uint32_t i){
+	uint32_t n = node->n_keys - i;
+	memmove(node->prefixes + i + 1, node->prefixes + i, n * sizeof(uint64_t));
+	memmove(node->keys + i + 1, node->keys + i, n * sizeof(struct btree_key));
+}
+
+/* Moves the keys from position `from` of a node to the start of an empty node */
+static void btree_move_keys(struct btree_node* dest, struct btree_node* src, uint32_t from){
+	uint32_t n = src->n_keys - from;
+	memcpy(dest->prefixes, src->prefixes + from, n * sizeof(uint64_t));
+	memcpy(dest->keys, src->keys + from, n * sizeof(struct btree_key));
+	dest->n_keys = n;
+	src->n_keys = from;
+}
+
+/* Splits a full leaf in two halves into an empty leaf `right`.
+   The separator is the first key of the right half, copied into `separator`,
+   a buffer of the right length allocated beforehand. */
+static void btree_split_leaf(struct btree_node* leaf, struct btree_node* right,
+                             char* separator, struct btree_split* split){
+	uint32_t half = leaf->n_keys / 2;
+	memcpy(right->slots.values, leaf->slots.values + half, (leaf->n_keys - half) * sizeof(void*));
+	btree_move_keys(right, leaf, half);
+	if(right->keys[0].len) memcpy(separator, right->keys[0].data, right->keys[0].len);
+	split->separator.data = separator;
+	split->separator.len = right->keys[0].len;
+	split->prefix = right->prefixes[0];
+	split->right = right;
+	right->next = leaf->next;
+	leaf->next = right;
+}
+
+/* Splits a full internal node into an empty internal node `right`.
+   The middle separator moves up to the parent. */
+static void btree_split_internal(struct btree_node* node, struct btree_node* right,
+                                 struct btree_split* split){
+	uint32_t mid = node->n_keys / 2;
+	split->separator = node->keys[mid];
+	split->prefix = node->prefixes[mid];
+	memcpy(right->slots.children, node->slots.children + mid + 1,
+		(node->n_keys - mid) * sizeof(struct btree_node*));
+	btree_move_keys(right, node, mid + 1);
+	node->n_keys = mid;
+	split->right = right;
+}
+
+/* Inserts a key at position `i` of a node */
+static void btree_insert_key(struct btree_node* node, uint32_t i, struct btree_key key, uint64_t prefix){
+	btree_shift_keys(node, i);
+	node->prefixes[i] = prefix;
+	node->keys[i] = key;
+	node->n_keys++;
+}
+
+/* Returns the length of the key that becomes the first of the right half
+   when a key is inserted at position `i` of a leaf about to split */
+static uint32_t btree_split_key_length(const struct btree_node* leaf, uint32_t i, uint32_t key_length){
+	uint32_t half = (leaf->n_keys + 1) / 2;
+	if(i == half) return key_length;
+	return leaf->keys[i < half ? half - 1 : half].len;
+}
+
+
+/* -- INITIALISATION -- */
+btree_t* btree_init(btree_t* tree){
+	if(!tree) return NULL;
+	tree->root = NULL;
+	tree->size = 0;
+	return tree;
+}
+
+void btree_uninit(btree_t* tree){
+	if(!tree) return;
+	if(tree->root) btree_free_node(tree->root);
+	btree_init(tree);
+}
+
+btree_t* btree_create(void){
+	btree_t* tree = DATALIB_ALLOC(sizeof(btree_t));
+	return btree_init(tree);
+}
+
+void btree_destroy(btree_t* tree){
+	if(!tree) return;
+	btree_uninit(tree);
+	DATALIB_FREE(tree);
+}
+
+
+/* -- ACCESS -- */
+void* btree_getb(btree_t* tree, const void* key, uint32_t key_length){
+	if(!tree || !key) return NULL;
+	uint64_t prefix = btree_prefix(key, key_length);
+	struct btree_node* leaf = btree_find_leaf(tree, key, key_length, prefix);
+	if(!leaf) return NULL;
+	uint32_t i = btree_node_lower_bound(leaf, key, key_length, prefix);
+	if(i < leaf->n_keys && btree_compare(leaf, i, key, key_length, prefix) == 0){
+		return leaf->slots.values[i];
+	}
+	return NULL;
+}
+
+void* btree_get(btree_t* tree, const char* key){
+	if(!key) return NULL;
+	return btree_getb(tree, key, strlen(key) + 1);
+}
+
+btree_t* btree_setb(btree_t* tree, const void* key, uint32_t key_length, void* value){
+	if(!tree || !key) return NULL;
+	if(!tree->root){
+		tree->root = btree_new_node(1);
+		if(!tree->root) return NULL;
+	}
+
+	/* Path from the root to the leaf of the key */
+	struct btree_node* path[BTREE_MAX_HEIGHT];
+	uint32_t child[BTREE_MAX_HEIGHT];
+	uint64_t prefix = btree_prefix(key, key_length);
+	size_t height = 0;
+	struct btree_node* leaf = tree->root;
+	while(!leaf->leaf){
+		path[height] = leaf;
+		child[height] = btree_child_index(leaf, key, key_length, prefix);
+		leaf = leaf->slots.children[child[height]];
+		height++;
+	}
+	uint32_t i = btree_node_lower_bound(leaf, key, key_length, prefix);
+	if(i < leaf->n_keys && btree_compare(leaf, i, key, key_length, prefix) == 0){
+		leaf->slots.values[i] = value;
+		return tree;
+	}
+
+	/* Nodes that become full split, from the leaf up to the first one with room.
+	   Everything the splits need is allocated first, so that a failure leaves the tree intact. */
+	size_t n_splits = 0;
+	if(leaf->n_keys + 1 == BTREE_NODE_KEYS){
+		n_splits = 1;
+		while(n_splits <= height && path[height - n_splits]->n_keys + 1 == BTREE_NODE_KEYS){
+			n_splits++;
+		}
+	}
+	struct btree_node* nodes[BTREE_MAX_HEIGHT + 1];
+	size_t n_nodes = n_splits + (n_splits > height);
+	size_t n_allocated = 0;
+	char* separator = NULL;
+	struct btree_key copy;
+	int ok = btree_copy_key(&copy, key, key_length);
+	if(ok && n_splits){
+		separator = DATALIB_ALLOC(btree_split_key_length(leaf, i, key_length) + 1);
+		ok = separator != NULL;
+	}
+	while(ok && n_allocated != n_nodes){
+		/* The first node is the right half of the leaf */
+		nodes[n_allocated] = btree_new_node(n_allocated == 0);
+		ok = nodes[n_allocated] != NULL;
+		if(ok) n_allocated++;
+	}
+	if(!ok){
+		DATALIB_FREE(copy.data);
+		DATALIB_FREE(separator);
+		while(n_allocated--) DATALIB_FREE(nodes[n_allocated]);
+		return NULL;
+	}
+
+	memmove(leaf->slots.values + i + 1, leaf->slots.values + i, (leaf->n_keys - i) * sizeof(void*));
+	leaf->slots.values[i] = value;
+	btree_insert_key(leaf, i, copy, prefix);
+	tree->size++;
+	if(n_splits == 0) return tree;
+
+	struct btree_split split;
+	btree_split_leaf(leaf, nodes[0], separator, &split);
+	size_t s;
+	for(s = 1; s <= n_splits && s <= height; ++s){
+		/* Adds the new right node to its parent, which splits too if it is full */
+		struct btree_node* parent = path[height - s];
+		uint32_t c = child[height - s];
+		memmove(parent->slots.children + c + 2, parent->slots.children + c + 1,
+			(parent->n_keys - c) * sizeof(struct btree_node*));
+		parent->slots.children[c + 1] = split.right;
+		btree_insert_key(parent, c, split.separator, split.prefix);
+		if(s == n_splits) return tree;
+		btree_split_internal(parent, nodes[s], &split);
+	}
+
+	/* The root split: the tree grows one level */
+	struct btree_node* root = nodes[n_nodes - 1];
+	root->prefixes[0] = split.prefix;
+	root->keys[0] = split.separator;
+	root->slots.children[0] = tree->root;
+	root->slots.children[1] = split.right;
+	root->n_keys = 1;
+	tree->root = root;
+	return tree;
+}
+
+btree_t* btree_set(btree_t* tree, const char* key, void* value){
+	if(!key) return NULL;
+	return btree_setb(tree, key, strlen(key) + 1, value);
+}
+
+void* btree_removeb(btree_t* tree, const void* key, uint32_t key_length){
+	if(!tree || !key) return NULL;
+	uint64_t prefix = btree_prefix(key, key_length);
+	struct btree_node* leaf = btree_find_leaf(tree, key, key_length, prefix);
+	if(!leaf) return NULL;
+	uint32_t i = btree_node_lower_bound(leaf, key, key_length, prefix);
+	if(i == leaf->n_keys || btree_compare(leaf, i, key, key_length, prefix) != 0) return NULL;
+
+	void* value = leaf->slots.values[i];
+	DATALIB_FREE(leaf->keys[i].data);
+	uint32_t n = leaf->n_keys - i - 1;
+	memmove(leaf->prefixes + i, leaf->prefixes + i + 1, n * sizeof(uint64_t));
+	memmove(leaf->keys + i, leaf->keys + i + 1, n * sizeof(struct btree_key));
+	memmove(leaf->slots.values + i, leaf->slots.values + i + 1, n * sizeof(void*));
+	leaf->n_keys--;
+	tree->size--;
+	return value;
+}
+
+void* btree_remove(btree_t* tree, const char* key){
+	if(!key) return NULL;
+	return btree_removeb(tree, key, strlen(key) + 1);
+}
+
+
+/* -- BULK LOADING -- */
+/* Compares two byte keys in lexicographic order */
+static int btree_key_compare(const void* a, uint32_t a_length, const void* b, uint32_t b_length){
+	uint32_t n = a_length < b_length ? a_length : b_length;
+	int r = n ? memcmp(a, b, n) : 0;
+	if(r) return r;
+	return (a_length > b_length) - (a_length < b_length);
+}
+
+/* Returns the smallest key of a subtree */
+static const struct btree_key* btree_min_key(const struct btree_node* node){
+	while(!node->leaf) node = node->slots.children[0];
+	return &node->keys[0];
+}
+
+/* Frees the subtrees in `[begin, end)` of a level */
+static void btree_free_level(struct btree_node** level, size_t begin, size_t end){
+	for(; begin < end; ++begin) btree_free_node(level[begin]);
+}
+
+/* Builds the leaves holding `n` sorted keys, evenly filled and chained.
+   Returns the number of leaves, or 0 if memory cannot be allocated. */
+static size_t btree_load_leaves(struct btree_node** leaves, size_t m, const void* const* keys,
+                                const uint32_t* key_lengths, void* const* values, size_t n){
+	size_t j, k;
+	for(j = 0; j != m; ++j){
+		leaves[j] = btree_new_node(1);
+		if(!leaves[j]){
+			btree_free_level(leaves, 0, j);
+			return 0;
+		}
+	}
+	for(j = 0; j != m; ++j){
+		struct btree_node* leaf = leaves[j];
+		size_t first = n * j / m, count = n * (j + 1) / m - first;
+		for(k = 0; k != count; ++k){
+			if(!btree_copy_key(&leaf->keys[k], keys[first + k], key_lengths[first + k])){
+				btree_free_level(leaves, 0, m);
+				return 0;
+			}
+			leaf->prefixes[k] = btree_prefix(keys[first + k], key_lengths[first + k]);
+			leaf->slots.values[k] = values[first + k];
+			leaf->n_keys++;
+		}
+		leaf->next = j + 1 < m ? leaves[j + 1] : NULL;
+	}
+	return m;
+}
+
+/* Builds the parents of the `m` nodes of a level, each with up to `BTREE_NODE_KEYS` children.
+   Returns the number of parents, or 0 if memory cannot be allocated,
+   in which case all nodes of the level are freed. */
+static size_t btree_load_parents(struct btree_node** parents, struct btree_node** level, size_t m){
+	size_t p = (m + BTREE_NODE_KEYS - 1) / BTREE_NODE_KEYS;
+	size_t j, k;
+	for(j = 0; j != p; ++j){
+		parents[j] = btree_new_node(0);
+		if(!parents[j]){
+			while(j--) DATALIB_FREE(parents[j]);
+			btree_free_level(level, 0, m);
+			return 0;
+		}
+	}
+	for(j = 0; j != p; ++j){
+		struct btree_node* parent = parents[j];
+		size_t first = m * j / p, count = m * (j + 1) / p - first;
+		parent->slots.children[0] = level[first];
+		for(k = 1; k != count; ++k){
+			const struct btree_key* min = btree_min_key(level[first + k]);
+			if(!btree_copy_key(&parent->keys[k - 1], min->data, min->len)){
+				/* Parents up to this one own their children */
+				btree_free_level(parents, 0, j + 1);
+				btree_free_level(level, first + k, m);
+				while(++j < p) DATALIB_FREE(parents[j]);
+				return 0;
+			}
+			parent->prefixes[k - 1] = btree_prefix(min->data, min->len);
+			parent->slots.children[k] = level[first + k];
+			parent->n_keys++;
+		}
+	}
+	return p;
+}
+
+btree_t* btree_load_sortedb(btree_t* tree, const void* const* keys, const uint32_t* key_lengths,
+                            void* const* values, size_t n){
+	if(!tree || tree->root || (n && (!keys || !key_lengths || !values))) return NULL;
+	if(n == 0) return tree;
+
+	size_t i;
+	for(i = 0; i != n; ++i){
+		if(!keys[i]) return NULL;
+		if(i && btree_key_compare(keys[i - 1], key_lengths[i - 1], keys[i], key_lengths[i]) >= 0){
+			return NULL;
+		}
+	}
+
+	/* Nodes are filled up to one key below the size that triggers a split */
+	size_t m = (n + BTREE_NODE_KEYS - 2) / (BTREE_NODE_KEYS - 1);
+	struct btree_node** level = DATALIB_ALLOC(m * sizeof(struct btree_node*));
+	struct btree_node** parents = DATALIB_ALLOC(m * sizeof(struct btree_node*));
+	if(!level || !parents || !btree_load_leaves(level, m, keys, key_lengths, values, n)){
+		DATALIB_FREE(level);
+		DATALIB_FREE(parents);
+		return NULL;
+	}
+
+	while(m > 1){
+		m = btree_load_parents(parents, level, m);
+		if(!m) break;
+		struct btree_node** temp = level;
+		level = parents;
+		parents = temp;
+	}
+	if(m){
+		tree->root = level[0];
+		tree->size = n;
+	}
+	DATALIB_FREE(level);
+	DATALIB_FREE(parents);
+	return m ? tree : NULL;
+}
+
+
+/* -- ITERATION -- */
+/* Moves an iterator forward to the first pair at or after its position, skipping empty leaves */
+static void btree_iter_settle(btree_iter_t* it){
+	while(it->leaf && it->index >= it->leaf->n_keys){
+		it->leaf = it->leaf->next;
+		it->index = 0;
+	}
+	if(it->leaf){
+		it->key = it->leaf->keys[it->index].data;
+		it->key_length = it->leaf->keys[it->index].len;
+		it->value = it->leaf->slots.values[it->index];
+	} else {
+		it->key = NULL;
+		it->key_length = 0;
+		it->value = NULL;
+	}
+}
+
+btree_iter_t btree_begin(btree_t* tree){
+	btree_iter_t it = {0};
+	struct btree_node* node = tree ? tree->root : NULL;
+	while(node && !node->leaf) node = node->slots.children[0];
+	it.leaf = node;
+	btree_iter_settle(&it);
+	return it;
+}
+
+btree_iter_t btree_lower_bound(btree_t* tree, const void* key, uint32_t key_length){
+	btree_iter_t it = {0};
+	if(!tree || !key) return it;
+	uint64_t prefix = btree_prefix(key, key_length);
+	it.leaf = btree_find_leaf(tree, key, key_length, prefix);
+	if(it.leaf) it.index = btree_node_lower_bound(it.leaf, key, key_length, prefix);
+	btree_iter_settle(&it);
+	return it;
+}
+
+int btree_iter_valid(const btree_iter_t* it){
+	return it && it->leaf != NULL;
+}
+
+void btree_next(btree_iter_t* it){
+	if(!it || !it->leaf) return;
+	it->index++;
+	btree_iter_settle(it);
+}
@@ -0,0 +1,203 @@
+#include "deque.h"
+
+
+/* Returns the nearest highest power of two of an integer */
+static size_t deque_nearest_power_of_two(size_t n){
+	if(n <= 1) return 1;
+	size_t x = 2;
+	n--;
+	while (n >>= 1) x <<= 1;
+	return x;
+}
+
+/* Returns the address of the element at a given position of the ring buffer */
+static char* deque_slot(deque_t* deque, size_t position){
+	return deque->data + (position & (deque->capacity - 1)) * deque->element_size;
+}
+
+/* Copies an element into a slot, or zeroes it if the element is NULL */
+static void deque_write(deque_t* deque, char* slot, const void* element){
+	if(!element){
+		memset(slot, 0, deque->element_size);
+	} else {
+		memcpy(slot, element, deque->element_size);
+	}
+}
+
+/* Moves the elements into a larger buffer, starting at position zero */
+static deque_t* deque_extend_capacity(deque_t* deque, size_t capacity){
+	char* data = DATALIB_ALIGNED_ALLOC(capacity * deque->element_size);
+	if(!data) return NULL;
+
+	void *first, *second;
+	size_t first_size, second_size;
+	deque_segments(deque, &first, &first_size, &second, &second_size);
+	if(first_size){
+		memcpy(data, first, first_size * deque->element_size);
+	}
+	if(second_size){
+		memcpy(data + first_size * deque->element_size, second,
+			second_size * deque->element_size);
+	}
+
+	DATALIB_ALIGNED_FREE(deque->data);
+	deque->data = data;
+	deque->head = 0;
+	deque->capacity = capacity;
+	return deque;
+}
+
+
+/* -- INITIALIZATIONS -- */
+
+/* Initialises a deque via a given pointer */
+void* deque_init(deque_t* deque, size_t element_size){
+	if(!deque) return NULL;
+	*deque = (deque_t){0};
+	if(element_size == 0) return NULL;
+	deque->element_size = element_size;
+	return deque;
+}
+
+/* Deallocates and resets the deque without freeing the object itself */
+void deque_uninit(deque_t* deque){
+	if(!deque) return;
+	if(deque->data) DATALIB_ALIGNED_FREE(deque->data);
+	*deque = (deque_t){0};
+}
+
+/* Creates a new empty deque */
+deque_t* deque_create(size_t element_size){
+	if(element_size == 0) return NULL;
+	deque_t* deque = DATALIB_ALLOC(sizeof(deque_t));
+	if(!deque) return NULL;
+	deque_init(deque, element_size);
+	return deque;
+}
+
+/* Frees a deque and its elements */
+void deque_destroy(deque_t* deque){
+	if(!deque) return;
+	deque_uninit(deque);
+	DATALIB_FREE(deque);
+}
+
+/* Allocates space for at least `capacity` elements */
+deque_t* deque_reserve(deque_t* deque, size_t capacity){
+	if(!deque || deque->element_size == 0) return NULL;
+	if(capacity <= deque->capacity) return deque;
+	return deque_extend_capacity(deque, deque_nearest_power_of_two(capacity));
+}
+
+
+/* -- RETRIEVALS -- */
+
+/* Returns a pointer to the element at the given index from the front */
+void* deque_get(deque_t* deque, size_t index){
+	if(!deque || index >= deque->size) return NULL;
+	return deque_slot(deque, deque->head + index);
+}
+
+/* Returns a pointer to the first element */
+void* deque_front(deque_t* deque){
+	if(!deque || deque->size == 0) return NULL;
+	return deque_slot(deque, deque->head);
+}
+
+/* Returns a pointer to the last element */
+void* deque_back(deque_t* deque){
+	if(!deque || deque->size == 0) return NULL;
+	return deque_slot(deque, deque->head + deque->size - 1);
+}
+
+/* Returns the elements of the deque as two contiguous segments */
+size_t deque_segments(deque_t* deque, void** first, size_t* first_size,
+                      void** second, size_t* second_size){
+	void* seg1 = NULL, *seg2 = NULL;
+	size_t size1 = 0, size2 = 0;
+
+	if(deque && deque->size > 0){
+		size_t until_end = deque->capacity - deque->head;
+		seg1 = deque->data + deque->head * deque->element_size;
+		size1 = deque->size < until_end ? deque->size : until_end;
+		size2 = deque->size - size1;
+		if(size2) seg2 = deque->data;
+	}
+
+	if(first) *first = seg1;
+	if(first_size) *first_size = size1;
+	if(second) *second = seg2;
+	if(second_size) *second_size = size2;
+	return size1 + size2;
+}
+
+
+/* -- INSERTING -- */
+
+/* Grows a full deque to make room for one more element.
+   An element pointing into the deque itself is found again in the new buffer */
+static deque_t* deque_grow(deque_t* deque, const void** element){
+	uintptr_t begin = (uintptr_t)deque->data, p = (uintptr_t)*element;
+	int is_inner = p && begin && p >= begin && p < begin + deque->capacity * deque->element_size;
+	size_t offset = is_inner ? (size_t)(p - begin) : 0;
+	size_t index = (offset / deque->element_size - deque->head) & (deque->capacity - 1);
+
+	if(!deque_reserve(deque, deque->size + 1)) return NULL;
+	if(is_inner) *element = deque_slot(deque, deque->head + index) + offset % deque->element_size;
+	return deque;
+}
+
+/* Inserts an element at the end of the deque */
+deque_t* deque_push_back(deque_t* deque, const void* element){
+	if(!deque || deque->element_size == 0) return NULL;
+	if(deque->size == deque->capacity){
+		if(!deque_grow(deque, &element)) return NULL;
+	}
+	deque_write(deque, deque_slot(deque, deque->head + deque->size), element);
+	deque->size++;
+	return deque;
+}
+
+/* Inserts an element at the beginning of the deque */
+deque_t* deque_push_front(deque_t* deque, const void* element){
+	if(!deque || deque->element_size == 0) return NULL;
+	if(deque->size == deque->capacity){
+		if(!deque_grow(deque, &element)) return NULL;
+	}
+	deque->head = (deque->head - 1) & (deque->capacity - 1);
+	deque_write(deque, deque_slot(deque, deque->head), element);
+	deque->size++;
+	return deque;
+}
+
+
+/* -- DELETING -- */
+
+/* Removes the last element of the deque */
+deque_t* deque_pop_back(deque_t* deque){
+	if(!deque || deque->size == 0) return NULL;
+	deque->size--;
+	return deque;
+}
+
+/* Removes the first element of the deque */
+deque_t* deque_pop_front(deque_t* deque){
+	return deque_pop_front_n(deque, 1);
+}
+
+/* Removes the first `n` elements of the deque */
+deque_t* deque_pop_front_n(deque_t* deque, size_t n){
+	if(!deque || n > deque->size) return NULL;
+	if(n == 0) return deque;
+	deque->head = (deque->head + n) & (deque->capacity - 1);
+	deque->size -= n;
+	return deque;
+}
+
+/* Removes all elements on the deque */
+deque_t* deque_clear(deque_t* deque){
+	if(!deque) return NULL;
+	deque->head = 0;
+	deque->size = 0;
+	return deque;
+}
@@ -0,0 +1,143 @@
+#include "heap.h"
+
+/* Temporary storage for the element being moved through the heap */
+struct heap_temp {
+    char stack[HEAP_STACK_BYTES];
+    char* item;
+};
+
+/* Points the temporary storage to a buffer large enough for an element.
+ * Returns 0 if the buffer cannot be allocated.
+ */
+static int heap_temp_init(struct heap_temp* temp, size_t item_size){
+    temp->item = item_size <= HEAP_STACK_BYTES ? temp->stack : DATALIB_ALLOC(item_size);
+    return temp->item != NULL;
+}
+
+static void heap_temp_free(struct heap_temp* temp){
+    if(temp->item != temp->stack) DATALIB_FREE(temp->item);
+}
+
+/* Sifts down the element held in `item` from the hole at index `i` of `n` elements.
+ * Children are moved up into the hole until the element fits.
+ */
+static void heap_sift_down_from(char* base, size_t n, size_t item_size, size_t i,
+                                const char* item, size_t arity,
+                                int (*cmp)(const void*, const void*)){
+    for(;;){
+        if(i > (n - 1) / arity) break;
+        size_t first = i * arity + 1;
+        if(first >= n) break;
+        size_t last = first + arity < n ? first + arity : n;
+
+        /* Smallest child */
+        size_t c, best = first;
+        for(c = first + 1; c < last; ++c){
+            if(cmp(base + c * item_size, base + best * item_size) < 0) best = c;
+        }
+        if(cmp(base + best * item_size, item) >= 0) break;
+        memcpy(base + i * item_size, base + best * item_size, item_size);
+        i = best;
+    }
+    memcpy(base + i * item_size, item, item_size);
+}
+
+/* Moves the element at index `index` of a heap `vec` up to its place */
+void _heap_sift_up(void* vec, size_t item_size, size_t index, size_t arity,
+                   int (*cmp)(const void*, const void*)){
+    if(!vec || arity < 2 || index >= vec_size(vec)) return;
+    struct heap_temp temp;
+    if(!heap_temp_init(&temp, item_size)) return;
+
+    char* base = vec;
+    memcpy(temp.item, base + index * item_size, item_size);
+    while(index > 0){
+        size_t parent = (index - 1) / arity;
+        if(cmp(temp.item, base + parent * item_size) >= 0) break;
+        memcpy(base + index * item_size, base + parent * item_size, item_size);
+        index = parent;
+    }
+    memcpy(base + index * item_size, temp.item, item_size);
+    heap_temp_free(&temp);
+}
+
+/* Moves the element at index `index` of a heap `vec` down to its place */
+void _heap_sift_down(void* vec, size_t item_size, size_t index, size_t arity,
+                     int (*cmp)(const void*, const void*)){
+    size_t n = vec_size(vec);
+    if(!vec || arity < 2 || index >= n) return;
+    struct heap_temp temp;
+    if(!heap_temp_init(&temp, item_size)) return;
+
+    char* base = vec;
+    memcpy(temp.item, base + index * item_size, item_size);
+    heap_sift_down_from(base, n, item_size, index, temp.item, arity, cmp);
+    heap_temp_free(&temp);
+}
+
+/* Removes the smallest element of a heap `vec` by sifting the last element down from the top */
+void _heap_pop(void* vec, size_t item_size, size_t arity,
+               int (*cmp)(const void*, const void*)){
+    size_t n = vec_size(vec);
+    if(!vec || n == 0) return;
+    char* base = vec;
+    if(n > 1) memcpy(base, base + (n - 1) * item_size, item_size);
+    vec_pop(vec);
+    _heap_sift_down(vec, item_size, 0, arity, cmp);
+}
+
+/* Arranges the elements of a vector `vec` into a heap, sifting down every parent from the last */
+void _heap_heapify(void* vec, size_t item_size, size_t arity,
+                   int (*cmp)(const void*, const void*)){
+    size_t n = vec_size(vec);
+    if(!vec || arity < 2 || n < 2) return;
+    struct heap_temp temp;
+    if(!heap_temp_init(&temp, item_size)) return;
+
+    char* base = vec;
+    size_t i = (n - 2) / arity + 1;
+    while(i--){
+        memcpy(temp.item, base + i * item_size, item_size);
+        heap_sift_down_from(base, n, item_size, i, temp.item, arity, cmp);
+    }
+    heap_temp_free(&temp);
+}
+
+/* Offers an element to a heap `vec` that keeps the `k` greatest elements */
+void* _heap_topk_push(void* vec, size_t item_size, size_t k, const void* item, size_t arity,
+                      int (*cmp)(const void*, const void*)){
+    if(!vec || !item || k == 0) return NULL;
+    size_t n = vec_size(vec);
+
+    if(n < k){
+        vec = _vec_resize(vec, item_size, n + 1);
+        if(!vec) return NULL;
+        memcpy((char*)vec + n * item_size, item, item_size);
+        _heap_sift_up(vec, item_size, n, arity, cmp);
+        return vec;
+    }
+
+    /* Full: the element replaces the smallest kept one if it is greater */
+    if(cmp(item, vec) > 0){
+        heap_sift_down_from(vec, n, item_size, 0, item, arity, cmp);
+    }
+    return vec;
+}
+
+/* Sorts a heap `vec` in descending order by moving each top past the shrinking heap */
+void _heap_sort(void* vec, size_t item_size, size_t arity,
+                int (*cmp)(const void*, const void*)){
+    size_t n = vec_size(vec);
+    if(!vec || arity < 2 || n < 2) return;
+    struct heap_temp temp;
+    if(!heap_temp_init(&temp, item_size)) return;
+
+    char* base = vec;
+    while(n > 1){
+        n--;
+        memcpy(temp.item, base + n * item_size, item_size);
+        memcpy(base + n * item_size, base, item_size);
+        heap_sift_down_from(base, n, item_size, 0, temp.item, arity, cmp);
+    }
+    heap_temp_free(&temp);
+}
@@ -1,6 +1,9 @@
-#include "numv.h"
+#include "numv_internal.h"
+#include "numv_parallel.h"
+#include "sort.h"
 
 #include "stdio.h"
+#include "math.h"
 
 void numv_debug_print(double* nv){
     if(!nv){
@@ -30,8 +33,8 @@ double* numv_end(double* nv){
 /* Free a numv array */
 void numv_free(void* p){
     if(!p) return;
-    char* ptr = (char*)p - sizeof(size_t);
-    DATALIB_FREE(ptr);
+    char* ptr = (char*)p - NUMV_HEADER_SIZE;
+    DATALIB_ALIGNED_FREE(ptr);
 }
 
 /* Free an arbitrary number of numv arrays.
@@ -47,23 +50,102 @@ void numv_free_n(size_t n, ...){
     va_end(args);
 }
 
-/* Create a numeric vector of size `n` with uninitialised values */
-double* numv_empty(size_t n){
+void* numv_alloc(size_t n, size_t item_size){
     if(n == 0) return NULL;
-    struct numv* nv = DATALIB_ALLOC(sizeof(struct numv) + n * sizeof(double));
+    char* block = DATALIB_ALIGNED_ALLOC(NUMV_HEADER_SIZE + n * item_size);
+    if(!block) return NULL;
+    struct numv* nv = (struct numv*)(block + NUMV_HEADER_SIZE) - 1;
     nv->size = n;
-    if(nv) return nv->data;
-    return NULL;
+    return nv->data;
+}
+
+/* Create a numeric vector of size `n` with uninitialised values */
+double* numv_empty(size_t n){
+    return numv_alloc(n, sizeof(double));
+}
+
+/* Element-wise work on `n` items, split in ranges across threads on large arrays.
+ * Exactly one of the kernels or functions is set.
+ */
+struct numv_map {
+    double* dst;
+    const double* a;
+    const double* b;
+    double value;
+    numv_binary_kernel binary;
+    numv_scalar_kernel scalar;
+    numv_unary_kernel unary;
+    void (*fill)(double* out, double value, size_t n);
+    double (*fn)(double);
+    double (*fn_args)(double, void*);
+    void (*block)(const double* in, double* out, size_t n, void* args);
+    void* args;
+    int strided; /* Items are read and written with the strides below */
+    ptrdiff_t dst_stride;
+    ptrdiff_t a_stride;
+    ptrdiff_t b_stride;
+};
+
+/* Returns the `n` items of a strided buffer from `index`,
+ * either in place if they are contiguous, or copied into `buffer`.
+ */
+static const double* numv_gather(double* buffer, const double* data, ptrdiff_t stride, size_t index, size_t n){
+    const double* p = data + (ptrdiff_t)index * stride;
+    size_t i;
+    if(stride == 1) return p;
+    for(i = 0; i != n; ++i) buffer[i] = p[(ptrdiff_t)i * stride];
+    return buffer;
+}
+
+/* Kernels on strided items, gathered and scattered in blocks that stay in cache */
+static void numv_map_strided(const struct numv_map* m, size_t start, size_t n){
+    double x[NUMV_BLOCK], y[NUMV_BLOCK], out[NUMV_BLOCK];
+    size_t i, k;
+    for(i = 0; i < n; i += NUMV_BLOCK){
+        size_t index = start + i;
+        size_t len = n - i < NUMV_BLOCK ? n - i : NUMV_BLOCK;
+        double* dst = m->dst + (ptrdiff_t)index * m->dst_stride;
+        double* o = m->dst_stride == 1 ? dst : out;
+        const double* a = numv_gather(x, m->a, m->a_stride, index, len);
+        if(m->binary) m->binary(o, a, numv_gather(y, m->b, m->b_stride, index, len), len);
+        else if(m->scalar) m->scalar(o, a, m->value, len);
+        else m->unary(o, a, len);
+        if(o == out){
+            for(k = 0; k != len; ++k) dst[(ptrdiff_t)k * m->dst_stride] = out[k];
+        }
+    }
+}
+
+static void numv_map_range(size_t task, size_t start, size_t n, void* args){
+    const struct numv_map* m = args;
+    double* dst = m->dst + start;
+    const double* a = m->a + start;
+    size_t i;
+    (void)task;
+    if(m->strided) numv_map_strided(m, start, n);
+    else if(m->binary) m->binary(dst, a, m->b + start, n);
+    else if(m->scalar) m->scalar(dst, a, m->value, n);
+    else if(m->unary) m->unary(dst, a, n);
+    else if(m->fill) m->fill(dst, m->value, n);
+    else if(m->fn) for(i = 0; i != n; ++i) dst[i] = m->fn(a[i]);
+    else if(m->fn_args) for(i = 0; i != n; ++i) dst[i] = m->fn_args(a[i], m->args);
+    else{
+        for(i = 0; i < n; i += NUMV_APPLY_BLOCK){
+            m->block(a + i, dst + i, n - i < NUMV_APPLY_BLOCK ? n - i : NUMV_APPLY_BLOCK, m->args);
+        }
+    }
+}
+
+static void numv_map(const struct numv_map* m, size_t n){
+    numv_parallel_for(n, numv_parallel_tasks(n), numv_map_range, (void*)m);
 }
 
 /* Create a new numv array of size `n` initialised to a value `value` */
 double* numv_full(size_t n, double value){
     double* nv = numv_empty(n);
     if(!nv) return NULL;
-    double* item;
-    for(item = nv; item != numv_end(nv); ++item){
-        *item = value;
-    }
+    struct numv_map m = {.dst = nv, .a = nv, .value = value, .fill = numv_kernels()->fill};
+    numv_map(&m, n);
     return nv;
 }
 
@@ -87,12 +169,10 @@ double* numv_range(double start, double end, size_t n){
 
 /* Create a new numv array from a raw memory buffer */
 double* numv_from_array(size_t n, double* data){
+    if(!data) return NULL;
     double* nv = numv_empty(n);
     if(!nv) return NULL;
-    size_t i;
-    for(i = 0; i != n; ++i){
-        nv[i] = data[i];
-    }
+    memcpy(nv, data, n * sizeof(double));
     return nv;
 }
 
@@ -103,25 +183,54 @@ double* numv_copy(double* nv){
 
 /* Create a new numv array from a 'slice' of another.
  * e.g. the items between two indices [i,j] inclusive.
- * The indices may be negative to indicate index from the back of the array.
+ * The indices may be negative to indicate index from the back of the array,
+ * as for `numv_view_slice`.
  */
 double* numv_slice(double* nv, long i, long j){
+    return numv_materialize(numv_view_slice(numv_view(nv), i, j, 1));
+}
+
+
+/* View of all the items of a numv array, empty if it is NULL */
+numv_view_t numv_view(double* nv){
+    numv_view_t v = {nv, numv_size(nv), 1};
+    return v;
+}
+
+/* View of `n` items of any buffer starting at `data` */
+numv_view_t numv_view_of(double* data, size_t n, ptrdiff_t stride){
+    numv_view_t v = {data, data ? n : 0, stride};
+    if(v.size == 0) v.data = NULL;
+    return v;
+}
+
+/* View of the items from index `i` to index `j` inclusive, every `step` items */
+numv_view_t numv_view_slice(numv_view_t v, long i, long j, long step){
+    numv_view_t empty = {NULL, 0, 1};
+    long n = (long)v.size;
+    if (i < 0) i += n;
+    if (j < 0) j += n;
+    if(step == 0 || i < 0 || j < 0 || i >= n || j >= n) return empty;
+    if(step > 0 ? i > j : i < j) return empty;
+
+    numv_view_t slice;
+    slice.data = v.data + (ptrdiff_t)i * v.stride;
+    slice.size = (size_t)((j - i) / step) + 1;
+    slice.stride = v.stride * step;
+    return slice;
+}
+
+/* Copy the items of a view into a new numv array */
+double* numv_materialize(numv_view_t v){
+    double* nv = numv_empty(v.size);
     if(!nv) return NULL;
-    size_t sz = numv_size(nv);
-
-    /*
-     * Negative sign indicates backwards index from the last element    
-     *    Array      | a| b| c| d| e|
-     *    Pos. Index   0  1  2  3  4
-     *    Neg. Index  -5 -4 -3 -2 -1
-     */
-    if (i < 0) i += sz;
-    if (j < 0) j += sz;
-
-    if(i >= j || i < 0 || j >= sz){
-        return NULL;
+    if(v.stride == 1){
+        memcpy(nv, v.data, v.size * sizeof(double));
+        return nv;
     }
-    return numv_from_array(j - i + 1, nv + i);
+    size_t i;
+    for(i = 0; i != v.size; ++i) nv[i] = v.data[(ptrdiff_t)i * v.stride];
+    return nv;
 }
 
 
@@ -171,10 +280,8 @@ double* numv_concat_n(size_t n, ...){
 /* Apply a function `fn` that takes extra arguments to a numv array */
 double* numv_apply_args(double* nv, double (*fn)(double,void*), void* args){
     if(!nv || !fn) return NULL;
-    size_t i;
-    for(i = 0; i != numv_size(nv); ++i){
-        nv[i] = fn(nv[i], args);
-    }
+    struct numv_map m = {.dst = nv, .a = nv, .fn_args = fn, .args = args};
+    numv_map(&m, numv_size(nv));
     return nv;
 }
 
@@ -182,12 +289,1057 @@ double* numv_apply_args(double* nv, double (*fn)(double,void*), void* args){
 /* Apply a function `fn` to a numv array */
 double* numv_apply(double* nv, double (*fn)(double)){
     if(!nv || !fn) return NULL;
+    struct numv_map m = {.dst = nv, .a = nv, .fn = fn};
+    numv_map(&m, numv_size(nv));
+    return nv;
+}
+
+
+/* Apply a function `fn` to a numv array in blocks of at most `NUMV_APPLY_BLOCK` items */
+double* numv_apply_block(double* nv, void (*fn)(const double* in, double* out, size_t n, void* args), void* args){
+    return numv_apply_block_into(nv, nv, fn, args);
+}
+
+/* Same as `numv_apply_block`, writing the results into an array `dst` of the same size as `a` */
+double* numv_apply_block_into(double* dst, double* a,
+                              void (*fn)(const double* in, double* out, size_t n, void* args), void* args){
+    if(!dst || !a || !fn || numv_size(a) != numv_size(dst)) return NULL;
+    struct numv_map m = {.dst = dst, .a = a, .block = fn, .args = args};
+    numv_map(&m, numv_size(dst));
+    return dst;
+}
+
+/* Runs a unary kernel in place */
+static double* numv_unary_inplace(double* nv, numv_unary_kernel kernel){
+    if(!nv) return NULL;
+    struct numv_map m = {.dst = nv, .a = nv, .unary = kernel};
+    numv_map(&m, numv_size(nv));
+    return nv;
+}
+
+double* numv_sqrt(double* nv){
+    return numv_unary_inplace(nv, numv_kernels()->sqrt);
+}
+
+double* numv_cbrt(double* nv){
+    return numv_unary_inplace(nv, numv_kernels()->cbrt);
+}
+
+double* numv_exp(double* nv){
+    return numv_unary_inplace(nv, numv_kernels()->exp);
+}
+
+double* numv_log(double* nv){
+    return numv_unary_inplace(nv, numv_kernels()->log);
+}
+
+/* Replace the NaNs of a numv array with `value`, in place, and return it */
+double* numv_replace_nans(double* nv, double value){
+    if(!nv) return NULL;
+    struct numv_map m = {.dst = nv, .a = nv, .value = value, .scalar = numv_kernels()->replace_nans};
+    numv_map(&m, numv_size(nv));
+    return nv;
+}
+
+
+/* Writes the element-wise result of a kernel on two arrays of the same size into `dst` */
+static double* numv_binary_into(double* dst, double* a, double* b, numv_binary_kernel kernel){
+    if(!dst || !a || !b) return NULL;
+    size_t n = numv_size(dst);
+    if(numv_size(a) != n || numv_size(b) != n) return NULL;
+    struct numv_map m = {.dst = dst, .a = a, .b = b, .binary = kernel};
+    numv_map(&m, n);
+    return dst;
+}
+
+/* Writes the element-wise result of a kernel on an array and a scalar into `dst` */
+static double* numv_scalar_into(double* dst, double* a, double value, numv_scalar_kernel kernel){
+    if(!dst || !a || numv_size(a) != numv_size(dst)) return NULL;
+    struct numv_map m = {.dst = dst, .a = a, .value = value, .scalar = kernel};
+    numv_map(&m, numv_size(dst));
+    return dst;
+}
+
+/* Creates a new array from the element-wise result of a kernel on two arrays of the same size */
+static double* numv_binary(double* a, double* b, numv_binary_kernel kernel){
+    if(!a || !b || numv_size(a) != numv_size(b)) return NULL;
+    double* nv = numv_empty(numv_size(a));
+    if(!nv) return NULL;
+    return numv_binary_into(nv, a, b, kernel);
+}
+
+/* Creates a new array from the element-wise result of a kernel on an array and a scalar */
+static double* numv_scalar(double* a, double value, numv_scalar_kernel kernel){
+    if(!a) return NULL;
+    double* nv = numv_empty(numv_size(a));
+    if(!nv) return NULL;
+    return numv_scalar_into(nv, a, value, kernel);
+}
+
+double* numv_add(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->add);
+}
+
+double* numv_sub(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->sub);
+}
+
+double* numv_mult(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->mult);
+}
+
+double* numv_div(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->div);
+}
+
+double* numv_pow(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->pow);
+}
+
+double* numv_hypot(double* a, double* b){
+    return numv_binary(a, b, numv_kernels()->hypot);
+}
+
+double* numv_adds(double* a, double value){
+    return numv_scalar(a, value, numv_kernels()->adds);
+}
+
+double* numv_subs(double* a, double value){
+    return numv_scalar(a, value, numv_kernels()->subs);
+}
+
+double* numv_mults(double* a, double value){
+    return numv_scalar(a, value, numv_kernels()->mults);
+}
+
+double* numv_divs(double* a, double value){
+    return numv_scalar(a, value, numv_kernels()->divs);
+}
+
+double* numv_pows(double* a, double value){
+    return numv_scalar(a, value, numv_kernels()->pows);
+}
+
+double* numv_add_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->add);
+}
+
+double* numv_sub_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->sub);
+}
+
+double* numv_mult_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->mult);
+}
+
+double* numv_div_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->div);
+}
+
+double* numv_pow_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->pow);
+}
+
+double* numv_hypot_into(double* dst, double* a, double* b){
+    return numv_binary_into(dst, a, b, numv_kernels()->hypot);
+}
+
+double* numv_adds_into(double* dst, double* a, double value){
+    return numv_scalar_into(dst, a, value, numv_kernels()->adds);
+}
+
+double* numv_subs_into(double* dst, double* a, double value){
+    return numv_scalar_into(dst, a, value, numv_kernels()->subs);
+}
+
+double* numv_mults_into(double* dst, double* a, double value){
+    return numv_scalar_into(dst, a, value, numv_kernels()->mults);
+}
+
+double* numv_divs_into(double* dst, double* a, double value){
+    return numv_scalar_into(dst, a, value, numv_kernels()->divs);
+}
+
+double* numv_pows_into(double* dst, double* a, double value){
+    return numv_scalar_into(dst, a, value, numv_kernels()->pows);
+}
+
+double* numv_add_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->add);
+}
+
+double* numv_sub_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->sub);
+}
+
+double* numv_mult_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->mult);
+}
+
+double* numv_div_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->div);
+}
+
+double* numv_pow_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->pow);
+}
+
+double* numv_hypot_inplace(double* a, double* b){
+    return numv_binary_into(a, a, b, numv_kernels()->hypot);
+}
+
+double* numv_adds_inplace(double* a, double value){
+    return numv_scalar_into(a, a, value, numv_kernels()->adds);
+}
+
+double* numv_subs_inplace(double* a, double value){
+    return numv_scalar_into(a, a, value, numv_kernels()->subs);
+}
+
+double* numv_mults_inplace(double* a, double value){
+    return numv_scalar_into(a, a, value, numv_kernels()->mults);
+}
+
+double* numv_divs_inplace(double* a, double value){
+    return numv_scalar_into(a, a, value, numv_kernels()->divs);
+}
+
+double* numv_pows_inplace(double* a, double value){
+    return numv_scalar_into(a, a, value, numv_kernels()->pows);
+}
+
+
+/* Writes the element-wise result of a kernel on two views of the same size into `dst` */
+static double* numv_view_binary_into(numv_view_t dst, numv_view_t a, numv_view_t b, numv_binary_kernel kernel){
+    size_t n = dst.size;
+    if(n == 0 || a.size != n || b.size != n) return NULL;
+    struct numv_map m = {.dst = dst.data, .a = a.data, .b = b.data, .binary = kernel,
+                         .strided = dst.stride != 1 || a.stride != 1 || b.stride != 1,
+                         .dst_stride = dst.stride, .a_stride = a.stride, .b_stride = b.stride};
+    numv_map(&m, n);
+    return dst.data;
+}
+
+/* Writes the element-wise result of a kernel on a view and a scalar into `dst` */
+static double* numv_view_scalar_into(numv_view_t dst, numv_view_t a, double value, numv_scalar_kernel kernel){
+    size_t n = dst.size;
+    if(n == 0 || a.size != n) return NULL;
+    struct numv_map m = {.dst = dst.data, .a = a.data, .value = value, .scalar = kernel,
+                         .strided = dst.stride != 1 || a.stride != 1,
+                         .dst_stride = dst.stride, .a_stride = a.stride};
+    numv_map(&m, n);
+    return dst.data;
+}
+
+static double* numv_view_binary(numv_view_t a, numv_view_t b, numv_binary_kernel kernel){
+    if(a.size == 0 || a.size != b.size) return NULL;
+    double* nv = numv_empty(a.size);
+    if(!nv) return NULL;
+    return numv_view_binary_into(numv_view(nv), a, b, kernel);
+}
+
+static double* numv_view_scalar(numv_view_t a, double value, numv_scalar_kernel kernel){
+    if(a.size == 0) return NULL;
+    double* nv = numv_empty(a.size);
+    if(!nv) return NULL;
+    return numv_view_scalar_into(numv_view(nv), a, value, kernel);
+}
+
+double* numv_view_add(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->add);
+}
+
+double* numv_view_sub(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->sub);
+}
+
+double* numv_view_mult(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->mult);
+}
+
+double* numv_view_div(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->div);
+}
+
+double* numv_view_pow(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->pow);
+}
+
+double* numv_view_hypot(numv_view_t a, numv_view_t b){
+    return numv_view_binary(a, b, numv_kernels()->hypot);
+}
+
+double* numv_view_adds(numv_view_t a, double value){
+    return numv_view_scalar(a, value, numv_kernels()->adds);
+}
+
+double* numv_view_subs(numv_view_t a, double value){
+    return numv_view_scalar(a, value, numv_kernels()->subs);
+}
+
+double* numv_view_mults(numv_view_t a, double value){
+    return numv_view_scalar(a, value, numv_kernels()->mults);
+}
+
+double* numv_view_divs(numv_view_t a, double value){
+    return numv_view_scalar(a, value, numv_kernels()->divs);
+}
+
+double* numv_view_pows(numv_view_t a, double value){
+    return numv_view_scalar(a, value, numv_kernels()->pows);
+}
+
+double* numv_view_add_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->add);
+}
+
+double* numv_view_sub_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->sub);
+}
+
+double* numv_view_mult_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->mult);
+}
+
+double* numv_view_div_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->div);
+}
+
+double* numv_view_pow_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->pow);
+}
+
+double* numv_view_hypot_into(numv_view_t dst, numv_view_t a, numv_view_t b){
+    return numv_view_binary_into(dst, a, b, numv_kernels()->hypot);
+}
+
+double* numv_view_adds_into(numv_view_t dst, numv_view_t a, double value){
+    return numv_view_scalar_into(dst, a, value, numv_kernels()->adds);
+}
+
+double* numv_view_subs_into(numv_view_t dst, numv_view_t a, double value){
+    return numv_view_scalar_into(dst, a, value, numv_kernels()->subs);
+}
+
+double* numv_view_mults_into(numv_view_t dst, numv_view_t a, double value){
+    return numv_view_scalar_into(dst, a, value, numv_kernels()->mults);
+}
+
+double* numv_view_divs_into(numv_view_t dst, numv_view_t a, double value){
+    return numv_view_scalar_into(dst, a, value, numv_kernels()->divs);
+}
+
+double* numv_view_pows_into(numv_view_t dst, numv_view_t a, double value){
+    return numv_view_scalar_into(dst, a, value, numv_kernels()->pows);
+}
+
+
+/* Fold a numv array with a function `fn`, from the first item to the last */
+double numv_agg(double* nv, double (*fn)(double,double)){
+    if(!nv || !fn) return NAN;
+    double acc = nv[0];
+    size_t i;
+    for(i = 1; i != numv_size(nv); ++i){
+        acc = fn(acc, nv[i]);
+    }
+    return acc;
+}
+
+size_t numv_split(size_t n){
+    size_t n_blocks = (n + NUMV_BLOCK - 1) / NUMV_BLOCK;
+    return n_blocks / 2 * NUMV_BLOCK;
+}
+
+/* Reductions read `n` items spaced `stride` apart,
+ * gathering each block first if they are not contiguous.
+ */
+static double numv_sum_range(const double* a, ptrdiff_t stride, size_t n, const struct numv_kernels* kernels){
+    if(n <= NUMV_BLOCK){
+        double buffer[NUMV_BLOCK];
+        return kernels->sum(numv_gather(buffer, a, stride, 0, n), n);
+    }
+    size_t half = numv_split(n);
+    return numv_sum_range(a, stride, half, kernels)
+         + numv_sum_range(a + (ptrdiff_t)half * stride, stride, n - half, kernels);
+}
+
+/* Partial result of a reduction over a range:
+ * the sum, or the count, mean, sum of squared deviations from the mean `m2`, min and max.
+ */
+struct numv_moments {
+    double sum;
+    size_t count;
+    double mean;
+    double m2;
+    double min;
+    double max;
+};
+
+/* Merges the moments of two consecutive ranges */
+static struct numv_moments numv_moments_merge(struct numv_moments x, struct numv_moments y){
+    /* Chan et al. update of the mean and sum of squared deviations */
+    struct numv_moments r;
+    double delta = y.mean - x.mean;
+    r.sum = NAN;
+    r.count = x.count + y.count;
+    r.mean = x.mean + delta * ((double)y.count / (double)r.count);
+    r.m2 = x.m2 + y.m2 + delta * delta * ((double)x.count * (double)y.count / (double)r.count);
+    r.min = y.min < x.min ? y.min : x.min;
+    r.max = y.max > x.max ? y.max : x.max;
+    return r;
+}
+
+/* Statistics of a range, computed blockwise in cache.
+ * The min and max are only computed if `minmax` is set.
+ */
+static struct numv_moments numv_moments_range(const double* a, ptrdiff_t stride, size_t n,
+                                              const struct numv_kernels* kernels, int minmax){
+    if(n <= NUMV_BLOCK){
+        double buffer[NUMV_BLOCK];
+        struct numv_moments r;
+        a = numv_gather(buffer, a, stride, 0, n);
+        r.sum = NAN;
+        r.count = n;
+        if(minmax){
+            r.mean = kernels->sum_minmax(a, n, &r.min, &r.max) / (double)n;
+        }else{
+            r.mean = kernels->sum(a, n) / (double)n;
+            r.min = r.max = NAN;
+        }
+        r.m2 = kernels->sum_sqdev(a, n, r.mean);
+        return r;
+    }
+    size_t half = numv_split(n);
+    return numv_moments_merge(numv_moments_range(a, stride, half, kernels, minmax),
+                              numv_moments_range(a + (ptrdiff_t)half * stride, stride, n - half,
+                                                 kernels, minmax));
+}
+
+/* Min or max of a range, in blocks if the items are not contiguous */
+static double numv_minmax_range(const double* a, ptrdiff_t stride, size_t n,
+                                double (*kernel)(const double* a, size_t n), int max){
+    double buffer[NUMV_BLOCK];
+    double r = max ? -INFINITY : INFINITY;
+    size_t i;
+    if(stride == 1) return kernel(a, n);
+    for(i = 0; i < n; i += NUMV_BLOCK){
+        size_t len = n - i < NUMV_BLOCK ? n - i : NUMV_BLOCK;
+        double x = kernel(numv_gather(buffer, a, stride, i, len), len);
+        r = max ? (x > r ? x : r) : (x < r ? x : r);
+    }
+    return r;
+}
+
+/* Items reduced by one task.
+ * Reductions split ranges in halves down to this size whether they use threads or not,
+ * then each task reduces a range and the results are merged in the same order,
+ * so that the results do not depend on the number of threads.
+ */
+#define NUMV_GRAIN (64 * NUMV_BLOCK)
+
+enum numv_reduction {
+    NUMV_REDUCE_SUM,
+    NUMV_REDUCE_MOMENTS,
+    NUMV_REDUCE_DESCRIBE, /* Moments with the min and max */
+    NUMV_REDUCE_MIN,
+    NUMV_REDUCE_MAX
+};
+
+struct numv_reduce_job {
+    const double* data;
+    ptrdiff_t stride;
+    enum numv_reduction type;
+    const struct numv_kernels* kernels;
+    size_t* offsets; /* Start of each range reduced by a task, then the size of the array */
+    struct numv_moments* results; /* Result of each task */
+};
+
+static struct numv_moments numv_reduce_range(const struct numv_reduce_job* job, size_t start, size_t n){
+    const double* a = job->data + (ptrdiff_t)start * job->stride;
+    struct numv_moments r = {NAN, n, NAN, NAN, NAN, NAN};
+    switch(job->type){
+    case NUMV_REDUCE_SUM:
+        r.sum = numv_sum_range(a, job->stride, n, job->kernels);
+        break;
+    case NUMV_REDUCE_MOMENTS:
+    case NUMV_REDUCE_DESCRIBE:
+        r = numv_moments_range(a, job->stride, n, job->kernels, job->type == NUMV_REDUCE_DESCRIBE);
+        break;
+    case NUMV_REDUCE_MIN:
+        r.min = numv_minmax_range(a, job->stride, n, job->kernels->min, 0);
+        break;
+    case NUMV_REDUCE_MAX:
+        r.max = numv_minmax_range(a, job->stride, n, job->kernels->max, 1);
+        break;
+    }
+    return r;
+}
+
+static struct numv_moments numv_reduce_merge(const struct numv_reduce_job* job,
+                                             struct numv_moments x, struct numv_moments y){
+    switch(job->type){
+    case NUMV_REDUCE_SUM:
+        x.sum += y.sum;
+        break;
+    case NUMV_REDUCE_MOMENTS:
+    case NUMV_REDUCE_DESCRIBE:
+        return numv_moments_merge(x, y);
+    case NUMV_REDUCE_MIN:
+        x.min = y.min < x.min ? y.min : x.min;
+        break;
+    case NUMV_REDUCE_MAX:
+        x.max = y.max > x.max ? y.max : x.max;
+        break;
+    }
+    x.count += y.count;
+    return x;
+}
+
+/* Writes the start of the ranges reduced by tasks to `offsets`, if not NULL,
+ * and returns the number of ranges, plus `k`.
+ */
+static size_t numv_reduce_split(size_t start, size_t n, size_t* offsets, size_t k){
+    if(n <= NUMV_GRAIN){
+        if(offsets) offsets[k] = start;
+        return k + 1;
+    }
+    size_t half = numv_split(n);
+    k = numv_reduce_split(start, half, offsets, k);
+    return numv_reduce_split(start + half, n - half, offsets, k);
+}
+
+/* Merges the ranges in the order they were split, computing them unless the tasks did */
+static struct numv_moments numv_reduce_tree(const struct numv_reduce_job* job, size_t start, size_t n,
+                                            size_t* range){
+    if(n <= NUMV_GRAIN){
+        return job->results ? job->results[(*range)++] : numv_reduce_range(job, start, n);
+    }
+    size_t half = numv_split(n);
+    struct numv_moments x = numv_reduce_tree(job, start, half, range);
+    struct numv_moments y = numv_reduce_tree(job, start + half, n - half, range);
+    return numv_reduce_merge(job, x, y);
+}
+
+static void numv_reduce_task(size_t task, void* args){
+    struct numv_reduce_job* job = args;
+    size_t start = job->offsets[task];
+    job->results[task] = numv_reduce_range(job, start, job->offsets[task + 1] - start);
+}
+
+static struct numv_moments numv_reduce(numv_view_t v, enum numv_reduction type){
+    size_t n = v.size;
+    struct numv_reduce_job job = {v.data, v.stride, type, numv_kernels(), NULL, NULL};
+    threadpool_t* pool = numv_parallel_pool(n);
+    if(pool && n > NUMV_GRAIN){
+        /* Without memory for the results, the tasks run on this thread */
+        size_t n_ranges = numv_reduce_split(0, n, NULL, 0);
+        job.offsets = DATALIB_ALLOC((n_ranges + 1) * sizeof(size_t));
+        job.results = DATALIB_ALLOC(n_ranges * sizeof(struct numv_moments));
+        if(job.offsets && job.results){
+            numv_reduce_split(0, n, job.offsets, 0);
+            job.offsets[n_ranges] = n;
+            threadpool_run(pool, n_ranges, numv_reduce_task, &job);
+        }else{
+            DATALIB_FREE(job.results);
+            job.results = NULL;
+        }
+    }
+    size_t range = 0;
+    struct numv_moments r = numv_reduce_tree(&job, 0, n, &range);
+    DATALIB_FREE(job.offsets);
+    DATALIB_FREE(job.results);
+    return r;
+}
+
+double numv_view_sum(numv_view_t v){
+    if(v.size == 0) return 0;
+    return numv_reduce(v, NUMV_REDUCE_SUM).sum;
+}
+
+double numv_view_mean(numv_view_t v){
+    if(v.size == 0) return NAN;
+    return numv_view_sum(v) / (double)v.size;
+}
+
+double numv_view_std(numv_view_t v){
+    if(v.size == 0) return NAN;
+    struct numv_moments r = numv_reduce(v, NUMV_REDUCE_MOMENTS);
+    return sqrt(r.m2 / (double)r.count);
+}
+
+/* Index of the first item of a view equal to `value`, or its size if there is none */
+static size_t numv_view_find(numv_view_t v, double value){
     size_t i;
-    for(i = 0; i != numv_size(nv); ++i){
-        nv[i] = fn(nv[i]);
+    if(v.stride == 1) return numv_kernels()->find(v.data, v.size, value);
+    for(i = 0; i != v.size; ++i){
+        if(v.data[(ptrdiff_t)i * v.stride] == value) return i;
     }
+    return v.size;
+}
+
+static double numv_nan_if_missing(numv_view_t v, double value){
+    return NUMV_NAN_IF_MISSING(value, numv_view_find(v, value) != v.size);
+}
+
+struct numv_stats numv_view_describe(numv_view_t v){
+    struct numv_stats stats = {0, NAN, NAN, NAN, NAN};
+    if(v.size == 0) return stats;
+    struct numv_moments r = numv_reduce(v, NUMV_REDUCE_DESCRIBE);
+    stats.count = r.count;
+    stats.min = numv_nan_if_missing(v, r.min);
+    stats.max = numv_nan_if_missing(v, r.max);
+    stats.mean = r.mean;
+    stats.std = sqrt(r.m2 / (double)r.count);
+    return stats;
+}
+
+double numv_view_min(numv_view_t v){
+    if(v.size == 0) return NAN;
+    return numv_nan_if_missing(v, numv_reduce(v, NUMV_REDUCE_MIN).min);
+}
+
+double numv_view_max(numv_view_t v){
+    if(v.size == 0) return NAN;
+    return numv_nan_if_missing(v, numv_reduce(v, NUMV_REDUCE_MAX).max);
+}
+
+size_t numv_view_imin(numv_view_t v){
+    double value = numv_view_min(v);
+    if(isnan(value)) return v.size;
+    return numv_view_find(v, value);
+}
+
+size_t numv_view_imax(numv_view_t v){
+    double value = numv_view_max(v);
+    if(isnan(value)) return v.size;
+    return numv_view_find(v, value);
+}
+
+double numv_sum(double* nv){
+    return numv_view_sum(numv_view(nv));
+}
+
+double numv_mean(double* nv){
+    return numv_view_mean(numv_view(nv));
+}
+
+double numv_std(double* nv){
+    return numv_view_std(numv_view(nv));
+}
+
+struct numv_stats numv_describe(double* nv){
+    return numv_view_describe(numv_view(nv));
+}
+
+double numv_min(double* nv){
+    return numv_view_min(numv_view(nv));
+}
+
+double numv_max(double* nv){
+    return numv_view_max(numv_view(nv));
+}
+
+size_t numv_imin(double* nv){
+    return numv_view_imin(numv_view(nv));
+}
+
+size_t numv_imax(double* nv){
+    return numv_view_imax(numv_view(nv));
+}
+
+
+/* --- Order statistics --- */
+
+#define NUMV_LESS(a, b) ((a) < (b))
+SORT_DEFINE(numv_sort_items, double, NUMV_LESS)
+SORT_DEFINE(numv_sort_ranks, size_t, NUMV_LESS)
+
+static int numv_has_nan(const double* a, size_t n){
+    size_t i;
+    int nan = 0;
+    for(i = 0; i != n; ++i) nan |= a[i] != a[i];
+    return nan;
+}
+
+/* Number of the sorted ranks below `rank` */
+static size_t numv_ranks_below(const size_t* ranks, size_t k, size_t rank){
+    size_t count = 0;
+    while(count != k && ranks[count] < rank) count++;
+    return count;
+}
+
+/* Moves the items of `a` at the sorted `ranks` (counted from `offset`) to where they
+ * would be if the items were sorted, with smaller items before them and larger ones after.
+ * Ranges are partitioned around the median of three items like in `SORT_DEFINE`,
+ * and those left with `depth` exhausted are sorted.
+ */
+static void numv_select(double* a, size_t n, const size_t* ranks, size_t k, size_t offset, unsigned depth){
+    while(k > 0){
+        if(n <= SORT_INSERTION_THRESHOLD){
+            numv_sort_items_insertion(a, n);
+            return;
+        }
+        if(depth-- == 0){
+            numv_sort_items(a, n);
+            return;
+        }
+        size_t mid = n / 2;
+        numv_sort_items_sort3(a, a + mid, a + n - 1);
+        double x = a[mid]; a[mid] = a[0]; a[0] = x;
+
+        /* Items equal to the pivot go to the right, unless none is smaller than it,
+           in which case they are gathered on the left and are all in place */
+        int disorder;
+        size_t first = numv_sort_items_partition(a, n, 0, &disorder);
+        size_t last = first;
+        if(first == 0) last = numv_sort_items_partition(a, n, 1, &disorder);
+
+        size_t left = numv_ranks_below(ranks, k, offset + first);
+        size_t done = numv_ranks_below(ranks, k, offset + last + 1);
+        if(done == k){
+            n = first;
+            k = left;
+            continue;
+        }
+        if(left > 0) numv_select(a, first, ranks, left, offset, depth);
+        a += last + 1;
+        n -= last + 1;
+        offset += last + 1;
+        ranks += done;
+        k -= done;
+    }
+}
+
+/* Computes the quantiles of `n` items into `out`, reordering the items */
+static int numv_quantiles_of(double* a, size_t n, const double* probs, size_t k, double* out){
+    size_t i, j, m = 0;
+    for(i = 0; i != k; ++i){
+        if(!(probs[i] >= 0 && probs[i] <= 1)) return 0;
+    }
+    if(numv_has_nan(a, n)){
+        for(i = 0; i != k; ++i) out[i] = NAN;
+        return 1;
+    }
+
+    /* Each quantile needs the items at the two ranks around it */
+    size_t* ranks = DATALIB_ALLOC(2 * k * sizeof(size_t));
+    if(!ranks) return 0;
+    for(i = 0; i != k; ++i){
+        size_t lo = (size_t)(probs[i] * (double)(n - 1));
+        ranks[m++] = lo;
+        if(lo + 1 < n) ranks[m++] = lo + 1;
+    }
+    numv_sort_ranks(ranks, m);
+    for(i = j = 0; i != m; ++i){
+        if(j == 0 || ranks[i] != ranks[j - 1]) ranks[j++] = ranks[i];
+    }
+    unsigned depth = 0;
+    for(i = n; i > 1; i >>= 1) depth += 2;
+    numv_select(a, n, ranks, j, 0, depth);
+    DATALIB_FREE(ranks);
+
+    for(i = 0; i != k; ++i){
+        double h = probs[i] * (double)(n - 1);
+        size_t lo = (size_t)h;
+        double frac = h - (double)lo;
+        if(frac == 0 || lo + 1 == n || a[lo] == a[lo + 1]) out[i] = a[lo];
+        else out[i] = a[lo] + frac * (a[lo + 1] - a[lo]);
+    }
+    return 1;
+}
+
+double* numv_quantiles_inplace(double* nv, const double* probs, size_t k){
+    if(!nv || !probs) return NULL;
+    double* out = numv_empty(k);
+    if(!out) return NULL;
+    if(!numv_quantiles_of(nv, numv_size(nv), probs, k, out)){
+        numv_free(out);
+        return NULL;
+    }
+    return out;
+}
+
+double* numv_quantiles(double* nv, const double* probs, size_t k){
+    double* copy = numv_copy(nv);
+    if(!copy) return NULL;
+    double* out = numv_quantiles_inplace(copy, probs, k);
+    numv_free(copy);
+    return out;
+}
+
+double numv_median_inplace(double* nv){
+    double half = 0.5, median;
+    if(!nv || !numv_quantiles_of(nv, numv_size(nv), &half, 1, &median)) return NAN;
+    return median;
+}
+
+double numv_median(double* nv){
+    double* copy = numv_copy(nv);
+    if(!copy) return NAN;
+    double median = numv_median_inplace(copy);
+    numv_free(copy);
+    return median;
+}
+
+/* Mode counting: open addressing on the bit patterns of the items,
+   where a NaN pattern marks an empty slot since NaNs are never counted */
+#define NUMV_MODE_EMPTY UINT64_MAX
+
+struct numv_mode_slot {
+    uint64_t key;
+    size_t count;
+};
+
+static size_t numv_mode_hash(uint64_t key, unsigned bits){
+    return (size_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bits));
+}
+
+/* Doubles the table, returning 0 if memory cannot be allocated */
+static int numv_mode_grow(struct numv_mode_slot** table, unsigned* bits){
+    size_t i, size = (size_t)1 << *bits;
+    struct numv_mode_slot* old = *table;
+    struct numv_mode_slot* slots = DATALIB_ALLOC(2 * size * sizeof(struct numv_mode_slot));
+    if(!slots) return 0;
+    for(i = 0; i != 2 * size; ++i) slots[i].key = NUMV_MODE_EMPTY;
+    for(i = 0; old && i != size; ++i){
+        if(old[i].key == NUMV_MODE_EMPTY) continue;
+        size_t h = numv_mode_hash(old[i].key, *bits + 1);
+        while(slots[h].key != NUMV_MODE_EMPTY) h = (h + 1) & (2 * size - 1);
+        slots[h] = old[i];
+    }
+    DATALIB_FREE(old);
+    *table = slots;
+    *bits += 1;
+    return 1;
+}
+
+double numv_mode(double* nv){
+    size_t i, n = numv_size(nv), used = 0;
+    unsigned bits = 9;
+    struct numv_mode_slot* table = NULL;
+    if(n == 0 || numv_has_nan(nv, n) || !numv_mode_grow(&table, &bits)) return NAN;
+
+    for(i = 0; i != n; ++i){
+        double x = nv[i] == 0 ? 0.0 : nv[i];
+        uint64_t key;
+        memcpy(&key, &x, sizeof(key));
+        size_t mask = ((size_t)1 << bits) - 1;
+        size_t h = numv_mode_hash(key, bits);
+        while(table[h].key != key && table[h].key != NUMV_MODE_EMPTY) h = (h + 1) & mask;
+        if(table[h].key == key){
+            table[h].count++;
+            continue;
+        }
+        table[h].key = key;
+        table[h].count = 1;
+        /* Keeps the table at most half full */
+        if(++used > mask / 2 && !numv_mode_grow(&table, &bits)){
+            DATALIB_FREE(table);
+            return NAN;
+        }
+    }
+
+    double mode = NAN;
+    size_t best = 0;
+    for(i = 0; i != (size_t)1 << bits; ++i){
+        if(table[i].key == NUMV_MODE_EMPTY) continue;
+        double x;
+        memcpy(&x, &table[i].key, sizeof(x));
+        if(table[i].count > best || (table[i].count == best && x < mode)){
+            mode = x;
+            best = table[i].count;
+        }
+    }
+    DATALIB_FREE(table);
+    return mode;
+}
+
+
+/* --- Sorting --- */
+
+/* Index sorted along with its item, ties broken by index to keep the sort stable */
+struct numv_sort_pair {
+    double value;
+    size_t index;
+};
+
+/* Same order as the radix sort keys: -0 comes before 0 */
+#define NUMV_SORT_LESS(a, b) ((a) < (b) || ((a) == (b) && signbit(a) && !signbit(b)))
+SORT_DEFINE(numv_sort_values, double, NUMV_SORT_LESS)
+
+#define NUMV_PAIR_LESS(a, b) ((a).value < (b).value || ((a).value == (b).value && (a).index < (b).index))
+SORT_DEFINE(numv_sort_pairs, struct numv_sort_pair, NUMV_PAIR_LESS)
+
+/* Radix sort keys: the bits of positive values with the sign bit set,
+   and all the bits of negative values flipped, which order as unsigned integers like the values */
+#define NUMV_SORT_SIGN (UINT64_C(1) << 63)
+
+static uint64_t numv_sort_key(double x){
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u ^ ((0 - (u >> 63)) | NUMV_SORT_SIGN);
+}
+
+static double numv_sort_value(uint64_t key){
+    uint64_t u = key ^ (((key >> 63) - 1) | NUMV_SORT_SIGN);
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+/* The keys are sorted 11 bits at a time, in 6 passes, with counts that fit in the L2 cache */
+#define NUMV_SORT_BITS 11
+#define NUMV_SORT_RADIX (1 << NUMV_SORT_BITS)
+#define NUMV_SORT_DIGITS ((64 + NUMV_SORT_BITS - 1) / NUMV_SORT_BITS)
+
+/* Counts of each value of each digit of the keys */
+struct numv_sort_counts {
+    size_t digits[NUMV_SORT_DIGITS][NUMV_SORT_RADIX];
+};
+
+static void numv_sort_count(struct numv_sort_counts* counts, uint64_t key){
+    unsigned d;
+    for(d = 0; d != NUMV_SORT_DIGITS; ++d) counts->digits[d][(key >> (NUMV_SORT_BITS * d)) & (NUMV_SORT_RADIX - 1)]++;
+}
+
+/* Turns the counts of a digit into the offset of the first key with each value.
+ * Returns 0 if all the `n` keys have the same value, so that the pass can be skipped.
+ */
+static int numv_sort_offsets(size_t* counts, size_t n){
+    size_t b, sum = 0;
+    for(b = 0; b != NUMV_SORT_RADIX; ++b){
+        size_t count = counts[b];
+        if(count == n) return 0;
+        counts[b] = sum;
+        sum += count;
+    }
+    return 1;
+}
+
+static void numv_sort_scatter(const uint64_t* src, uint64_t* dst, size_t n, size_t* offsets, unsigned shift){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        uint64_t key = src[i];
+        dst[offsets[(key >> shift) & (NUMV_SORT_RADIX - 1)]++] = key;
+    }
+}
+
+static void numv_argsort_scatter(const uint64_t* src, uint64_t* dst, const size_t* isrc, size_t* idst,
+                                 size_t n, size_t* offsets, unsigned shift){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        uint64_t key = src[i];
+        size_t j = offsets[(key >> shift) & (NUMV_SORT_RADIX - 1)]++;
+        dst[j] = key;
+        idst[j] = isrc[i];
+    }
+}
+
+double* numv_sort(double* nv){
+    size_t i, n = numv_size(nv), m = 0, nans = 0;
+    if(!nv) return NULL;
+    uint64_t* keys = NULL;
+    if(n >= NUMV_SORT_RADIX_THRESHOLD) keys = DATALIB_ALIGNED_ALLOC(n * sizeof(uint64_t) + sizeof(struct numv_sort_counts));
+    if(!keys){
+        for(i = 0; i != n; ++i){
+            double x = nv[i];
+            if(x != x) continue;
+            nv[i] = nv[m];
+            nv[m++] = x;
+        }
+        numv_sort_values(nv, m);
+        return nv;
+    }
+
+    /* The keys are made and counted in one pass, while the NaNs are packed
+       at the front of the array and then moved to its end */
+    struct numv_sort_counts* counts = (struct numv_sort_counts*)(keys + n);
+    memset(counts, 0, sizeof(*counts));
+    for(i = 0; i != n; ++i){
+        double x = nv[i];
+        if(x != x){
+            nv[nans++] = x;
+            continue;
+        }
+        uint64_t key = numv_sort_key(x);
+        keys[m++] = key;
+        numv_sort_count(counts, key);
+    }
+    memmove(nv + m, nv, nans * sizeof(double));
+
+    /* The passes go back and forth between the keys and the front of the array */
+    uint64_t* src = keys;
+    uint64_t* dst = (uint64_t*)(void*)nv;
+    unsigned d;
+    for(d = 0; d != NUMV_SORT_DIGITS; ++d){
+        if(!numv_sort_offsets(counts->digits[d], m)) continue;
+        numv_sort_scatter(src, dst, m, counts->digits[d], NUMV_SORT_BITS * d);
+        uint64_t* t = src; src = dst; dst = t;
+    }
+    for(i = 0; i != m; ++i) nv[i] = numv_sort_value(src[i]);
+    DATALIB_ALIGNED_FREE(keys);
     return nv;
 }
 
+size_t* numv_argsort(double* nv){
+    size_t i, n = numv_size(nv), m = 0;
+    size_t* out = numv_alloc(n, sizeof(size_t));
+    if(!out) return NULL;
+
+    if(n < NUMV_SORT_RADIX_THRESHOLD){
+        struct numv_sort_pair* pairs = DATALIB_ALLOC(n * sizeof(struct numv_sort_pair));
+        if(!pairs){
+            numv_free(out);
+            return NULL;
+        }
+        for(i = 0; i != n; ++i){
+            if(nv[i] != nv[i]) continue;
+            pairs[m].value = nv[i];
+            pairs[m++].index = i;
+        }
+        numv_sort_pairs(pairs, m);
+        for(i = 0; i != m; ++i) out[i] = pairs[i].index;
+        DATALIB_FREE(pairs);
+    } else {
+        /* One block holds the counts, two buffers of keys and a buffer of indices.
+           The offsets are in bytes, so that they do not depend on the size of size_t */
+        size_t keys_offset = DATALIB_ALIGN_UP(sizeof(struct numv_sort_counts));
+        size_t indices_offset = keys_offset + 2 * n * sizeof(uint64_t);
+        char* block = DATALIB_ALIGNED_ALLOC(indices_offset + n * sizeof(size_t));
+        if(!block){
+            numv_free(out);
+            return NULL;
+        }
+        struct numv_sort_counts* counts = (struct numv_sort_counts*)(void*)block;
+        uint64_t* keys = (uint64_t*)(void*)(block + keys_offset);
+        memset(counts, 0, sizeof(*counts));
+        for(i = 0; i != n; ++i){
+            double x = nv[i];
+            if(x != x) continue;
+            /* -0 gets the key of 0 so that they keep their order */
+            uint64_t key = numv_sort_key(x == 0 ? 0.0 : x);
+            keys[m] = key;
+            out[m++] = i;
+            numv_sort_count(counts, key);
+        }
 
+        uint64_t* src = keys;
+        uint64_t* dst = keys + n;
+        size_t* isrc = out;
+        size_t* idst = (size_t*)(void*)(block + indices_offset);
+        unsigned d;
+        for(d = 0; d != NUMV_SORT_DIGITS; ++d){
+            if(!numv_sort_offsets(counts->digits[d], m)) continue;
+            numv_argsort_scatter(src, dst, isrc, idst, m, counts->digits[d], NUMV_SORT_BITS * d);
+            uint64_t* t = src; src = dst; dst = t;
+            size_t* it = isrc; isrc = idst; idst = it;
+        }
+        if(isrc != out) memcpy(out, isrc, m * sizeof(size_t));
+        DATALIB_ALIGNED_FREE(block);
+    }
 
+    for(i = 0; m != n; ++i){
+        if(nv[i] != nv[i]) out[m++] = i;
+    }
+    return out;
+}
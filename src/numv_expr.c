@@ -0,0 +1,321 @@
+#include "numv_expr.h"
+#include "numv_kernels.h"
+#include "numv_parallel.h"
+
+enum numv_expr_type {
+    NUMV_EXPR_ARRAY,
+    NUMV_EXPR_SCALAR,
+    NUMV_EXPR_UNARY,
+    NUMV_EXPR_BINARY
+};
+
+struct numv_expr {
+    enum numv_expr_type type;
+    numv_unary_kernel unary;
+    numv_binary_kernel binary;
+    int swap; /* Binary kernel called with the operands in reverse order */
+    numv_expr_t* left;
+    numv_expr_t* right;
+    double* array;
+    double value;
+};
+
+/* Free an expression and all its operands. The arrays it refers to are not freed. */
+void numv_expr_free(numv_expr_t* e){
+    if(!e) return;
+    numv_expr_free(e->left);
+    numv_expr_free(e->right);
+    DATALIB_FREE(e);
+}
+
+/* Allocates a node, taking ownership of its operands.
+ * Frees the operands if one of them is NULL or the node cannot be allocated.
+ */
+static numv_expr_t* numv_expr_node(enum numv_expr_type type, numv_expr_t* left, numv_expr_t* right){
+    int missing = (type == NUMV_EXPR_UNARY && !left) || (type == NUMV_EXPR_BINARY && (!left || !right));
+    numv_expr_t* e = missing ? NULL : DATALIB_ALLOC(sizeof(numv_expr_t));
+    if(!e){
+        numv_expr_free(left);
+        numv_expr_free(right);
+        return NULL;
+    }
+    e->type = type;
+    e->unary = NULL;
+    e->binary = NULL;
+    e->swap = 0;
+    e->left = left;
+    e->right = right;
+    e->array = NULL;
+    e->value = 0;
+    return e;
+}
+
+static numv_expr_t* numv_expr_binary(numv_expr_t* a, numv_expr_t* b, numv_binary_kernel kernel, int swap){
+    numv_expr_t* e = numv_expr_node(NUMV_EXPR_BINARY, a, b);
+    if(!e) return NULL;
+    e->binary = kernel;
+    e->swap = swap;
+    return e;
+}
+
+
+/* --- Leaves --- */
+
+numv_expr_t* numv_expr_array(double* nv){
+    if(!nv) return NULL;
+    numv_expr_t* e = numv_expr_node(NUMV_EXPR_ARRAY, NULL, NULL);
+    if(!e) return NULL;
+    e->array = nv;
+    return e;
+}
+
+numv_expr_t* numv_expr_scalar(double value){
+    numv_expr_t* e = numv_expr_node(NUMV_EXPR_SCALAR, NULL, NULL);
+    if(!e) return NULL;
+    e->value = value;
+    return e;
+}
+
+
+/* --- Operations --- */
+
+numv_expr_t* numv_expr_add(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->add, 0);
+}
+
+numv_expr_t* numv_expr_sub(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->sub, 0);
+}
+
+numv_expr_t* numv_expr_mult(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->mult, 0);
+}
+
+numv_expr_t* numv_expr_div(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->div, 0);
+}
+
+numv_expr_t* numv_expr_pow(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->pow, 0);
+}
+
+numv_expr_t* numv_expr_hypot(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->hypot, 0);
+}
+
+numv_expr_t* numv_expr_sqrt(numv_expr_t* a){
+    numv_expr_t* e = numv_expr_node(NUMV_EXPR_UNARY, a, NULL);
+    if(!e) return NULL;
+    e->unary = numv_kernels()->sqrt;
+    return e;
+}
+
+numv_expr_t* numv_expr_adds(numv_expr_t* a, double value){
+    return numv_expr_add(a, numv_expr_scalar(value));
+}
+
+numv_expr_t* numv_expr_subs(numv_expr_t* a, double value){
+    return numv_expr_sub(a, numv_expr_scalar(value));
+}
+
+numv_expr_t* numv_expr_mults(numv_expr_t* a, double value){
+    return numv_expr_mult(a, numv_expr_scalar(value));
+}
+
+numv_expr_t* numv_expr_divs(numv_expr_t* a, double value){
+    return numv_expr_div(a, numv_expr_scalar(value));
+}
+
+numv_expr_t* numv_expr_pows(numv_expr_t* a, double value){
+    return numv_expr_pow(a, numv_expr_scalar(value));
+}
+
+numv_expr_t* numv_expr_lt(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->lt, 0);
+}
+
+numv_expr_t* numv_expr_le(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->le, 0);
+}
+
+/* a > b is computed as b < a */
+numv_expr_t* numv_expr_gt(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->lt, 1);
+}
+
+numv_expr_t* numv_expr_ge(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->le, 1);
+}
+
+numv_expr_t* numv_expr_eq(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->eq, 0);
+}
+
+numv_expr_t* numv_expr_ne(numv_expr_t* a, numv_expr_t* b){
+    return numv_expr_binary(a, b, numv_kernels()->ne, 0);
+}
+
+
+/* --- Evaluation --- */
+
+/* Size of the arrays of an expression, 0 if it has no array or SIZE_MAX if their sizes differ */
+static size_t numv_expr_size_of(const numv_expr_t* e){
+    if(e->type == NUMV_EXPR_ARRAY) return numv_size(e->array);
+    if(e->type == NUMV_EXPR_SCALAR) return 0;
+    size_t left = numv_expr_size_of(e->left);
+    size_t right = e->right ? numv_expr_size_of(e->right) : 0;
+    if(left == 0) return right;
+    if(right == 0 || right == left) return left;
+    return SIZE_MAX;
+}
+
+size_t numv_expr_size(numv_expr_t* e){
+    if(!e) return 0;
+    size_t n = numv_expr_size_of(e);
+    return n == SIZE_MAX ? 0 : n;
+}
+
+/* The expression is flattened into steps in postfix order, run on a stack of tiles.
+ * Operations write into the tile of the stack slot of their first operand,
+ * and scalars are expanded once into a tile of their own.
+ * Each task of a parallel evaluation has its own stack of tiles.
+ */
+struct numv_expr_step {
+    const numv_expr_t* node;
+    size_t tile; /* Stack slot written by an operation, or tile of an expanded scalar */
+};
+
+struct numv_expr_program {
+    struct numv_expr_step* steps;
+    size_t n_steps;
+    size_t depth; /* Number of slots on the stack after the last step */
+    size_t max_depth;
+    size_t n_scalars;
+    double* scalars; /* One tile per scalar */
+    double* stacks; /* `max_depth` tiles per task */
+    const double** pointers; /* `max_depth` items per task pointing to the stack operands */
+    double* dst;
+};
+
+/* Appends the steps of an expression to a program.
+ * If `steps` is NULL, only counts the steps, stack slots and scalars.
+ */
+static void numv_expr_compile(const numv_expr_t* e, struct numv_expr_program* p){
+    if(e->left) numv_expr_compile(e->left, p);
+    if(e->right) numv_expr_compile(e->right, p);
+
+    size_t tile = 0;
+    switch(e->type){
+    case NUMV_EXPR_ARRAY:
+        p->depth++;
+        break;
+    case NUMV_EXPR_SCALAR:
+        tile = p->n_scalars++;
+        p->depth++;
+        break;
+    case NUMV_EXPR_UNARY:
+        tile = p->depth - 1;
+        break;
+    case NUMV_EXPR_BINARY:
+        tile = p->depth - 2;
+        p->depth--;
+        break;
+    }
+    if(p->depth > p->max_depth) p->max_depth = p->depth;
+    if(p->steps){
+        p->steps[p->n_steps].node = e;
+        p->steps[p->n_steps].tile = tile;
+    }
+    p->n_steps++;
+}
+
+/* Runs a program on the items [start, start + n) with the stack of a task */
+static void numv_expr_run(const struct numv_expr_program* p, size_t task, size_t start, size_t n){
+    double* tiles = p->stacks + task * p->max_depth * NUMV_EXPR_TILE;
+    const double** stack = p->pointers + task * p->max_depth;
+    double* dst = p->dst + start;
+    size_t s, sp = 0;
+    for(s = 0; s != p->n_steps; ++s){
+        const numv_expr_t* e = p->steps[s].node;
+        /* The last operation writes straight to the destination */
+        double* out = s + 1 == p->n_steps ? dst : tiles + p->steps[s].tile * NUMV_EXPR_TILE;
+        switch(e->type){
+        case NUMV_EXPR_ARRAY:
+            stack[sp++] = e->array + start;
+            break;
+        case NUMV_EXPR_SCALAR:
+            stack[sp++] = p->scalars + p->steps[s].tile * NUMV_EXPR_TILE;
+            break;
+        case NUMV_EXPR_UNARY:
+            e->unary(out, stack[sp - 1], n);
+            stack[sp - 1] = out;
+            break;
+        case NUMV_EXPR_BINARY:
+            if(e->swap) e->binary(out, stack[sp - 1], stack[sp - 2], n);
+            else e->binary(out, stack[sp - 2], stack[sp - 1], n);
+            stack[--sp - 1] = out;
+            break;
+        }
+    }
+    /* An expression that is a single leaf is copied */
+    if(stack[0] != dst) memmove(dst, stack[0], n * sizeof(double));
+}
+
+/* Evaluates the tiles of a range of items */
+static void numv_expr_task(size_t task, size_t start, size_t count, void* args){
+    const struct numv_expr_program* p = args;
+    size_t i;
+    for(i = 0; i < count; i += NUMV_EXPR_TILE){
+        size_t len = count - i < NUMV_EXPR_TILE ? count - i : NUMV_EXPR_TILE;
+        numv_expr_run(p, task, start + i, len);
+    }
+}
+
+double* numv_expr_eval_into(double* dst, numv_expr_t* e){
+    if(!dst || !e) return NULL;
+    size_t n = numv_size(dst);
+    size_t size = numv_expr_size_of(e);
+    if(size == SIZE_MAX || (size != 0 && size != n)) return NULL;
+
+    struct numv_expr_program p = {NULL, 0, 0, 0, 0, NULL, NULL, NULL, dst};
+    numv_expr_compile(e, &p);
+    size_t n_tasks = numv_parallel_tasks(n);
+    p.steps = DATALIB_ALLOC(p.n_steps * sizeof(struct numv_expr_step)
+                            + n_tasks * p.max_depth * sizeof(double*));
+    p.scalars = DATALIB_ALIGNED_ALLOC((p.n_scalars + n_tasks * p.max_depth) * NUMV_EXPR_TILE * sizeof(double));
+    if(!p.steps || !p.scalars){
+        DATALIB_FREE(p.steps);
+        DATALIB_ALIGNED_FREE(p.scalars);
+        return NULL;
+    }
+    p.pointers = (const double**)(p.steps + p.n_steps);
+    p.stacks = p.scalars + p.n_scalars * NUMV_EXPR_TILE;
+    p.n_steps = p.depth = p.n_scalars = 0;
+    numv_expr_compile(e, &p);
+
+    const struct numv_kernels* kernels = numv_kernels();
+    size_t s;
+    for(s = 0; s != p.n_steps; ++s){
+        if(p.steps[s].node->type == NUMV_EXPR_SCALAR){
+            double* tile = p.scalars + p.steps[s].tile * NUMV_EXPR_TILE;
+            kernels->fill(tile, p.steps[s].node->value, NUMV_EXPR_TILE);
+        }
+    }
+    numv_parallel_for(n, n_tasks, numv_expr_task, &p);
+
+    DATALIB_FREE(p.steps);
+    DATALIB_ALIGNED_FREE(p.scalars);
+    return dst;
+}
+
+double* numv_expr_eval(numv_expr_t* e){
+    size_t n = numv_expr_size(e);
+    if(n == 0) return NULL;
+    double* nv = numv_empty(n);
+    if(!nv) return NULL;
+    if(!numv_expr_eval_into(nv, e)){
+        numv_free(nv);
+        return NULL;
+    }
+    return nv;
+}
@@ -0,0 +1,37 @@
+#ifndef DATALIB_NUMV_INTERNAL_H
+#define DATALIB_NUMV_INTERNAL_H
+
+#include "numv.h"
+#include "numv_kernels.h"
+
+#include "math.h"
+
+/* Internal helpers shared by numv and the typed arrays of numv_types.h */
+
+/* Bytes reserved before the first item.
+ * The header is padded so that the items start on an aligned boundary.
+ */
+#define NUMV_HEADER_SIZE DATALIB_ALIGN_UP(sizeof(struct numv))
+
+/* Number of items reduced by one call to a kernel.
+ * Larger arrays are split in halves on a multiple of the block size,
+ * and the partial results are combined pairwise.
+ */
+#define NUMV_BLOCK 1024
+
+/* The kernels give an infinity for the min or max of an array of NaNs,
+ * which must be told apart from an array that holds that infinity.
+ * `FOUND` tells whether the array holds `value`, and is only evaluated for infinities.
+ */
+#define NUMV_NAN_IF_MISSING(value, FOUND) (isinf(value) && !(FOUND) ? NAN : (value))
+
+/* Allocates `n` items of `item_size` bytes after a numv header, so that `numv_size` and `numv_free` work on them */
+void* numv_alloc(size_t n, size_t item_size);
+
+/* Number of items in the first half of a range split for a pairwise reduction */
+size_t numv_split(size_t n);
+
+/* Combines `NUMV_LANES` partial sums pairwise, in the same order as the kernels */
+double numv_lanes_sum(double* lanes);
+
+#endif /* DATALIB_NUMV_INTERNAL_H */
@@ -0,0 +1,607 @@
+#include "numv_internal.h"
+
+#include <math.h>
+
+/* SIMD kernels are compiled for each instruction set with function target attributes
+ * and selected at runtime, so the library does not need to be built with `-mavx2` etc.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define NUMV_X86
+    #include <immintrin.h>
+#endif
+
+/* Multiplications and additions must not be fused into FMA instructions,
+ * which round once instead of twice, so that every level gives the same results.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC optimize("fp-contract=off")
+#else
+    #pragma STDC FP_CONTRACT OFF
+#endif
+
+
+/* --- Scalar kernels --- */
+
+#define NUMV_SCALAR_BINARY(NAME, EXPR) \
+static void numv_##NAME##_scalar(double* out, const double* a, const double* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = EXPR; \
+}
+
+#define NUMV_SCALAR_SCALAR(NAME, EXPR) \
+static void numv_##NAME##_scalar(double* out, const double* a, double value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = EXPR; \
+}
+
+#define NUMV_SCALAR_UNARY(NAME, EXPR) \
+static void numv_##NAME##_scalar(double* out, const double* a, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = EXPR; \
+}
+
+NUMV_SCALAR_BINARY(add, a[i] + b[i])
+NUMV_SCALAR_BINARY(sub, a[i] - b[i])
+NUMV_SCALAR_BINARY(mult, a[i] * b[i])
+NUMV_SCALAR_BINARY(div, a[i] / b[i])
+NUMV_SCALAR_BINARY(pow, pow(a[i], b[i]))
+NUMV_SCALAR_BINARY(hypot, hypot(a[i], b[i]))
+
+NUMV_SCALAR_BINARY(lt, a[i] < b[i] ? 1.0 : 0.0)
+NUMV_SCALAR_BINARY(le, a[i] <= b[i] ? 1.0 : 0.0)
+NUMV_SCALAR_BINARY(eq, a[i] == b[i] ? 1.0 : 0.0)
+NUMV_SCALAR_BINARY(ne, a[i] != b[i] ? 1.0 : 0.0)
+
+NUMV_SCALAR_SCALAR(adds, a[i] + value)
+NUMV_SCALAR_SCALAR(subs, a[i] - value)
+NUMV_SCALAR_SCALAR(mults, a[i] * value)
+NUMV_SCALAR_SCALAR(divs, a[i] / value)
+NUMV_SCALAR_SCALAR(pows, pow(a[i], value))
+
+NUMV_SCALAR_SCALAR(replace_nans, isnan(a[i]) ? value : a[i])
+
+/* cbrt, exp and log call the C library at every level, so that results match it exactly */
+NUMV_SCALAR_UNARY(sqrt, sqrt(a[i]))
+NUMV_SCALAR_UNARY(cbrt, cbrt(a[i]))
+NUMV_SCALAR_UNARY(exp, exp(a[i]))
+NUMV_SCALAR_UNARY(log, log(a[i]))
+
+static void numv_fill_scalar(double* out, double value, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i) out[i] = value;
+}
+
+/* Update of one lane of a reduction with an item `x`.
+ * The comparisons match the SIMD min and max instructions, which return their
+ * second operand when the first is NaN, so NaNs are skipped.
+ */
+#define NUMV_STEP_SUM(lane, x) ((lane) + (x))
+#define NUMV_STEP_MIN(lane, x) ((x) < (lane) ? (x) : (lane))
+#define NUMV_STEP_MAX(lane, x) ((x) > (lane) ? (x) : (lane))
+
+/* Combines the lanes of a reduction pairwise, in the same order at every level */
+#define NUMV_LANES_COMBINE(NAME, T, STEP) \
+T numv_lanes_##NAME(T* lanes){ \
+    size_t w, j; \
+    for(w = NUMV_LANES / 2; w != 0; w /= 2){ \
+        for(j = 0; j != w; ++j) lanes[j] = STEP(lanes[j], lanes[j + w]); \
+    } \
+    return lanes[0]; \
+}
+
+NUMV_LANES_COMBINE(sum, double, NUMV_STEP_SUM)
+static NUMV_LANES_COMBINE(min, double, NUMV_STEP_MIN)
+static NUMV_LANES_COMBINE(max, double, NUMV_STEP_MAX)
+static NUMV_LANES_COMBINE(min_f32, float, NUMV_STEP_MIN)
+static NUMV_LANES_COMBINE(max_f32, float, NUMV_STEP_MAX)
+
+#define NUMV_SCALAR_REDUCTION(NAME, INIT, STEP) \
+static double numv_##NAME##_scalar(const double* a, size_t n){ \
+    double lanes[NUMV_LANES]; \
+    size_t i, k; \
+    for(k = 0; k != NUMV_LANES; ++k) lanes[k] = INIT; \
+    for(i = 0; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES; ++k) lanes[k] = STEP(lanes[k], a[i + k]); \
+    } \
+    for(k = 0; i != n; ++i, ++k) lanes[k] = STEP(lanes[k], a[i]); \
+    return numv_lanes_##NAME(lanes); \
+}
+
+NUMV_SCALAR_REDUCTION(sum, 0.0, NUMV_STEP_SUM)
+NUMV_SCALAR_REDUCTION(min, INFINITY, NUMV_STEP_MIN)
+NUMV_SCALAR_REDUCTION(max, -INFINITY, NUMV_STEP_MAX)
+
+static double numv_sum_sqdev_scalar(const double* a, size_t n, double mean){
+    double lanes[NUMV_LANES] = {0};
+    size_t i;
+    for(i = 0; i != n; ++i){
+        double d = a[i] - mean;
+        lanes[i % NUMV_LANES] += d * d;
+    }
+    return numv_lanes_sum(lanes);
+}
+
+static double numv_sum_minmax_scalar(const double* a, size_t n, double* min, double* max){
+    double sum[NUMV_LANES], lo[NUMV_LANES], hi[NUMV_LANES];
+    size_t i, k;
+    for(k = 0; k != NUMV_LANES; ++k){
+        sum[k] = 0.0;
+        lo[k] = INFINITY;
+        hi[k] = -INFINITY;
+    }
+    for(i = 0; i != n; ++i){
+        k = i % NUMV_LANES;
+        sum[k] = NUMV_STEP_SUM(sum[k], a[i]);
+        lo[k] = NUMV_STEP_MIN(lo[k], a[i]);
+        hi[k] = NUMV_STEP_MAX(hi[k], a[i]);
+    }
+    *min = numv_lanes_min(lo);
+    *max = numv_lanes_max(hi);
+    return numv_lanes_sum(sum);
+}
+
+static size_t numv_find_scalar(const double* a, size_t n, double value){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        if(a[i] == value) return i;
+    }
+    return n;
+}
+
+static const struct numv_kernels numv_kernels_scalar = {
+    .level = NUMV_SIMD_SCALAR,
+    .add = numv_add_scalar, .sub = numv_sub_scalar, .mult = numv_mult_scalar, .div = numv_div_scalar,
+    .pow = numv_pow_scalar, .hypot = numv_hypot_scalar,
+    .lt = numv_lt_scalar, .le = numv_le_scalar, .eq = numv_eq_scalar, .ne = numv_ne_scalar,
+    .sqrt = numv_sqrt_scalar, .cbrt = numv_cbrt_scalar, .exp = numv_exp_scalar, .log = numv_log_scalar,
+    .adds = numv_adds_scalar, .subs = numv_subs_scalar, .mults = numv_mults_scalar, .divs = numv_divs_scalar,
+    .pows = numv_pows_scalar,
+    .replace_nans = numv_replace_nans_scalar,
+    .fill = numv_fill_scalar,
+    .sum = numv_sum_scalar, .sum_sqdev = numv_sum_sqdev_scalar,
+    .min = numv_min_scalar, .max = numv_max_scalar, .sum_minmax = numv_sum_minmax_scalar,
+    .find = numv_find_scalar
+};
+
+#define NUMV_SCALAR_F32_BINARY(NAME, OP) \
+static void numv_##NAME##_f32_scalar(float* out, const float* a, const float* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = a[i] OP b[i]; \
+}
+
+#define NUMV_SCALAR_F32_SCALAR(NAME, OP) \
+static void numv_##NAME##_f32_scalar(float* out, const float* a, float value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = a[i] OP value; \
+}
+
+NUMV_SCALAR_F32_BINARY(add, +)
+NUMV_SCALAR_F32_BINARY(sub, -)
+NUMV_SCALAR_F32_BINARY(mult, *)
+NUMV_SCALAR_F32_BINARY(div, /)
+NUMV_SCALAR_F32_SCALAR(adds, +)
+NUMV_SCALAR_F32_SCALAR(subs, -)
+NUMV_SCALAR_F32_SCALAR(mults, *)
+NUMV_SCALAR_F32_SCALAR(divs, /)
+
+static void numv_fill_f32_scalar(float* out, float value, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i) out[i] = value;
+}
+
+static double numv_sum_f32_scalar(const float* a, size_t n){
+    double lanes[NUMV_LANES] = {0};
+    size_t i;
+    for(i = 0; i != n; ++i) lanes[i % NUMV_LANES] += (double)a[i];
+    return numv_lanes_sum(lanes);
+}
+
+#define NUMV_SCALAR_F32_REDUCTION(NAME, INIT, STEP) \
+static float numv_##NAME##_f32_scalar(const float* a, size_t n){ \
+    float lanes[NUMV_LANES]; \
+    size_t i, k; \
+    for(k = 0; k != NUMV_LANES; ++k) lanes[k] = INIT; \
+    for(i = 0; i != n; ++i){ \
+        k = i % NUMV_LANES; \
+        lanes[k] = STEP(lanes[k], a[i]); \
+    } \
+    return numv_lanes_##NAME##_f32(lanes); \
+}
+
+NUMV_SCALAR_F32_REDUCTION(min, INFINITY, NUMV_STEP_MIN)
+NUMV_SCALAR_F32_REDUCTION(max, -INFINITY, NUMV_STEP_MAX)
+
+static const struct numv_kernels_f32 numv_kernels_f32_scalar = {
+    .level = NUMV_SIMD_SCALAR,
+    .add = numv_add_f32_scalar, .sub = numv_sub_f32_scalar,
+    .mult = numv_mult_f32_scalar, .div = numv_div_f32_scalar,
+    .adds = numv_adds_f32_scalar, .subs = numv_subs_f32_scalar,
+    .mults = numv_mults_f32_scalar, .divs = numv_divs_f32_scalar,
+    .fill = numv_fill_f32_scalar,
+    .sum = numv_sum_f32_scalar, .min = numv_min_f32_scalar, .max = numv_max_f32_scalar
+};
+
+
+/* --- SIMD kernels --- */
+#ifdef NUMV_X86
+
+/* Generates the kernels of one instruction set.
+ * `ISA` names the variant, `TARGET` is the target attribute, `VEC` the vector type,
+ * `WIDTH` the number of doubles per vector and `P` the prefix of the intrinsics.
+ * Loads and stores are unaligned, as the inputs may be any buffer.
+ * The remaining items are computed one by one, with the same operations.
+ */
+#define NUMV_SIMD_BINARY(ISA, TARGET, VEC, WIDTH, P, NAME, VOP, OP) \
+__attribute__((target(TARGET))) \
+static void numv_##NAME##_##ISA(double* out, const double* a, const double* b, size_t n){ \
+    size_t i = 0; \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        VEC x = P##_loadu_pd(a + i); \
+        VEC y = P##_loadu_pd(b + i); \
+        P##_storeu_pd(out + i, P##_##VOP##_pd(x, y)); \
+    } \
+    for(; i != n; ++i) out[i] = a[i] OP b[i]; \
+}
+
+#define NUMV_SIMD_SCALAR(ISA, TARGET, VEC, WIDTH, P, NAME, VOP, OP) \
+__attribute__((target(TARGET))) \
+static void numv_##NAME##_##ISA(double* out, const double* a, double value, size_t n){ \
+    size_t i = 0; \
+    VEC y = P##_set1_pd(value); \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        P##_storeu_pd(out + i, P##_##VOP##_pd(P##_loadu_pd(a + i), y)); \
+    } \
+    for(; i != n; ++i) out[i] = a[i] OP value; \
+}
+
+/* Comparison giving 1.0 or 0.0, with `OP` the SSE2 name and `PRED` the AVX predicate */
+#define NUMV_SIMD_COMPARE(ISA, TARGET, VEC, WIDTH, P, NAME, CMP, OP, PRED, SOP) \
+__attribute__((target(TARGET))) \
+static void numv_##NAME##_##ISA(double* out, const double* a, const double* b, size_t n){ \
+    size_t i = 0; \
+    VEC one = P##_set1_pd(1.0); \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        P##_storeu_pd(out + i, CMP(P##_loadu_pd(a + i), P##_loadu_pd(b + i), OP, PRED, one)); \
+    } \
+    for(; i != n; ++i) out[i] = a[i] SOP b[i] ? 1.0 : 0.0; \
+}
+
+/* Vector forms of the reduction steps, with `P` the prefix of the intrinsics */
+#define NUMV_VSTEP_SUM(P, acc, x) P##_add_pd(acc, x)
+#define NUMV_VSTEP_MIN(P, acc, x) P##_min_pd(x, acc)
+#define NUMV_VSTEP_MAX(P, acc, x) P##_max_pd(x, acc)
+
+/* Each vector accumulator holds `WIDTH` consecutive lanes */
+#define NUMV_SIMD_REDUCTION(ISA, TARGET, VEC, WIDTH, P, NAME, INIT, VSTEP, STEP) \
+__attribute__((target(TARGET))) \
+static double numv_##NAME##_##ISA(const double* a, size_t n){ \
+    VEC acc[NUMV_LANES / WIDTH]; \
+    double lanes[NUMV_LANES]; \
+    size_t i = 0, k; \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) acc[k] = P##_set1_pd(INIT); \
+    for(; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+            acc[k] = VSTEP(P, acc[k], P##_loadu_pd(a + i + k * WIDTH)); \
+        } \
+    } \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) P##_storeu_pd(lanes + k * WIDTH, acc[k]); \
+    for(k = 0; i != n; ++i, ++k) lanes[k] = STEP(lanes[k], a[i]); \
+    return numv_lanes_##NAME(lanes); \
+}
+
+#define NUMV_SIMD_KERNELS(ISA, LEVEL, TARGET, VEC, WIDTH, P, EQMASK, CMP, NANFILL) \
+NUMV_SIMD_BINARY(ISA, TARGET, VEC, WIDTH, P, add, add, +) \
+NUMV_SIMD_BINARY(ISA, TARGET, VEC, WIDTH, P, sub, sub, -) \
+NUMV_SIMD_BINARY(ISA, TARGET, VEC, WIDTH, P, mult, mul, *) \
+NUMV_SIMD_BINARY(ISA, TARGET, VEC, WIDTH, P, div, div, /) \
+NUMV_SIMD_COMPARE(ISA, TARGET, VEC, WIDTH, P, lt, CMP, cmplt, _CMP_LT_OQ, <) \
+NUMV_SIMD_COMPARE(ISA, TARGET, VEC, WIDTH, P, le, CMP, cmple, _CMP_LE_OQ, <=) \
+NUMV_SIMD_COMPARE(ISA, TARGET, VEC, WIDTH, P, eq, CMP, cmpeq, _CMP_EQ_OQ, ==) \
+NUMV_SIMD_COMPARE(ISA, TARGET, VEC, WIDTH, P, ne, CMP, cmpneq, _CMP_NEQ_UQ, !=) \
+__attribute__((target(TARGET))) \
+static void numv_sqrt_##ISA(double* out, const double* a, size_t n){ \
+    size_t i = 0; \
+    for(; i + WIDTH <= n; i += WIDTH) P##_storeu_pd(out + i, P##_sqrt_pd(P##_loadu_pd(a + i))); \
+    for(; i != n; ++i) out[i] = sqrt(a[i]); \
+} \
+NUMV_SIMD_SCALAR(ISA, TARGET, VEC, WIDTH, P, adds, add, +) \
+NUMV_SIMD_SCALAR(ISA, TARGET, VEC, WIDTH, P, subs, sub, -) \
+NUMV_SIMD_SCALAR(ISA, TARGET, VEC, WIDTH, P, mults, mul, *) \
+NUMV_SIMD_SCALAR(ISA, TARGET, VEC, WIDTH, P, divs, div, /) \
+__attribute__((target(TARGET))) \
+static void numv_replace_nans_##ISA(double* out, const double* a, double value, size_t n){ \
+    size_t i = 0; \
+    VEC y = P##_set1_pd(value); \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        VEC x = P##_loadu_pd(a + i); \
+        P##_storeu_pd(out + i, NANFILL(x, y)); \
+    } \
+    for(; i != n; ++i) out[i] = isnan(a[i]) ? value : a[i]; \
+} \
+__attribute__((target(TARGET))) \
+static void numv_fill_##ISA(double* out, double value, size_t n){ \
+    size_t i = 0; \
+    VEC y = P##_set1_pd(value); \
+    for(; i + WIDTH <= n; i += WIDTH) P##_storeu_pd(out + i, y); \
+    for(; i != n; ++i) out[i] = value; \
+} \
+NUMV_SIMD_REDUCTION(ISA, TARGET, VEC, WIDTH, P, sum, 0.0, NUMV_VSTEP_SUM, NUMV_STEP_SUM) \
+NUMV_SIMD_REDUCTION(ISA, TARGET, VEC, WIDTH, P, min, INFINITY, NUMV_VSTEP_MIN, NUMV_STEP_MIN) \
+NUMV_SIMD_REDUCTION(ISA, TARGET, VEC, WIDTH, P, max, -INFINITY, NUMV_VSTEP_MAX, NUMV_STEP_MAX) \
+__attribute__((target(TARGET))) \
+static double numv_sum_sqdev_##ISA(const double* a, size_t n, double mean){ \
+    VEC acc[NUMV_LANES / WIDTH]; \
+    VEC m = P##_set1_pd(mean); \
+    double lanes[NUMV_LANES]; \
+    size_t i = 0, k; \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) acc[k] = P##_setzero_pd(); \
+    for(; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+            VEC d = P##_sub_pd(P##_loadu_pd(a + i + k * WIDTH), m); \
+            acc[k] = P##_add_pd(acc[k], P##_mul_pd(d, d)); \
+        } \
+    } \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) P##_storeu_pd(lanes + k * WIDTH, acc[k]); \
+    for(k = 0; i != n; ++i, ++k){ \
+        double d = a[i] - mean; \
+        lanes[k] += d * d; \
+    } \
+    return numv_lanes_sum(lanes); \
+} \
+__attribute__((target(TARGET))) \
+static double numv_sum_minmax_##ISA(const double* a, size_t n, double* min, double* max){ \
+    VEC sum[NUMV_LANES / WIDTH], lo[NUMV_LANES / WIDTH], hi[NUMV_LANES / WIDTH]; \
+    double sums[NUMV_LANES], los[NUMV_LANES], his[NUMV_LANES]; \
+    size_t i = 0, k; \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+        sum[k] = P##_setzero_pd(); \
+        lo[k] = P##_set1_pd(INFINITY); \
+        hi[k] = P##_set1_pd(-INFINITY); \
+    } \
+    for(; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+            VEC x = P##_loadu_pd(a + i + k * WIDTH); \
+            sum[k] = NUMV_VSTEP_SUM(P, sum[k], x); \
+            lo[k] = NUMV_VSTEP_MIN(P, lo[k], x); \
+            hi[k] = NUMV_VSTEP_MAX(P, hi[k], x); \
+        } \
+    } \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+        P##_storeu_pd(sums + k * WIDTH, sum[k]); \
+        P##_storeu_pd(los + k * WIDTH, lo[k]); \
+        P##_storeu_pd(his + k * WIDTH, hi[k]); \
+    } \
+    for(k = 0; i != n; ++i, ++k){ \
+        sums[k] = NUMV_STEP_SUM(sums[k], a[i]); \
+        los[k] = NUMV_STEP_MIN(los[k], a[i]); \
+        his[k] = NUMV_STEP_MAX(his[k], a[i]); \
+    } \
+    *min = numv_lanes_min(los); \
+    *max = numv_lanes_max(his); \
+    return numv_lanes_sum(sums); \
+} \
+__attribute__((target(TARGET))) \
+static size_t numv_find_##ISA(const double* a, size_t n, double value){ \
+    size_t i = 0; \
+    VEC v = P##_set1_pd(value); \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        unsigned mask = EQMASK(P##_loadu_pd(a + i), v); \
+        if(mask) return i + (size_t)__builtin_ctz(mask); \
+    } \
+    for(; i != n; ++i){ \
+        if(a[i] == value) return i; \
+    } \
+    return n; \
+} \
+static const struct numv_kernels numv_kernels_##ISA = { \
+    .level = LEVEL, \
+    .add = numv_add_##ISA, .sub = numv_sub_##ISA, .mult = numv_mult_##ISA, .div = numv_div_##ISA, \
+    .pow = numv_pow_scalar, .hypot = numv_hypot_scalar, \
+    .lt = numv_lt_##ISA, .le = numv_le_##ISA, .eq = numv_eq_##ISA, .ne = numv_ne_##ISA, \
+    .sqrt = numv_sqrt_##ISA, .cbrt = numv_cbrt_scalar, .exp = numv_exp_scalar, .log = numv_log_scalar, \
+    .adds = numv_adds_##ISA, .subs = numv_subs_##ISA, .mults = numv_mults_##ISA, .divs = numv_divs_##ISA, \
+    .pows = numv_pows_scalar, \
+    .replace_nans = numv_replace_nans_##ISA, \
+    .fill = numv_fill_##ISA, \
+    .sum = numv_sum_##ISA, .sum_sqdev = numv_sum_sqdev_##ISA, \
+    .min = numv_min_##ISA, .max = numv_max_##ISA, .sum_minmax = numv_sum_minmax_##ISA, \
+    .find = numv_find_##ISA \
+};
+
+/* Generates the single-precision kernels of one instruction set.
+ * `VECF` is the float vector type of `WIDTH` floats, `VEC` the double vector type
+ * of half as many items, and `LO` and `HI` convert the halves of a float vector to it.
+ */
+#define NUMV_SIMD_KERNELS_F32(ISA, LEVEL, TARGET, VECF, WIDTH, P, VEC, LO, HI) \
+NUMV_SIMD_F32_BINARY(ISA, TARGET, VECF, WIDTH, P, add, add, +) \
+NUMV_SIMD_F32_BINARY(ISA, TARGET, VECF, WIDTH, P, sub, sub, -) \
+NUMV_SIMD_F32_BINARY(ISA, TARGET, VECF, WIDTH, P, mult, mul, *) \
+NUMV_SIMD_F32_BINARY(ISA, TARGET, VECF, WIDTH, P, div, div, /) \
+NUMV_SIMD_F32_SCALAR(ISA, TARGET, VECF, WIDTH, P, adds, add, +) \
+NUMV_SIMD_F32_SCALAR(ISA, TARGET, VECF, WIDTH, P, subs, sub, -) \
+NUMV_SIMD_F32_SCALAR(ISA, TARGET, VECF, WIDTH, P, mults, mul, *) \
+NUMV_SIMD_F32_SCALAR(ISA, TARGET, VECF, WIDTH, P, divs, div, /) \
+__attribute__((target(TARGET))) \
+static void numv_fill_f32_##ISA(float* out, float value, size_t n){ \
+    size_t i = 0; \
+    VECF y = P##_set1_ps(value); \
+    for(; i + WIDTH <= n; i += WIDTH) P##_storeu_ps(out + i, y); \
+    for(; i != n; ++i) out[i] = value; \
+} \
+__attribute__((target(TARGET))) \
+static double numv_sum_f32_##ISA(const float* a, size_t n){ \
+    VEC acc[2 * NUMV_LANES / WIDTH]; \
+    double lanes[NUMV_LANES]; \
+    size_t i = 0, k; \
+    for(k = 0; k != 2 * NUMV_LANES / WIDTH; ++k) acc[k] = P##_setzero_pd(); \
+    for(; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+            VECF x = P##_loadu_ps(a + i + k * WIDTH); \
+            acc[2 * k] = P##_add_pd(acc[2 * k], LO(x)); \
+            acc[2 * k + 1] = P##_add_pd(acc[2 * k + 1], HI(x)); \
+        } \
+    } \
+    for(k = 0; k != 2 * NUMV_LANES / WIDTH; ++k) P##_storeu_pd(lanes + k * WIDTH / 2, acc[k]); \
+    for(k = 0; i != n; ++i, ++k) lanes[k] += (double)a[i]; \
+    return numv_lanes_sum(lanes); \
+} \
+NUMV_SIMD_F32_REDUCTION(ISA, TARGET, VECF, WIDTH, P, min, INFINITY, min, NUMV_STEP_MIN) \
+NUMV_SIMD_F32_REDUCTION(ISA, TARGET, VECF, WIDTH, P, max, -INFINITY, max, NUMV_STEP_MAX) \
+static const struct numv_kernels_f32 numv_kernels_f32_##ISA = { \
+    .level = LEVEL, \
+    .add = numv_add_f32_##ISA, .sub = numv_sub_f32_##ISA, \
+    .mult = numv_mult_f32_##ISA, .div = numv_div_f32_##ISA, \
+    .adds = numv_adds_f32_##ISA, .subs = numv_subs_f32_##ISA, \
+    .mults = numv_mults_f32_##ISA, .divs = numv_divs_f32_##ISA, \
+    .fill = numv_fill_f32_##ISA, \
+    .sum = numv_sum_f32_##ISA, .min = numv_min_f32_##ISA, .max = numv_max_f32_##ISA \
+};
+
+#define NUMV_SIMD_F32_BINARY(ISA, TARGET, VECF, WIDTH, P, NAME, VOP, OP) \
+__attribute__((target(TARGET))) \
+static void numv_##NAME##_f32_##ISA(float* out, const float* a, const float* b, size_t n){ \
+    size_t i = 0; \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        P##_storeu_ps(out + i, P##_##VOP##_ps(P##_loadu_ps(a + i), P##_loadu_ps(b + i))); \
+    } \
+    for(; i != n; ++i) out[i] = a[i] OP b[i]; \
+}
+
+#define NUMV_SIMD_F32_SCALAR(ISA, TARGET, VECF, WIDTH, P, NAME, VOP, OP) \
+__attribute__((target(TARGET))) \
+static void numv_##NAME##_f32_##ISA(float* out, const float* a, float value, size_t n){ \
+    size_t i = 0; \
+    VECF y = P##_set1_ps(value); \
+    for(; i + WIDTH <= n; i += WIDTH){ \
+        P##_storeu_ps(out + i, P##_##VOP##_ps(P##_loadu_ps(a + i), y)); \
+    } \
+    for(; i != n; ++i) out[i] = a[i] OP value; \
+}
+
+/* Min and max over `NUMV_LANES` float lanes, with the item as first operand as for doubles */
+#define NUMV_SIMD_F32_REDUCTION(ISA, TARGET, VECF, WIDTH, P, NAME, INIT, VOP, STEP) \
+__attribute__((target(TARGET))) \
+static float numv_##NAME##_f32_##ISA(const float* a, size_t n){ \
+    VECF acc[NUMV_LANES / WIDTH]; \
+    float lanes[NUMV_LANES]; \
+    size_t i = 0, k; \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) acc[k] = P##_set1_ps(INIT); \
+    for(; i + NUMV_LANES <= n; i += NUMV_LANES){ \
+        for(k = 0; k != NUMV_LANES / WIDTH; ++k){ \
+            acc[k] = P##_##VOP##_ps(P##_loadu_ps(a + i + k * WIDTH), acc[k]); \
+        } \
+    } \
+    for(k = 0; k != NUMV_LANES / WIDTH; ++k) P##_storeu_ps(lanes + k * WIDTH, acc[k]); \
+    for(k = 0; i != n; ++i, ++k) lanes[k] = STEP(lanes[k], a[i]); \
+    return numv_lanes_##NAME##_f32(lanes); \
+}
+
+/* Conversions of the low and high halves of a float vector to double vectors */
+#define NUMV_LO_SSE2(x) _mm_cvtps_pd(x)
+#define NUMV_HI_SSE2(x) _mm_cvtps_pd(_mm_movehl_ps(x, x))
+#define NUMV_LO_AVX2(x) _mm256_cvtps_pd(_mm256_castps256_ps128(x))
+#define NUMV_HI_AVX2(x) _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1))
+#define NUMV_LO_AVX512(x) _mm512_cvtps_pd(_mm512_castps512_ps256(x))
+#define NUMV_HI_AVX512(x) _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1)))
+
+/* Bit mask of the items of two vectors that compare equal */
+#define NUMV_EQMASK_SSE2(x, y) _mm_movemask_pd(_mm_cmpeq_pd(x, y))
+#define NUMV_EQMASK_AVX2(x, y) _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ))
+#define NUMV_EQMASK_AVX512(x, y) _mm512_cmp_pd_mask(x, y, _CMP_EQ_OQ)
+
+/* Comparison of two vectors giving `one` where it holds and 0.0 elsewhere */
+#define NUMV_CMP_SSE2(x, y, OP, PRED, one) _mm_and_pd(_mm_##OP##_pd(x, y), one)
+#define NUMV_CMP_AVX2(x, y, OP, PRED, one) _mm256_and_pd(_mm256_cmp_pd(x, y, PRED), one)
+#define NUMV_CMP_AVX512(x, y, OP, PRED, one) _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, y, PRED), one)
+
+/* Items of `x` with NaNs replaced by the items of `y` */
+#define NUMV_NANFILL_SSE2(x, y) \
+    _mm_or_pd(_mm_and_pd(_mm_cmpunord_pd(x, x), y), _mm_andnot_pd(_mm_cmpunord_pd(x, x), x))
+#define NUMV_NANFILL_AVX2(x, y) _mm256_blendv_pd(x, y, _mm256_cmp_pd(x, x, _CMP_UNORD_Q))
+#define NUMV_NANFILL_AVX512(x, y) _mm512_mask_mov_pd(x, _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q), y)
+
+NUMV_SIMD_KERNELS(sse2, NUMV_SIMD_SSE2, "sse2", __m128d, 2, _mm,
+                  NUMV_EQMASK_SSE2, NUMV_CMP_SSE2, NUMV_NANFILL_SSE2)
+NUMV_SIMD_KERNELS(avx2, NUMV_SIMD_AVX2, "avx2", __m256d, 4, _mm256,
+                  NUMV_EQMASK_AVX2, NUMV_CMP_AVX2, NUMV_NANFILL_AVX2)
+NUMV_SIMD_KERNELS(avx512, NUMV_SIMD_AVX512, "avx512f", __m512d, 8, _mm512,
+                  NUMV_EQMASK_AVX512, NUMV_CMP_AVX512, NUMV_NANFILL_AVX512)
+
+NUMV_SIMD_KERNELS_F32(sse2, NUMV_SIMD_SSE2, "sse2", __m128, 4, _mm, __m128d, NUMV_LO_SSE2, NUMV_HI_SSE2)
+NUMV_SIMD_KERNELS_F32(avx2, NUMV_SIMD_AVX2, "avx2", __m256, 8, _mm256, __m256d, NUMV_LO_AVX2, NUMV_HI_AVX2)
+NUMV_SIMD_KERNELS_F32(avx512, NUMV_SIMD_AVX512, "avx512f", __m512, 16, _mm512, __m512d,
+                      NUMV_LO_AVX512, NUMV_HI_AVX512)
+
+#endif /* NUMV_X86 */
+
+
+/* --- Dispatch --- */
+
+/* Kernels for a given instruction set level,
+ * or NULL if the CPU or the compiler does not support it.
+ */
+const struct numv_kernels* numv_kernels_level(enum numv_simd_level level){
+    switch(level){
+    case NUMV_SIMD_SCALAR:
+        return &numv_kernels_scalar;
+#ifdef NUMV_X86
+    case NUMV_SIMD_SSE2:
+        return __builtin_cpu_supports("sse2") ? &numv_kernels_sse2 : NULL;
+    case NUMV_SIMD_AVX2:
+        return __builtin_cpu_supports("avx2") ? &numv_kernels_avx2 : NULL;
+    case NUMV_SIMD_AVX512:
+        return __builtin_cpu_supports("avx512f") ? &numv_kernels_avx512 : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+/* Single-precision kernels for a given instruction set level,
+ * or NULL if the CPU or the compiler does not support it.
+ */
+const struct numv_kernels_f32* numv_kernels_f32_level(enum numv_simd_level level){
+    if(!numv_kernels_level(level)) return NULL;
+    switch(level){
+#ifdef NUMV_X86
+    case NUMV_SIMD_SSE2:
+        return &numv_kernels_f32_sse2;
+    case NUMV_SIMD_AVX2:
+        return &numv_kernels_f32_avx2;
+    case NUMV_SIMD_AVX512:
+        return &numv_kernels_f32_avx512;
+#endif
+    default:
+        return &numv_kernels_f32_scalar;
+    }
+}
+
+static const struct numv_kernels* numv_active = &numv_kernels_scalar;
+static const struct numv_kernels_f32* numv_active_f32 = &numv_kernels_f32_scalar;
+
+#ifdef NUMV_X86
+/* Selects the best kernels before `main` runs, so that later calls need no synchronisation */
+__attribute__((constructor))
+static void numv_select_kernels(void){
+    __builtin_cpu_init();
+    int level;
+    for(level = NUMV_SIMD_AVX512; level != NUMV_SIMD_SCALAR; --level){
+        const struct numv_kernels* kernels = numv_kernels_level((enum numv_simd_level)level);
+        if(kernels){
+            numv_active = kernels;
+            numv_active_f32 = numv_kernels_f32_level((enum numv_simd_level)level);
+            return;
+        }
+    }
+}
+#endif
+
+/* Kernels for the best instruction set supported by the CPU, selected once at startup */
+const struct numv_kernels* numv_kernels(void){
+    return numv_active;
+}
+
+/* Single-precision kernels, selected at the same level as `numv_kernels()` */
+const struct numv_kernels_f32* numv_kernels_f32(void){
+    return numv_active_f32;
+}
@@ -0,0 +1,119 @@
+#ifndef DATALIB_NUMV_KERNELS_H
+#define DATALIB_NUMV_KERNELS_H
+
+#include "defs.h"
+
+/* Internal element-wise kernels used by numv.
+ * Each kernel processes `n` doubles from raw buffers and writes them to `out`,
+ * which may be the same buffer as an input.
+ * Every instruction set level computes bitwise identical results,
+ * except for the sign and payload of NaNs, which depend on the order of the operands.
+ */
+
+enum numv_simd_level {
+    NUMV_SIMD_SCALAR,
+    NUMV_SIMD_SSE2,
+    NUMV_SIMD_AVX2,
+    NUMV_SIMD_AVX512
+};
+
+typedef void (*numv_binary_kernel)(double* out, const double* a, const double* b, size_t n);
+typedef void (*numv_scalar_kernel)(double* out, const double* a, double value, size_t n);
+typedef void (*numv_unary_kernel)(double* out, const double* a, size_t n);
+
+struct numv_kernels {
+    enum numv_simd_level level;
+
+    /* out[i] = a[i] op b[i] */
+    numv_binary_kernel add;
+    numv_binary_kernel sub;
+    numv_binary_kernel mult;
+    numv_binary_kernel div;
+    numv_binary_kernel pow;
+    numv_binary_kernel hypot;
+
+    /* out[i] = a[i] op b[i] ? 1.0 : 0.0, false if either is NaN except for `ne` */
+    numv_binary_kernel lt;
+    numv_binary_kernel le;
+    numv_binary_kernel eq;
+    numv_binary_kernel ne;
+
+    /* out[i] = op(a[i]) */
+    numv_unary_kernel sqrt;
+    numv_unary_kernel cbrt;
+    numv_unary_kernel exp;
+    numv_unary_kernel log;
+
+    /* out[i] = a[i] op value */
+    numv_scalar_kernel adds;
+    numv_scalar_kernel subs;
+    numv_scalar_kernel mults;
+    numv_scalar_kernel divs;
+    numv_scalar_kernel pows;
+
+    /* out[i] = isnan(a[i]) ? value : a[i] */
+    numv_scalar_kernel replace_nans;
+
+    /* out[i] = value */
+    void (*fill)(double* out, double value, size_t n);
+
+    /* Reductions over `NUMV_LANES` interleaved partial results:
+     * item i goes to lane i % NUMV_LANES, then lanes j and j + w are combined
+     * for w = 8, 4, 2 and 1. The order is the same at every level.
+     */
+    double (*sum)(const double* a, size_t n);
+    double (*sum_sqdev)(const double* a, size_t n, double mean); /* sum of (a[i] - mean)^2 */
+    double (*min)(const double* a, size_t n); /* Ignores NaNs, +INFINITY if there is no other value */
+    double (*max)(const double* a, size_t n); /* Ignores NaNs, -INFINITY if there is no other value */
+    /* Returns the sum and writes the min and max, in one pass with the same results as above */
+    double (*sum_minmax)(const double* a, size_t n, double* min, double* max);
+
+    /* Index of the first item equal to `value`, or `n` if there is none */
+    size_t (*find)(const double* a, size_t n, double value);
+};
+
+#define NUMV_LANES 16
+
+/* Kernels of the single-precision arrays of numv_types.h */
+typedef void (*numv_f32_binary_kernel)(float* out, const float* a, const float* b, size_t n);
+typedef void (*numv_f32_scalar_kernel)(float* out, const float* a, float value, size_t n);
+
+struct numv_kernels_f32 {
+    enum numv_simd_level level;
+
+    /* out[i] = a[i] op b[i] */
+    numv_f32_binary_kernel add;
+    numv_f32_binary_kernel sub;
+    numv_f32_binary_kernel mult;
+    numv_f32_binary_kernel div;
+
+    /* out[i] = a[i] op value */
+    numv_f32_scalar_kernel adds;
+    numv_f32_scalar_kernel subs;
+    numv_f32_scalar_kernel mults;
+    numv_f32_scalar_kernel divs;
+
+    /* out[i] = value */
+    void (*fill)(float* out, float value, size_t n);
+
+    /* Reductions over the same lanes as the double kernels.
+     * The sum converts the items to double and adds them in double precision.
+     */
+    double (*sum)(const float* a, size_t n);
+    float (*min)(const float* a, size_t n); /* Ignores NaNs, +INFINITY if there is no other value */
+    float (*max)(const float* a, size_t n); /* Ignores NaNs, -INFINITY if there is no other value */
+};
+
+/* Kernels for the best instruction set supported by the CPU, selected once at startup */
+const struct numv_kernels* numv_kernels(void);
+
+/* Kernels for a given instruction set level,
+ * or NULL if the CPU or the compiler does not support it.
+ */
+const struct numv_kernels* numv_kernels_level(enum numv_simd_level level);
+
+/* Single-precision kernels, selected at the same level as `numv_kernels()` */
+const struct numv_kernels_f32* numv_kernels_f32(void);
+const struct numv_kernels_f32* numv_kernels_f32_level(enum numv_simd_level level);
+
+#endif /* DATALIB_NUMV_KERNELS_H */
@@ -0,0 +1,68 @@
+#include "numv_parallel.h"
+
+/* Minimum number of items per range of `numv_parallel_for` */
+#define NUMV_PARALLEL_GRAIN 32768
+
+/* Ranges per thread of `numv_parallel_for`, so that faster threads take more of them */
+#define NUMV_PARALLEL_TASKS_PER_THREAD 4
+
+static size_t numv_threshold = NUMV_PARALLEL_THRESHOLD;
+static threadpool_t* numv_pool = NULL;
+
+/* Set the pool that runs numv functions on large arrays */
+void numv_set_threadpool(threadpool_t* pool){
+    numv_pool = pool;
+}
+
+/* Set the number of items from which numv functions use several threads */
+void numv_set_parallel_threshold(size_t n){
+    numv_threshold = n;
+}
+
+/* Pool that should run work on `n` items, or NULL to run it on the calling thread.
+ * numv functions called from the tasks of the pool run their own tasks on the calling thread,
+ * see `threadpool_run`.
+ */
+threadpool_t* numv_parallel_pool(size_t n){
+    if(n < numv_threshold) return NULL;
+    threadpool_t* pool = numv_pool ? numv_pool : threadpool_default();
+    if(threadpool_size(pool) <= 1) return NULL;
+    return pool;
+}
+
+/* Number of ranges `numv_parallel_for` splits `n` items into */
+size_t numv_parallel_tasks(size_t n){
+    threadpool_t* pool = numv_parallel_pool(n);
+    if(!pool) return 1;
+    size_t n_tasks = threadpool_size(pool) * NUMV_PARALLEL_TASKS_PER_THREAD;
+    size_t max_tasks = (n + NUMV_PARALLEL_GRAIN - 1) / NUMV_PARALLEL_GRAIN;
+    return n_tasks < max_tasks ? n_tasks : max_tasks;
+}
+
+struct numv_parallel_for_job {
+    size_t n;
+    size_t chunk;
+    void (*fn)(size_t task, size_t start, size_t count, void* args);
+    void* args;
+};
+
+static void numv_parallel_for_task(size_t task, void* args){
+    struct numv_parallel_for_job* job = args;
+    size_t start = task * job->chunk;
+    if(start >= job->n) return;
+    size_t count = job->n - start < job->chunk ? job->n - start : job->chunk;
+    job->fn(task, start, count, job->args);
+}
+
+/* Calls `fn(task, start, count, args)` on consecutive ranges covering `[0, n)` */
+void numv_parallel_for(size_t n, size_t n_tasks,
+                       void (*fn)(size_t task, size_t start, size_t count, void* args), void* args){
+    if(n == 0) return;
+    if(n_tasks <= 1){
+        fn(0, 0, n, args);
+        return;
+    }
+    struct numv_parallel_for_job job = {n, 0, fn, args};
+    job.chunk = ((n + n_tasks - 1) / n_tasks + 7) & ~(size_t)7;
+    threadpool_run(numv_parallel_pool(n), n_tasks, numv_parallel_for_task, &job);
+}
@@ -0,0 +1,25 @@
+#ifndef DATALIB_NUMV_PARALLEL_H
+#define DATALIB_NUMV_PARALLEL_H
+
+#include "numv.h"
+#include "threadpool.h"
+
+/* Internal helpers that split numv work across the pool set with `numv_set_threadpool`.
+ * Work below the threshold set with `numv_set_parallel_threshold` runs on the calling thread,
+ * and so does work started from a task of the pool, which `threadpool_run` runs inline.
+ */
+
+/* Pool that should run work on `n` items with `threadpool_run`, or NULL to run it on the calling thread */
+threadpool_t* numv_parallel_pool(size_t n);
+
+/* Number of ranges `numv_parallel_for` splits `n` items into */
+size_t numv_parallel_tasks(size_t n);
+
+/* Calls `fn(task, start, count, args)` on consecutive ranges covering `[0, n)`,
+ * with `n_tasks` ranges as returned by `numv_parallel_tasks`.
+ * The ranges start on multiples of 8 items, so that they do not share cache lines.
+ */
+void numv_parallel_for(size_t n, size_t n_tasks,
+                       void (*fn)(size_t task, size_t start, size_t count, void* args), void* args);
+
+#endif /* DATALIB_NUMV_PARALLEL_H */
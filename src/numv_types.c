@@ -0,0 +1,322 @@
+#include "numv_types.h"
+#include "numv_internal.h"
+
+
+/* --- Conversions of single values --- */
+
+/* Rounds toward zero, saturating out of range values and giving 0 for NaN */
+static int32_t numv_to_i32(double x){
+    if(isnan(x)) return 0;
+    if(x <= (double)INT32_MIN) return INT32_MIN;
+    if(x >= (double)INT32_MAX) return INT32_MAX;
+    return (int32_t)x;
+}
+
+/* Same as `numv_to_i32`. 2^63 is the first double above INT64_MAX. */
+static int64_t numv_to_i64(double x){
+    if(isnan(x)) return 0;
+    if(x <= -9223372036854775808.0) return INT64_MIN;
+    if(x >= 9223372036854775808.0) return INT64_MAX;
+    return (int64_t)x;
+}
+
+#define NUMV_TO_F32(x) ((float)(x))
+#define NUMV_TO_F64(x) ((double)(x))
+#define NUMV_TO_I32(x) numv_to_i32((double)(x))
+#define NUMV_TO_I64(x) numv_to_i64((double)(x))
+
+
+/* --- Kernels of each type --- */
+
+/* Single precision uses the SIMD kernels selected at startup */
+#define NUMV_F32_BINARY_KERNEL(NAME) \
+static void numv_f32_##NAME##_kernel(float* out, const float* a, const float* b, size_t n){ \
+    numv_kernels_f32()->NAME(out, a, b, n); \
+}
+
+#define NUMV_F32_SCALAR_KERNEL(NAME) \
+static void numv_f32_##NAME##_kernel(float* out, const float* a, float value, size_t n){ \
+    numv_kernels_f32()->NAME(out, a, value, n); \
+}
+
+NUMV_F32_BINARY_KERNEL(add)
+NUMV_F32_BINARY_KERNEL(sub)
+NUMV_F32_BINARY_KERNEL(mult)
+NUMV_F32_BINARY_KERNEL(div)
+NUMV_F32_SCALAR_KERNEL(adds)
+NUMV_F32_SCALAR_KERNEL(subs)
+NUMV_F32_SCALAR_KERNEL(mults)
+NUMV_F32_SCALAR_KERNEL(divs)
+
+static void numv_f32_fill_kernel(float* out, float value, size_t n){
+    numv_kernels_f32()->fill(out, value, n);
+}
+
+static double numv_f32_sum_range(const float* a, size_t n, const struct numv_kernels_f32* kernels){
+    if(n <= NUMV_BLOCK) return kernels->sum(a, n);
+    size_t half = numv_split(n);
+    return numv_f32_sum_range(a, half, kernels) + numv_f32_sum_range(a + half, n - half, kernels);
+}
+
+static double numv_f32_sum_kernel(const float* a, size_t n){
+    return numv_f32_sum_range(a, n, numv_kernels_f32());
+}
+
+static size_t numv_f32_find(const float* a, size_t n, float value);
+
+static float numv_f32_min_kernel(const float* a, size_t n){
+    if(n == 0) return NAN;
+    float value = numv_kernels_f32()->min(a, n);
+    return NUMV_NAN_IF_MISSING(value, numv_f32_find(a, n, value) != n);
+}
+
+static float numv_f32_max_kernel(const float* a, size_t n){
+    if(n == 0) return NAN;
+    float value = numv_kernels_f32()->max(a, n);
+    return NUMV_NAN_IF_MISSING(value, numv_f32_find(a, n, value) != n);
+}
+
+/* Integer kernels compute in the unsigned type `U` of the same width,
+ * so that overflows wrap around instead of being undefined.
+ * Division by zero gives 0, and the min divided by -1 wraps around to the min.
+ */
+#define NUMV_INT_KERNELS(PREFIX, T, U) \
+static T PREFIX##_divide(T a, T b){ \
+    if(b == 0) return 0; \
+    if(b == -1) return (T)(0 - (U)a); \
+    return a / b; \
+} \
+static void PREFIX##_add_kernel(T* out, const T* a, const T* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] + (U)b[i]); \
+} \
+static void PREFIX##_sub_kernel(T* out, const T* a, const T* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] - (U)b[i]); \
+} \
+static void PREFIX##_mult_kernel(T* out, const T* a, const T* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] * (U)b[i]); \
+} \
+static void PREFIX##_div_kernel(T* out, const T* a, const T* b, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = PREFIX##_divide(a[i], b[i]); \
+} \
+static void PREFIX##_adds_kernel(T* out, const T* a, T value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] + (U)value); \
+} \
+static void PREFIX##_subs_kernel(T* out, const T* a, T value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] - (U)value); \
+} \
+static void PREFIX##_mults_kernel(T* out, const T* a, T value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = (T)((U)a[i] * (U)value); \
+} \
+static void PREFIX##_divs_kernel(T* out, const T* a, T value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = PREFIX##_divide(a[i], value); \
+} \
+static void PREFIX##_fill_kernel(T* out, T value, size_t n){ \
+    size_t i; \
+    for(i = 0; i != n; ++i) out[i] = value; \
+} \
+static int64_t PREFIX##_sum_kernel(const T* a, size_t n){ \
+    uint64_t sum = 0; \
+    size_t i; \
+    for(i = 0; i != n; ++i) sum += (uint64_t)a[i]; \
+    return (int64_t)sum; \
+} \
+/* Sum in double precision for the mean, which cannot overflow */ \
+static double PREFIX##_sum_f64_kernel(const T* a, size_t n){ \
+    if(n > NUMV_BLOCK){ \
+        size_t half = numv_split(n); \
+        return PREFIX##_sum_f64_kernel(a, half) + PREFIX##_sum_f64_kernel(a + half, n - half); \
+    } \
+    double lanes[NUMV_LANES] = {0}; \
+    size_t i; \
+    for(i = 0; i != n; ++i) lanes[i % NUMV_LANES] += (double)a[i]; \
+    return numv_lanes_sum(lanes); \
+} \
+static T PREFIX##_min_kernel(const T* a, size_t n){ \
+    T value = n ? a[0] : 0; \
+    size_t i; \
+    for(i = 1; i < n; ++i) value = a[i] < value ? a[i] : value; \
+    return value; \
+} \
+static T PREFIX##_max_kernel(const T* a, size_t n){ \
+    T value = n ? a[0] : 0; \
+    size_t i; \
+    for(i = 1; i < n; ++i) value = a[i] > value ? a[i] : value; \
+    return value; \
+}
+
+NUMV_INT_KERNELS(numv_i32, int32_t, uint32_t)
+NUMV_INT_KERNELS(numv_i64, int64_t, uint64_t)
+
+
+/* --- Functions of each type --- */
+
+#define NUMV_DEFINE_BINARY(PREFIX, T, NAME) \
+T* PREFIX##_##NAME##_into(T* dst, T* a, T* b){ \
+    if(!dst || !a || !b) return NULL; \
+    size_t n = numv_size(dst); \
+    if(numv_size(a) != n || numv_size(b) != n) return NULL; \
+    PREFIX##_##NAME##_kernel(dst, a, b, n); \
+    return dst; \
+} \
+T* PREFIX##_##NAME(T* a, T* b){ \
+    if(!a || !b || numv_size(a) != numv_size(b)) return NULL; \
+    T* dst = PREFIX##_empty(numv_size(a)); \
+    if(!dst) return NULL; \
+    return PREFIX##_##NAME##_into(dst, a, b); \
+} \
+T* PREFIX##_##NAME##_inplace(T* a, T* b){ \
+    return PREFIX##_##NAME##_into(a, a, b); \
+}
+
+#define NUMV_DEFINE_SCALAR(PREFIX, T, NAME) \
+T* PREFIX##_##NAME##_into(T* dst, T* a, T value){ \
+    if(!dst || !a || numv_size(a) != numv_size(dst)) return NULL; \
+    PREFIX##_##NAME##_kernel(dst, a, value, numv_size(dst)); \
+    return dst; \
+} \
+T* PREFIX##_##NAME(T* a, T value){ \
+    if(!a) return NULL; \
+    T* dst = PREFIX##_empty(numv_size(a)); \
+    if(!dst) return NULL; \
+    return PREFIX##_##NAME##_into(dst, a, value); \
+} \
+T* PREFIX##_##NAME##_inplace(T* a, T value){ \
+    return PREFIX##_##NAME##_into(a, a, value); \
+}
+
+/* `EMPTY` is the min and max of an empty array, `CONV` converts a double to T,
+ * and `MEAN_SUM` names the kernel that sums the items in double precision for the mean.
+ */
+#define NUMV_DEFINE_TYPE(PREFIX, T, SUM_T, EMPTY, CONV, MEAN_SUM) \
+T* PREFIX##_empty(size_t n){ \
+    return numv_alloc(n, sizeof(T)); \
+} \
+T* PREFIX##_full(size_t n, T value){ \
+    T* nv = PREFIX##_empty(n); \
+    if(!nv) return NULL; \
+    PREFIX##_fill_kernel(nv, value, n); \
+    return nv; \
+} \
+T* PREFIX##_zeros(size_t n){ \
+    return PREFIX##_full(n, 0); \
+} \
+T* PREFIX##_range(double start, double end, size_t n){ \
+    double value = start, step = (end - start) / (double)n; \
+    T* nv = PREFIX##_empty(n); \
+    if(!nv) return NULL; \
+    size_t i; \
+    for(i = 0; i != n; ++i){ \
+        nv[i] = CONV(value); \
+        value += step; \
+    } \
+    return nv; \
+} \
+T* PREFIX##_from_array(size_t n, const T* data){ \
+    if(!data) return NULL; \
+    T* nv = PREFIX##_empty(n); \
+    if(!nv) return NULL; \
+    memcpy(nv, data, n * sizeof(T)); \
+    return nv; \
+} \
+T* PREFIX##_copy(T* nv){ \
+    if(!nv) return NULL; \
+    return PREFIX##_from_array(numv_size(nv), nv); \
+} \
+NUMV_DEFINE_BINARY(PREFIX, T, add) \
+NUMV_DEFINE_BINARY(PREFIX, T, sub) \
+NUMV_DEFINE_BINARY(PREFIX, T, mult) \
+NUMV_DEFINE_BINARY(PREFIX, T, div) \
+NUMV_DEFINE_SCALAR(PREFIX, T, adds) \
+NUMV_DEFINE_SCALAR(PREFIX, T, subs) \
+NUMV_DEFINE_SCALAR(PREFIX, T, mults) \
+NUMV_DEFINE_SCALAR(PREFIX, T, divs) \
+SUM_T PREFIX##_sum(T* nv){ \
+    return PREFIX##_sum_kernel(nv, numv_size(nv)); \
+} \
+double PREFIX##_mean(T* nv){ \
+    if(!nv) return NAN; \
+    return PREFIX##_##MEAN_SUM##_kernel(nv, numv_size(nv)) / (double)numv_size(nv); \
+} \
+/* Sum of squared deviations from the mean, in double precision */ \
+static double PREFIX##_sqdev(const T* a, size_t n, double mean){ \
+    if(n > NUMV_BLOCK){ \
+        size_t half = numv_split(n); \
+        return PREFIX##_sqdev(a, half, mean) + PREFIX##_sqdev(a + half, n - half, mean); \
+    } \
+    double lanes[NUMV_LANES] = {0}; \
+    size_t i; \
+    for(i = 0; i != n; ++i){ \
+        double d = (double)a[i] - mean; \
+        lanes[i % NUMV_LANES] += d * d; \
+    } \
+    return numv_lanes_sum(lanes); \
+} \
+double PREFIX##_std(T* nv){ \
+    if(!nv) return NAN; \
+    size_t n = numv_size(nv); \
+    return sqrt(PREFIX##_sqdev(nv, n, PREFIX##_mean(nv)) / (double)n); \
+} \
+T PREFIX##_min(T* nv){ \
+    if(!nv) return EMPTY; \
+    return PREFIX##_min_kernel(nv, numv_size(nv)); \
+} \
+T PREFIX##_max(T* nv){ \
+    if(!nv) return EMPTY; \
+    return PREFIX##_max_kernel(nv, numv_size(nv)); \
+} \
+/* NaN is never equal to an item, so an array of NaNs gives its size */ \
+static size_t PREFIX##_find(const T* a, size_t n, T value){ \
+    size_t i; \
+    for(i = 0; i != n; ++i){ \
+        if(a[i] == value) return i; \
+    } \
+    return n; \
+} \
+size_t PREFIX##_imin(T* nv){ \
+    return PREFIX##_find(nv, numv_size(nv), PREFIX##_min(nv)); \
+} \
+size_t PREFIX##_imax(T* nv){ \
+    return PREFIX##_find(nv, numv_size(nv), PREFIX##_max(nv)); \
+}
+
+/* Sums of floats are already in double precision */
+NUMV_DEFINE_TYPE(numv_f32, float, double, NAN, NUMV_TO_F32, sum)
+NUMV_DEFINE_TYPE(numv_i32, int32_t, int64_t, 0, NUMV_TO_I32, sum_f64)
+NUMV_DEFINE_TYPE(numv_i64, int64_t, int64_t, 0, NUMV_TO_I64, sum_f64)
+
+
+/* --- Conversions --- */
+
+#define NUMV_DEFINE_CONVERSION(NAME, TO, FROM, CONV) \
+TO* NAME(FROM* nv){ \
+    if(!nv) return NULL; \
+    size_t n = numv_size(nv), i; \
+    TO* out = numv_alloc(n, sizeof(TO)); \
+    if(!out) return NULL; \
+    for(i = 0; i != n; ++i) out[i] = CONV(nv[i]); \
+    return out; \
+}
+
+NUMV_DEFINE_CONVERSION(numv_f32_from_f64, float, double, NUMV_TO_F32)
+NUMV_DEFINE_CONVERSION(numv_f32_from_i32, float, int32_t, NUMV_TO_F32)
+NUMV_DEFINE_CONVERSION(numv_f32_from_i64, float, int64_t, NUMV_TO_F32)
+
+NUMV_DEFINE_CONVERSION(numv_i32_from_f64, int32_t, double, NUMV_TO_I32)
+NUMV_DEFINE_CONVERSION(numv_i32_from_f32, int32_t, float, NUMV_TO_I32)
+NUMV_DEFINE_CONVERSION(numv_i32_from_i64, int32_t, int64_t, NUMV_TO_I32)
+
+NUMV_DEFINE_CONVERSION(numv_i64_from_f64, int64_t, double, NUMV_TO_I64)
+NUMV_DEFINE_CONVERSION(numv_i64_from_f32, int64_t, float, NUMV_TO_I64)
+NUMV_DEFINE_CONVERSION(numv_i64_from_i32, int64_t, int32_t, (int64_t))
+
+NUMV_DEFINE_CONVERSION(numv_from_f32, double, float, NUMV_TO_F64)
+NUMV_DEFINE_CONVERSION(numv_from_i32, double, int32_t, NUMV_TO_F64)
+NUMV_DEFINE_CONVERSION(numv_from_i64, double, int64_t, NUMV_TO_F64)
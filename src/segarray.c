@@ -0,0 +1,277 @@
+#include "segarray.h"
+
+/* Minimum number of elements in a block, so that blocks can always be split */
+#define SEGARRAY_MIN_BLOCK_CAPACITY 16
+
+
+/* Returns the block at a given position of the directory */
+static struct segarray_block* segarray_block_at(segarray_t* segarray, size_t b){
+	return array_at(&segarray->blocks, b);
+}
+
+/* Returns the position in the directory of the block that holds an index.
+   An index equal to the size of the array maps to the last block. */
+static size_t segarray_find_block(segarray_t* segarray, size_t index){
+	size_t n = segarray->blocks.size;
+	if(n <= 1 || index >= segarray->size) return n ? n - 1 : 0;
+
+	/* Blocks have similar sizes, so the block is usually found within
+	   a few steps of the one predicted by the average block size */
+	size_t guess = index / (segarray->size / n);
+	if(guess >= n) guess = n - 1;
+	int steps;
+	for(steps = 0; steps != 4; ++steps){
+		struct segarray_block* block = segarray_block_at(segarray, guess);
+		if(index < block->start){
+			guess--;
+		} else if(index >= block->start + block->size){
+			guess++;
+		} else {
+			return guess;
+		}
+	}
+
+	/* Binary search for the last block that starts at or before the index */
+	size_t lo = 0, hi = n;
+	while(hi - lo > 1){
+		size_t mid = lo + (hi - lo) / 2;
+		if(segarray_block_at(segarray, mid)->start <= index){
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/* Shifts the starting index of the blocks after a given one */
+static void segarray_shift_starts(segarray_t* segarray, size_t b, int delta){
+	size_t i;
+	for(i = b + 1; i < segarray->blocks.size; ++i){
+		segarray_block_at(segarray, i)->start += delta;
+	}
+}
+
+/* Adds an empty block to the directory at a given position */
+static struct segarray_block* segarray_new_block(segarray_t* segarray, size_t b, size_t start){
+	struct segarray_block block;
+	block.data = DATALIB_ALIGNED_ALLOC(segarray->block_capacity * segarray->element_size);
+	if(!block.data) return NULL;
+	block.size = 0;
+	block.start = start;
+	if(!array_insert(&segarray->blocks, &block, b)){
+		DATALIB_ALIGNED_FREE(block.data);
+		return NULL;
+	}
+	return segarray_block_at(segarray, b);
+}
+
+/* Moves the upper half of a full block into a new block placed after it */
+static segarray_t* segarray_split_block(segarray_t* segarray, size_t b){
+	struct segarray_block* block = segarray_block_at(segarray, b);
+	size_t half = block->size / 2;
+	struct segarray_block* next = segarray_new_block(segarray, b + 1, block->start + half);
+	if(!next) return NULL;
+
+	/* The directory may have been reallocated */
+	block = segarray_block_at(segarray, b);
+	next->size = block->size - half;
+	memcpy(next->data, block->data + half * segarray->element_size,
+		next->size * segarray->element_size);
+	block->size = half;
+	return segarray;
+}
+
+/* Frees a block and removes it from the directory */
+static void segarray_free_block(segarray_t* segarray, size_t b){
+	DATALIB_ALIGNED_FREE(segarray_block_at(segarray, b)->data);
+	array_remove(&segarray->blocks, b);
+}
+
+/* Appends the elements of a block into the previous one, if they fit in half a block */
+static void segarray_merge_block(segarray_t* segarray, size_t b){
+	if(b == 0 || b >= segarray->blocks.size) return;
+	struct segarray_block* prev = segarray_block_at(segarray, b - 1);
+	struct segarray_block* block = segarray_block_at(segarray, b);
+	if(prev->size + block->size > segarray->block_capacity / 2) return;
+
+	memcpy(prev->data + prev->size * segarray->element_size, block->data,
+		block->size * segarray->element_size);
+	prev->size += block->size;
+	segarray_free_block(segarray, b);
+}
+
+
+/* -- INITIALIZATIONS -- */
+
+/* Initialises a segmented array via a given pointer */
+void* segarray_init(segarray_t* segarray, size_t element_size){
+	if(!segarray) return NULL;
+	*segarray = (segarray_t){0};
+	if(element_size == 0) return NULL;
+	if(!array_init(&segarray->blocks, sizeof(struct segarray_block))) return NULL;
+	segarray->element_size = element_size;
+
+	/* Largest power of two number of elements that fits the block size */
+	size_t capacity = SEGARRAY_MIN_BLOCK_CAPACITY;
+	while(capacity * 2 * element_size <= SEGARRAY_BLOCK_BYTES){
+		capacity *= 2;
+	}
+	segarray->block_capacity = capacity;
+	return segarray;
+}
+
+/* Deallocates and resets the segmented array without freeing the object itself */
+void segarray_uninit(segarray_t* segarray){
+	if(!segarray) return;
+	segarray_clear(segarray);
+	array_uninit(&segarray->blocks);
+	*segarray = (segarray_t){0};
+}
+
+/* Creates a new empty segmented array */
+segarray_t* segarray_create(size_t element_size){
+	if(element_size == 0) return NULL;
+	segarray_t* segarray = DATALIB_ALLOC(sizeof(segarray_t));
+	if(!segarray) return NULL;
+	segarray_init(segarray, element_size);
+	return segarray;
+}
+
+/* Frees a segmented array and its elements */
+void segarray_destroy(segarray_t* segarray){
+	if(!segarray) return;
+	segarray_uninit(segarray);
+	DATALIB_FREE(segarray);
+}
+
+
+/* -- RETRIEVALS -- */
+
+/* Returns a pointer to the element at the given index */
+void* segarray_get(segarray_t* segarray, size_t index){
+	if(!segarray || index >= segarray->size) return NULL;
+	struct segarray_block* block = segarray_block_at(segarray, segarray_find_block(segarray, index));
+	return block->data + (index - block->start) * segarray->element_size;
+}
+
+/* Overwrites an element at the given index with the given data */
+void* segarray_set(segarray_t* segarray, const void* element, size_t index){
+	char* addr = segarray_get(segarray, index);
+	if(!addr) return NULL;
+	if(!element){
+		memset(addr, 0, segarray->element_size);
+	} else {
+		memmove(addr, element, segarray->element_size);
+	}
+	return addr;
+}
+
+
+/* -- INSERTING -- */
+
+/* Inserts an element at the given index */
+segarray_t* segarray_insert(segarray_t* segarray, const void* element, size_t index){
+	if(!segarray || segarray->element_size == 0 || index > segarray->size){
+		return NULL;
+	}
+
+	if(segarray->blocks.size == 0){
+		if(!segarray_new_block(segarray, 0, 0)) return NULL;
+	}
+
+	size_t b = segarray_find_block(segarray, index);
+	struct segarray_block* block = segarray_block_at(segarray, b);
+	size_t pos = index - block->start;
+
+	if(block->size == segarray->block_capacity){
+		/* Prefer appending to the previous block over splitting this one */
+		struct segarray_block* prev = b > 0 ? segarray_block_at(segarray, b - 1) : NULL;
+		if(pos == 0 && prev && prev->size < segarray->block_capacity){
+			b--;
+			block = prev;
+			pos = block->size;
+		} else if(pos == block->size && b + 1 == segarray->blocks.size){
+			/* Appending starts a new block, so that blocks stay full */
+			block = segarray_new_block(segarray, b + 1, segarray->size);
+			if(!block) return NULL;
+			b++;
+			pos = 0;
+		} else {
+			if(!segarray_split_block(segarray, b)) return NULL;
+			block = segarray_block_at(segarray, b);
+			if(pos > block->size){
+				pos -= block->size;
+				b++;
+				block = segarray_block_at(segarray, b);
+			}
+		}
+	}
+
+	size_t es = segarray->element_size;
+	char* addr = block->data + pos * es;
+	if(pos < block->size){
+		memmove(addr + es, addr, (block->size - pos) * es);
+	}
+	if(!element){
+		memset(addr, 0, es);
+	} else {
+		memcpy(addr, element, es);
+	}
+	block->size++;
+	segarray->size++;
+	segarray_shift_starts(segarray, b, 1);
+	return segarray;
+}
+
+/* Inserts the element to the end of the segmented array */
+segarray_t* segarray_push_back(segarray_t* segarray, const void* element){
+	if(!segarray) return NULL;
+	return segarray_insert(segarray, element, segarray->size);
+}
+
+
+/* -- DELETING -- */
+
+/* Removes the element at the given index */
+segarray_t* segarray_remove(segarray_t* segarray, size_t index){
+	if(!segarray || index >= segarray->size) return NULL;
+
+	size_t b = segarray_find_block(segarray, index);
+	struct segarray_block* block = segarray_block_at(segarray, b);
+	size_t pos = index - block->start;
+	size_t es = segarray->element_size;
+
+	char* addr = block->data + pos * es;
+	memmove(addr, addr + es, (block->size - pos - 1) * es);
+	block->size--;
+	segarray->size--;
+	segarray_shift_starts(segarray, b, -1);
+
+	if(block->size == 0){
+		segarray_free_block(segarray, b);
+	} else if(b + 1 < segarray->blocks.size){
+		segarray_merge_block(segarray, b + 1);
+	} else {
+		segarray_merge_block(segarray, b);
+	}
+	return segarray;
+}
+
+/* Removes the last element of the segmented array */
+segarray_t* segarray_pop_back(segarray_t* segarray){
+	if(!segarray || segarray->size == 0) return NULL;
+	return segarray_remove(segarray, segarray->size - 1);
+}
+
+/* Removes all elements and frees all blocks */
+segarray_t* segarray_clear(segarray_t* segarray){
+	if(!segarray) return NULL;
+	size_t i;
+	for(i = 0; i != segarray->blocks.size; ++i){
+		DATALIB_ALIGNED_FREE(segarray_block_at(segarray, i)->data);
+	}
+	array_clear(&segarray->blocks);
+	segarray->size = 0;
+	return segarray;
+}
@@ -0,0 +1,185 @@
+#include "soa.h"
+
+
+/* Frees the columns and names of the first `n` fields */
+static void soa_free_columns(soa_t* soa, size_t n){
+	size_t c;
+	for(c = 0; c != n; ++c){
+		array_uninit(&soa->columns[c]);
+		DATALIB_FREE(soa->names[c]);
+	}
+	DATALIB_FREE(soa->columns);
+	DATALIB_FREE(soa->names);
+}
+
+/* Returns a copy of a string allocated on the heap */
+static char* soa_copy_name(const char* name){
+	size_t length = strlen(name) + 1;
+	char* copy = DATALIB_ALLOC(length);
+	if(copy) memcpy(copy, name, length);
+	return copy;
+}
+
+
+/* -- INITIALISATION -- */
+void* soa_init(soa_t* soa, const struct soa_field* fields, size_t n_fields){
+	if(!soa) return NULL;
+	*soa = (soa_t){0};
+	if(!fields || n_fields == 0) return NULL;
+
+	size_t c, d;
+	for(c = 0; c != n_fields; ++c){
+		if(!fields[c].name || fields[c].size == 0) return NULL;
+		for(d = 0; d != c; ++d){
+			if(strcmp(fields[c].name, fields[d].name) == 0) return NULL;
+		}
+	}
+
+	soa->columns = DATALIB_ALLOC(n_fields * sizeof(array_t));
+	soa->names = DATALIB_ALLOC(n_fields * sizeof(char*));
+	if(!soa->columns || !soa->names){
+		soa_free_columns(soa, 0);
+		*soa = (soa_t){0};
+		return NULL;
+	}
+
+	for(c = 0; c != n_fields; ++c){
+		soa->names[c] = soa_copy_name(fields[c].name);
+		if(!soa->names[c]){
+			soa_free_columns(soa, c);
+			*soa = (soa_t){0};
+			return NULL;
+		}
+		array_init(&soa->columns[c], fields[c].size);
+	}
+	soa->n_columns = n_fields;
+	return soa;
+}
+
+void soa_uninit(soa_t* soa){
+	if(!soa) return;
+	soa_free_columns(soa, soa->n_columns);
+	*soa = (soa_t){0};
+}
+
+soa_t* soa_create(const struct soa_field* fields, size_t n_fields){
+	soa_t* soa = DATALIB_ALLOC(sizeof(soa_t));
+	if(!soa) return NULL;
+	if(!soa_init(soa, fields, n_fields)){
+		DATALIB_FREE(soa);
+		return NULL;
+	}
+	return soa;
+}
+
+void soa_destroy(soa_t* soa){
+	if(!soa) return;
+	soa_uninit(soa);
+	DATALIB_FREE(soa);
+}
+
+
+/* -- COLUMNS -- */
+/* Returns the index of the column of a field */
+size_t soa_column_index(soa_t* soa, const char* name){
+	if(!soa || !name) return soa ? soa->n_columns : 0;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		if(strcmp(soa->names[c], name) == 0) return c;
+	}
+	return soa->n_columns;
+}
+
+/* Returns a pointer to the contiguous values of a column */
+void* soa_column(soa_t* soa, size_t column){
+	if(!soa || column >= soa->n_columns || soa->size == 0) return NULL;
+	return soa->columns[column].data;
+}
+
+/* Returns a pointer to the contiguous values of the column of a field */
+void* soa_column_by_name(soa_t* soa, const char* name){
+	return soa_column(soa, soa_column_index(soa, name));
+}
+
+/* Returns a pointer to a field of a record */
+void* soa_get(soa_t* soa, size_t column, size_t index){
+	if(!soa || column >= soa->n_columns) return NULL;
+	return array_get(&soa->columns[column], index);
+}
+
+
+/* -- RECORDS -- */
+/* Changes the number of records of every column */
+soa_t* soa_resize(soa_t* soa, size_t size){
+	if(!soa) return NULL;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		if(!array_resize(&soa->columns[c], size)){
+			/* Shrinking never fails, so the columns resized so far can be restored */
+			while(c--) array_resize(&soa->columns[c], soa->size);
+			return NULL;
+		}
+	}
+	soa->size = size;
+	return soa;
+}
+
+/* Inserts a record at the given index of every column */
+soa_t* soa_insert(soa_t* soa, const void* const* values, size_t index){
+	if(!soa || index > soa->size) return NULL;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		void* value = values ? (void*)values[c] : NULL;
+		if(!array_insert(&soa->columns[c], value, index)){
+			while(c--) array_remove(&soa->columns[c], index);
+			return NULL;
+		}
+	}
+	soa->size++;
+	return soa;
+}
+
+/* Inserts a record at the end of every column */
+soa_t* soa_push_back(soa_t* soa, const void* const* values){
+	if(!soa) return NULL;
+	return soa_insert(soa, values, soa->size);
+}
+
+/* Removes the record at the given index from every column */
+soa_t* soa_remove(soa_t* soa, size_t index){
+	if(!soa || index >= soa->size) return NULL;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		array_remove(&soa->columns[c], index);
+	}
+	soa->size--;
+	return soa;
+}
+
+/* Removes the record at the given index by moving the last record into its place */
+soa_t* soa_swap_remove(soa_t* soa, size_t index){
+	if(!soa || index >= soa->size) return NULL;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		array_swap_remove(&soa->columns[c], index);
+	}
+	soa->size--;
+	return soa;
+}
+
+/* Removes the last record */
+soa_t* soa_pop_back(soa_t* soa){
+	if(!soa || soa->size == 0) return NULL;
+	return soa_remove(soa, soa->size - 1);
+}
+
+/* Removes all records */
+soa_t* soa_clear(soa_t* soa){
+	if(!soa) return NULL;
+	size_t c;
+	for(c = 0; c != soa->n_columns; ++c){
+		array_clear(&soa->columns[c]);
+	}
+	soa->size = 0;
+	return soa;
+}
@@ -0,0 +1,334 @@
+#include "sort.h"
+#include "threadpool.h"
+
+/* Comparator-based instantiations of the sort template */
+#define SORT__CMP_PARAM , int (*cmp)(const void*, const void*)
+#define SORT__CMP_ARG , cmp
+#define SORT__CMP_LESS(a, b) (cmp(&(a), &(b)) < 0)
+
+/* 16-byte element moved as two 64-bit words */
+struct sort_pair { uint64_t lo, hi; };
+
+SORT__DEFINE(sort_cmp_1, uint8_t, SORT__CMP_LESS, SORT__CMP_PARAM, SORT__CMP_ARG)
+SORT__DEFINE(sort_cmp_2, uint16_t, SORT__CMP_LESS, SORT__CMP_PARAM, SORT__CMP_ARG)
+SORT__DEFINE(sort_cmp_4, uint32_t, SORT__CMP_LESS, SORT__CMP_PARAM, SORT__CMP_ARG)
+SORT__DEFINE(sort_cmp_8, uint64_t, SORT__CMP_LESS, SORT__CMP_PARAM, SORT__CMP_ARG)
+SORT__DEFINE(sort_cmp_16, struct sort_pair, SORT__CMP_LESS, SORT__CMP_PARAM, SORT__CMP_ARG)
+
+
+/* -- GENERIC ELEMENT SIZE -- */
+
+/* Swaps two elements of `size` bytes, eight bytes at a time */
+static void sort_swap(char* a, char* b, size_t size){
+	uint64_t x;
+	while(size >= sizeof(x)){
+		memcpy(&x, a, sizeof(x));
+		memcpy(a, b, sizeof(x));
+		memcpy(b, &x, sizeof(x));
+		a += sizeof(x);
+		b += sizeof(x);
+		size -= sizeof(x);
+	}
+	while(size--){
+		char c = *a;
+		*a++ = *b;
+		*b++ = c;
+	}
+}
+
+static void sort_generic_insertion(char* a, size_t n, size_t size,
+                                   int (*cmp)(const void*, const void*)){
+	size_t i, j;
+	for(i = 1; i < n; ++i){
+		for(j = i; j > 0 && cmp(a + j * size, a + (j - 1) * size) < 0; --j){
+			sort_swap(a + j * size, a + (j - 1) * size, size);
+		}
+	}
+}
+
+static void sort_generic_sift_down(char* a, size_t root, size_t n, size_t size,
+                                   int (*cmp)(const void*, const void*)){
+	size_t child;
+	while((child = 2 * root + 1) < n){
+		if(child + 1 < n && cmp(a + child * size, a + (child + 1) * size) < 0) child++;
+		if(cmp(a + root * size, a + child * size) >= 0) break;
+		sort_swap(a + root * size, a + child * size, size);
+		root = child;
+	}
+}
+
+static void sort_generic_heapsort(char* a, size_t n, size_t size,
+                                  int (*cmp)(const void*, const void*)){
+	size_t i;
+	for(i = n / 2; i-- > 0;) sort_generic_sift_down(a, i, n, size, cmp);
+	for(i = n; i-- > 1;){
+		sort_swap(a, a + i * size, size);
+		sort_generic_sift_down(a, 0, i, size, cmp);
+	}
+}
+
+static void sort_generic_introsort(char* a, size_t n, size_t size, unsigned depth,
+                                   int (*cmp)(const void*, const void*)){
+	while(n > SORT_INSERTION_THRESHOLD){
+		if(depth-- == 0){
+			sort_generic_heapsort(a, n, size, cmp);
+			return;
+		}
+
+		/* Median of three moved to the front */
+		char* lo = a, *mid = a + (n / 2) * size, *hi = a + (n - 1) * size;
+		if(cmp(mid, lo) < 0) sort_swap(mid, lo, size);
+		if(cmp(hi, mid) < 0){
+			sort_swap(hi, mid, size);
+			if(cmp(mid, lo) < 0) sort_swap(mid, lo, size);
+		}
+		sort_swap(a, mid, size);
+
+		/* Hoare partition around the element at the front */
+		size_t i = 0, j = n;
+		for(;;){
+			do ++i; while(i < n && cmp(a + i * size, a) < 0);
+			do --j; while(cmp(a, a + j * size) < 0);
+			if(i >= j) break;
+			sort_swap(a + i * size, a + j * size, size);
+		}
+		sort_swap(a, a + j * size, size);
+
+		char* right = a + (j + 1) * size;
+		size_t nl = j, nr = n - j - 1;
+		if(nl < nr){
+			sort_generic_introsort(a, nl, size, depth, cmp);
+			a = right;
+			n = nr;
+		} else {
+			sort_generic_introsort(right, nr, size, depth, cmp);
+			n = nl;
+		}
+	}
+	sort_generic_insertion(a, n, size, cmp);
+}
+
+
+/* -- PUBLIC -- */
+
+/* Sorts `n` elements of `size` bytes in ascending order */
+void sort_buffer(void* base, size_t n, size_t size, int (*cmp)(const void*, const void*)){
+	if(!base || !cmp || n < 2 || size == 0) return;
+
+	/* Elements are moved as integers only if the buffer is suitably aligned */
+	uintptr_t addr = (uintptr_t)base;
+	if(size == 1){
+		sort_cmp_1(base, n, cmp);
+	} else if(size == 2 && addr % 2 == 0){
+		sort_cmp_2(base, n, cmp);
+	} else if(size == 4 && addr % 4 == 0){
+		sort_cmp_4(base, n, cmp);
+	} else if(size == 8 && addr % 8 == 0){
+		sort_cmp_8(base, n, cmp);
+	} else if(size == 16 && addr % 8 == 0){
+		sort_cmp_16(base, n, cmp);
+	} else {
+		unsigned depth = 0;
+		size_t m;
+		for(m = n; m > 1; m >>= 1) depth += 2;
+		sort_generic_introsort(base, n, size, depth, cmp);
+	}
+}
+
+/* Returns the index of the first element not less than a key */
+size_t sort_lower_bound(const void* base, size_t n, size_t size, const void* key,
+                        int (*cmp)(const void*, const void*)){
+	if(!base || !cmp) return 0;
+	const char* first = base;
+	while(n > 0){
+		size_t half = n / 2;
+		if(cmp(first + half * size, key) < 0){
+			first += (half + 1) * size;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return (size_t)(first - (const char*)base) / size;
+}
+
+/* Returns the index of the first element greater than a key */
+size_t sort_upper_bound(const void* base, size_t n, size_t size, const void* key,
+                        int (*cmp)(const void*, const void*)){
+	if(!base || !cmp) return 0;
+	const char* first = base;
+	while(n > 0){
+		size_t half = n / 2;
+		if(cmp(key, first + half * size) >= 0){
+			first += (half + 1) * size;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return (size_t)(first - (const char*)base) / size;
+}
+
+
+/* -- PARALLEL SAMPLE SORT -- */
+
+/* Samples taken per bucket to choose the splitters */
+#define SORT_OVERSAMPLING 32
+
+/* Max number of buckets, so that bucket indices fit in a byte.
+   There are at most 127 splitters, with a bucket between each pair and one for each splitter. */
+#define SORT_MAX_BUCKETS 255
+#define SORT_MAX_SPLITTERS ((SORT_MAX_BUCKETS - 1) / 2)
+
+/* State shared by the tasks of a sample sort */
+struct sort_sample_job {
+	char* base;				/* Elements to sort */
+	char* tmp;				/* Buffer where elements are scattered into buckets */
+	uint8_t* bucket_of;		/* Bucket of each element */
+	size_t n, size;
+	int (*cmp)(const void*, const void*);
+	const char* splitters;	/* Distinct splitters in ascending order */
+	size_t n_splitters;
+	size_t n_buckets;
+	int equal_buckets;		/* Elements equal to a splitter go to odd buckets of their own */
+	size_t n_chunks;		/* Input chunks, one per classification task */
+	size_t* counts;			/* `n_chunks * n_buckets` element counts, then write offsets */
+	size_t* bucket_start;	/* `n_buckets + 1` offsets of the buckets in `tmp` */
+};
+
+/* Returns the range of elements of an input chunk */
+static void sort_chunk_range(struct sort_sample_job* job, size_t chunk, size_t* begin, size_t* end){
+	*begin = job->n * chunk / job->n_chunks;
+	*end = job->n * (chunk + 1) / job->n_chunks;
+}
+
+/* Assigns each element of a chunk to a bucket and counts the bucket sizes */
+static void sort_classify_task(size_t chunk, void* args){
+	struct sort_sample_job* job = args;
+	size_t* counts = job->counts + chunk * job->n_buckets;
+	size_t i, begin, end;
+	sort_chunk_range(job, chunk, &begin, &end);
+	for(i = begin; i != end; ++i){
+		const char* element = job->base + i * job->size;
+		size_t b = sort_upper_bound(job->splitters, job->n_splitters, job->size, element, job->cmp);
+		if(job->equal_buckets){
+			int equal = b > 0 && job->cmp(element, job->splitters + (b - 1) * job->size) == 0;
+			b = equal ? 2 * b - 1 : 2 * b;
+		}
+		job->bucket_of[i] = (uint8_t)b;
+		counts[b]++;
+	}
+}
+
+/* Copies each element of a chunk to the next free slot of its bucket */
+static void sort_scatter_task(size_t chunk, void* args){
+	struct sort_sample_job* job = args;
+	size_t* offsets = job->counts + chunk * job->n_buckets;
+	size_t i, begin, end;
+	sort_chunk_range(job, chunk, &begin, &end);
+	for(i = begin; i != end; ++i){
+		size_t dest = offsets[job->bucket_of[i]]++;
+		memcpy(job->tmp + dest * job->size, job->base + i * job->size, job->size);
+	}
+}
+
+/* Sorts a bucket and copies it back to its final place */
+static void sort_bucket_task(size_t bucket, void* args){
+	struct sort_sample_job* job = args;
+	size_t begin = job->bucket_start[bucket];
+	size_t count = job->bucket_start[bucket + 1] - begin;
+	char* src = job->tmp + begin * job->size;
+	/* A bucket of elements equal to a splitter is already sorted */
+	if(!job->equal_buckets || bucket % 2 == 0) sort_buffer(src, count, job->size, job->cmp);
+	memcpy(job->base + begin * job->size, src, count * job->size);
+}
+
+/* Sorts `n` elements of `size` bytes in ascending order across the threads of a pool */
+int sort_buffer_parallel(void* base, size_t n, size_t size,
+                         int (*cmp)(const void*, const void*), threadpool_t* pool){
+	if(!base || !cmp || size == 0) return 0;
+	if(!pool) pool = threadpool_default();
+	size_t n_threads = threadpool_size(pool);
+
+	if(n < SORT_PARALLEL_THRESHOLD || n_threads < 2){
+		sort_buffer(base, n, size, cmp);
+		return 1;
+	}
+
+	/* More buckets than threads balance the load of the bucket sorts */
+	struct sort_sample_job job;
+	job.base = base;
+	job.n = n;
+	job.size = size;
+	job.cmp = cmp;
+	job.n_chunks = n_threads;
+	size_t n_parts = n_threads * 4 < SORT_MAX_SPLITTERS + 1 ? n_threads * 4 : SORT_MAX_SPLITTERS + 1;
+
+	size_t n_samples = n_parts * SORT_OVERSAMPLING;
+	char* samples = DATALIB_ALLOC(n_samples * size);
+	job.tmp = DATALIB_ALIGNED_ALLOC(n * size);
+	job.bucket_of = DATALIB_ALLOC(n);
+	job.counts = DATALIB_ALLOC(job.n_chunks * SORT_MAX_BUCKETS * sizeof(size_t));
+	job.bucket_start = DATALIB_ALLOC((SORT_MAX_BUCKETS + 1) * sizeof(size_t));
+	if(!samples || !job.tmp || !job.bucket_of || !job.counts || !job.bucket_start){
+		DATALIB_FREE(samples);
+		DATALIB_ALIGNED_FREE(job.tmp);
+		DATALIB_FREE(job.bucket_of);
+		DATALIB_FREE(job.counts);
+		DATALIB_FREE(job.bucket_start);
+		return 0;
+	}
+
+	/* Splitters are evenly spaced among sorted samples at pseudo-random positions.
+	   The positions use all 64 bits of the state, with the high bits folded into the low ones,
+	   whose period is short, so that they reach all the elements of arrays above 2^31. */
+	size_t i, b, c;
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	for(i = 0; i != n_samples; ++i){
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		uint64_t r = state ^ (state >> 32);
+		memcpy(samples + i * size, job.base + (size_t)(r % n) * size, size);
+	}
+	sort_buffer(samples, n_samples, size, cmp);
+
+	/* Repeated splitters are dropped. They show that some values fill more than a bucket,
+	   so the elements equal to each splitter are then put in a bucket of their own. */
+	job.n_splitters = 0;
+	job.equal_buckets = 0;
+	for(b = 1; b != n_parts; ++b){
+		const char* splitter = samples + (b * SORT_OVERSAMPLING) * size;
+		if(job.n_splitters > 0 && cmp(samples + (job.n_splitters - 1) * size, splitter) == 0){
+			job.equal_buckets = 1;
+			continue;
+		}
+		memmove(samples + job.n_splitters * size, splitter, size);
+		job.n_splitters++;
+	}
+	job.splitters = samples;
+	job.n_buckets = job.equal_buckets ? 2 * job.n_splitters + 1 : job.n_splitters + 1;
+	memset(job.counts, 0, job.n_chunks * job.n_buckets * sizeof(size_t));
+
+	threadpool_run(pool, job.n_chunks, sort_classify_task, &job);
+
+	/* Turns the counts into the offsets where each chunk writes into each bucket */
+	size_t offset = 0;
+	for(b = 0; b != job.n_buckets; ++b){
+		job.bucket_start[b] = offset;
+		for(c = 0; c != job.n_chunks; ++c){
+			size_t count = job.counts[c * job.n_buckets + b];
+			job.counts[c * job.n_buckets + b] = offset;
+			offset += count;
+		}
+	}
+	job.bucket_start[job.n_buckets] = offset;
+
+	threadpool_run(pool, job.n_chunks, sort_scatter_task, &job);
+	threadpool_run(pool, job.n_buckets, sort_bucket_task, &job);
+
+	DATALIB_FREE(samples);
+	DATALIB_ALIGNED_FREE(job.tmp);
+	DATALIB_FREE(job.bucket_of);
+	DATALIB_FREE(job.counts);
+	DATALIB_FREE(job.bucket_start);
+	return 1;
+}
@@ -0,0 +1,174 @@
+#include "strvec.h"
+
+
+/* Returns the offset of the first character of a string */
+static size_t strvec_offset(const strvec_t* strvec, size_t index){
+	return ((const size_t*)strvec->offsets.data)[index];
+}
+
+
+/* -- INITIALISATION -- */
+void* strvec_init(strvec_t* strvec){
+	if(!strvec) return NULL;
+	array_init(&strvec->bytes, sizeof(char));
+	array_init(&strvec->offsets, sizeof(size_t));
+	return strvec;
+}
+
+void strvec_uninit(strvec_t* strvec){
+	if(!strvec) return;
+	array_uninit(&strvec->bytes);
+	array_uninit(&strvec->offsets);
+}
+
+strvec_t* strvec_create(void){
+	strvec_t* strvec = DATALIB_ALLOC(sizeof(strvec_t));
+	if(!strvec) return NULL;
+	strvec_init(strvec);
+	return strvec;
+}
+
+void strvec_destroy(strvec_t* strvec){
+	if(!strvec) return;
+	strvec_uninit(strvec);
+	DATALIB_FREE(strvec);
+}
+
+
+/* -- RETRIEVALS -- */
+/* Returns the number of strings */
+size_t strvec_size(const strvec_t* strvec){
+	return strvec ? strvec->offsets.size : 0;
+}
+
+/* Returns the NUL-terminated string at the given index */
+const char* strvec_get(const strvec_t* strvec, size_t index){
+	if(!strvec || index >= strvec->offsets.size) return NULL;
+	return strvec->bytes.data + strvec_offset(strvec, index);
+}
+
+/* Returns the length of the string at the given index */
+size_t strvec_len(const strvec_t* strvec, size_t index){
+	if(!strvec || index >= strvec->offsets.size) return 0;
+	size_t end = index + 1 < strvec->offsets.size
+		? strvec_offset(strvec, index + 1)
+		: strvec->bytes.size;
+	return end - strvec_offset(strvec, index) - 1;
+}
+
+
+/* -- INSERTION -- */
+/* Appends a copy of a NUL-terminated string */
+strvec_t* strvec_push(strvec_t* strvec, const char* str){
+	if(!str) return NULL;
+	return strvec_pushn(strvec, str, strlen(str));
+}
+
+/* Returns whether a pointer points into the packed bytes of a strvec,
+   which move when they grow, and stores its offset in the bytes if it does */
+static int strvec_inner_offset(const strvec_t* strvec, const char* p, size_t* offset){
+	uintptr_t begin = (uintptr_t)strvec->bytes.data;
+	if(!p || !begin || (uintptr_t)p < begin || (uintptr_t)p >= begin + strvec->bytes.size) return 0;
+	*offset = (size_t)((uintptr_t)p - begin);
+	return 1;
+}
+
+/* Appends a copy of the first `length` characters of a string */
+strvec_t* strvec_pushn(strvec_t* strvec, const char* str, size_t length){
+	if(!strvec || (!str && length > 0) || length == SIZE_MAX) return NULL;
+
+	/* A string of the strvec itself is found again after the bytes grow */
+	size_t inner;
+	int is_inner = strvec_inner_offset(strvec, str, &inner);
+	size_t offset = strvec->bytes.size;
+	if(!array_resize(&strvec->bytes, offset + length + 1)) return NULL;
+	if(!array_push_back(&strvec->offsets, &offset)){
+		array_resize(&strvec->bytes, offset);
+		return NULL;
+	}
+	if(is_inner) str = strvec->bytes.data + inner;
+	if(length > 0) memcpy(strvec->bytes.data + offset, str, length);
+	strvec->bytes.data[offset + length] = '\0';
+	return strvec;
+}
+
+/* Appends the strings of a text separated by a delimiter */
+strvec_t* strvec_from_text(strvec_t* strvec, const char* text, size_t length, char delimiter){
+	if(!strvec || (!text && length > 0)) return NULL;
+	if(length == 0) return strvec;
+
+	/* A missing delimiter at the end is replaced by a terminator */
+	size_t bytes = length + (text[length - 1] != delimiter);
+	size_t base = strvec->bytes.size;
+	size_t n_strings = strvec->offsets.size;
+	size_t inner;
+	int is_inner = strvec_inner_offset(strvec, text, &inner);
+	if(bytes > SIZE_MAX - base || !array_resize(&strvec->bytes, base + bytes)) return NULL;
+	if(is_inner) text = strvec->bytes.data + inner;
+
+	char* data = strvec->bytes.data + base;
+	memcpy(data, text, length);
+	data[bytes - 1] = delimiter;
+
+	/* Each delimiter ends a string */
+	size_t start = 0;
+	while(start < bytes){
+		char* end = memchr(data + start, delimiter, bytes - start);
+		size_t offset = base + start;
+		if(!array_push_back(&strvec->offsets, &offset)){
+			array_resize(&strvec->offsets, n_strings);
+			array_resize(&strvec->bytes, base);
+			return NULL;
+		}
+		*end = '\0';
+		start = (size_t)(end - data) + 1;
+	}
+	return strvec;
+}
+
+
+/* -- REMOVAL -- */
+/* Removes the last string */
+strvec_t* strvec_pop_back(strvec_t* strvec){
+	if(!strvec || strvec->offsets.size == 0) return NULL;
+	size_t offset = strvec_offset(strvec, strvec->offsets.size - 1);
+	array_pop_back(&strvec->offsets);
+	array_resize(&strvec->bytes, offset);
+	return strvec;
+}
+
+/* Removes all strings */
+strvec_t* strvec_clear(strvec_t* strvec){
+	if(!strvec) return NULL;
+	array_clear(&strvec->bytes);
+	array_clear(&strvec->offsets);
+	return strvec;
+}
+
+
+/* -- SLICING -- */
+/* Returns a new string vector with copies of the strings in `[begin, end)` */
+strvec_t* strvec_slice(const strvec_t* strvec, size_t begin, size_t end){
+	if(!strvec || begin > end || end > strvec->offsets.size) return NULL;
+
+	strvec_t* slice = strvec_create();
+	if(!slice || begin == end) return slice;
+
+	size_t first = strvec_offset(strvec, begin);
+	size_t last = end < strvec->offsets.size ? strvec_offset(strvec, end) : strvec->bytes.size;
+	if(!array_push_back_n(&slice->bytes, strvec->bytes.data + first, last - first)){
+		strvec_destroy(slice);
+		return NULL;
+	}
+	if(!array_resize(&slice->offsets, end - begin)){
+		strvec_destroy(slice);
+		return NULL;
+	}
+
+	/* Offsets are rebased to the start of the copied characters */
+	size_t i;
+	for(i = begin; i != end; ++i){
+		array_at_as(&slice->offsets, size_t, i - begin) = strvec_offset(strvec, i) - first;
+	}
+	return slice;
+}
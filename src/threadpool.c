@@ -0,0 +1,214 @@
+#include "threadpool.h"
+
+#ifdef DATALIB_HAS_THREADS
+	#include <pthread.h>
+	#include <unistd.h> /* sysconf */
+#endif
+
+struct threadpool {
+	size_t n_threads;				/* Threads that run tasks, including the caller */
+#ifdef DATALIB_HAS_THREADS
+	pthread_t* workers;				/* The `n_threads - 1` worker threads */
+	pthread_mutex_t lock;			/* Guards the job state below */
+	pthread_cond_t job_ready;		/* Signals a new job or shutdown to the workers */
+	pthread_cond_t job_done;		/* Signals the caller that all tasks finished */
+	pthread_mutex_t run_lock;		/* Serialises jobs submitted from several threads */
+	void (*fn)(size_t, void*);		/* Function of the current job */
+	void* args;						/* Argument of the current job */
+	size_t n_tasks;					/* Number of tasks of the current job */
+	size_t next_task;				/* Next task to claim */
+	size_t finished;				/* Number of finished tasks */
+	const struct threadpool_frame* frames;	/* Pools of the thread that submitted the current job */
+	size_t generation;				/* Incremented on every job */
+	int shutdown;					/* Set to stop the workers */
+#endif
+};
+
+
+#ifdef DATALIB_HAS_THREADS
+
+/* Pools whose tasks a thread is running, innermost first.
+   The tasks of a job inherit the pools of the thread that submitted it,
+   so that a job submitted from a task to any of these pools, which would wait
+   for the job that is waiting for it, runs on the calling thread instead. */
+struct threadpool_frame {
+	const threadpool_t* pool;
+	const struct threadpool_frame* parent;
+};
+
+static pthread_key_t threadpool_frames_key;
+static pthread_once_t threadpool_frames_once = PTHREAD_ONCE_INIT;
+
+static void threadpool_frames_create(void){
+	pthread_key_create(&threadpool_frames_key, NULL);
+}
+
+static const struct threadpool_frame* threadpool_frames(void){
+	pthread_once(&threadpool_frames_once, threadpool_frames_create);
+	return pthread_getspecific(threadpool_frames_key);
+}
+
+/* Returns whether the calling thread runs a task of a job of the pool, or of a job submitted from one */
+static int threadpool_is_running(const threadpool_t* pool){
+	const struct threadpool_frame* frame;
+	for(frame = threadpool_frames(); frame; frame = frame->parent){
+		if(frame->pool == pool) return 1;
+	}
+	return 0;
+}
+
+/* Claims and runs tasks of the current job until there are none left.
+   Must be called with the lock held, and returns with the lock held. */
+static void threadpool_work(threadpool_t* pool){
+	const struct threadpool_frame* saved = threadpool_frames();
+	struct threadpool_frame frame = {pool, pool->frames};
+	pthread_setspecific(threadpool_frames_key, &frame);
+	while(pool->next_task < pool->n_tasks){
+		size_t task = pool->next_task++;
+		pthread_mutex_unlock(&pool->lock);
+		pool->fn(task, pool->args);
+		pthread_mutex_lock(&pool->lock);
+		if(++pool->finished == pool->n_tasks){
+			pthread_cond_signal(&pool->job_done);
+		}
+	}
+	pthread_setspecific(threadpool_frames_key, saved);
+}
+
+/* Main loop of a worker thread */
+static void* threadpool_worker(void* arg){
+	threadpool_t* pool = arg;
+	size_t seen = 0;
+	pthread_mutex_lock(&pool->lock);
+	for(;;){
+		while(!pool->shutdown && pool->generation == seen){
+			pthread_cond_wait(&pool->job_ready, &pool->lock);
+		}
+		if(pool->shutdown) break;
+		seen = pool->generation;
+		threadpool_work(pool);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+#endif
+
+
+/* Creates a pool that runs tasks on `n_threads` threads */
+threadpool_t* threadpool_create(size_t n_threads){
+	threadpool_t* pool = DATALIB_ALLOC(sizeof(threadpool_t));
+	if(!pool) return NULL;
+	*pool = (threadpool_t){0};
+
+#ifdef DATALIB_HAS_THREADS
+	if(n_threads == 0){
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n_threads = cpus > 0 ? (size_t)cpus : 1;
+	}
+	pool->n_threads = n_threads;
+	pool->workers = DATALIB_ALLOC(n_threads * sizeof(pthread_t));
+	if(!pool->workers){
+		DATALIB_FREE(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_mutex_init(&pool->run_lock, NULL);
+	pthread_cond_init(&pool->job_ready, NULL);
+	pthread_cond_init(&pool->job_done, NULL);
+
+	size_t i;
+	for(i = 0; i + 1 < n_threads; ++i){
+		if(pthread_create(&pool->workers[i], NULL, threadpool_worker, pool) != 0){
+			/* Runs with the workers that could be started */
+			pool->n_threads = i + 1;
+			break;
+		}
+	}
+#else
+	pool->n_threads = 1;
+#endif
+	return pool;
+}
+
+/* Stops the workers of a pool and frees it */
+void threadpool_destroy(threadpool_t* pool){
+	if(!pool) return;
+#ifdef DATALIB_HAS_THREADS
+	pthread_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->job_ready);
+	pthread_mutex_unlock(&pool->lock);
+
+	size_t i;
+	for(i = 0; i + 1 < pool->n_threads; ++i){
+		pthread_join(pool->workers[i], NULL);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_mutex_destroy(&pool->run_lock);
+	pthread_cond_destroy(&pool->job_ready);
+	pthread_cond_destroy(&pool->job_done);
+	DATALIB_FREE(pool->workers);
+#endif
+	DATALIB_FREE(pool);
+}
+
+/* Returns the number of threads that run tasks */
+size_t threadpool_size(threadpool_t* pool){
+	if(!pool) return 1;
+	return pool->n_threads;
+}
+
+#ifdef DATALIB_HAS_THREADS
+static threadpool_t* threadpool_default_pool = NULL;
+static pthread_once_t threadpool_default_once = PTHREAD_ONCE_INIT;
+
+static void threadpool_default_create(void){
+	threadpool_default_pool = threadpool_create(0);
+}
+#endif
+
+/* Returns a pool shared by the library */
+threadpool_t* threadpool_default(void){
+#ifdef DATALIB_HAS_THREADS
+	pthread_once(&threadpool_default_once, threadpool_default_create);
+	return threadpool_default_pool;
+#else
+	return NULL;
+#endif
+}
+
+/* Runs `fn(task, args)` for every task and waits for them to finish */
+void threadpool_run(threadpool_t* pool, size_t n_tasks,
+                    void (*fn)(size_t task, void* args), void* args){
+	if(!fn || n_tasks == 0) return;
+
+#ifdef DATALIB_HAS_THREADS
+	if(pool && pool->n_threads > 1 && n_tasks > 1 && !threadpool_is_running(pool)){
+		const struct threadpool_frame* frames = threadpool_frames();
+		pthread_mutex_lock(&pool->run_lock);
+		pthread_mutex_lock(&pool->lock);
+		pool->fn = fn;
+		pool->args = args;
+		pool->frames = frames;
+		pool->n_tasks = n_tasks;
+		pool->next_task = 0;
+		pool->finished = 0;
+		pool->generation++;
+		pthread_cond_broadcast(&pool->job_ready);
+
+		threadpool_work(pool);
+		while(pool->finished != pool->n_tasks){
+			pthread_cond_wait(&pool->job_done, &pool->lock);
+		}
+		pthread_mutex_unlock(&pool->lock);
+		pthread_mutex_unlock(&pool->run_lock);
+		return;
+	}
+#endif
+
+	size_t task;
+	for(task = 0; task != n_tasks; ++task){
+		fn(task, args);
+	}
+}
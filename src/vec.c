@@ -1,4 +1,21 @@
+/* MAP_ANONYMOUS is not declared in strict C modes without these */
+#define _DEFAULT_SOURCE
+#ifdef __APPLE__
+    #define _DARWIN_C_SOURCE
+#endif
+
 #include "vec.h"
+#include "sort.h"
+
+#ifdef DATALIB_HAS_MMAP
+    #include <fcntl.h>    /* open */
+    #include <unistd.h>   /* close, sysconf */
+    #include <sys/mman.h> /* mmap */
+    #include <sys/stat.h> /* fstat */
+    #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+        #define MAP_ANONYMOUS MAP_ANON
+    #endif
+#endif
 
 
 /* Header of a vector where its metadata is stored */
@@ -8,6 +25,24 @@ struct vec_header {
     char data[];     /* Pointer to stored elements */
 };
 
+/* Bytes reserved before the first element.
+ * The header is padded so that the elements start on an aligned boundary.
+ */
+#define VEC_HEADER_SIZE DATALIB_ALIGN_UP(sizeof(struct vec_header))
+
+/* Allocates a vector block able to hold `bytes` of elements and returns its header */
+static struct vec_header* _vec_alloc_header(size_t bytes){
+    char* block = DATALIB_ALIGNED_ALLOC(VEC_HEADER_SIZE + bytes);
+    if(!block) return NULL;
+    return (struct vec_header*)(block + VEC_HEADER_SIZE) - 1;
+}
+
+/* Frees the block that holds a vector header */
+static void _vec_free_header(struct vec_header* header){
+    if(!header) return;
+    DATALIB_ALIGNED_FREE(header->data - VEC_HEADER_SIZE);
+}
+
 /* Returns the header of a vector `vec` */
 static struct vec_header* _vec_get_header(void* vec){
     if (!vec) return NULL;
@@ -49,7 +84,7 @@ void vec_clear(void* vec){
 
 /* Free an initialised vector `vec` */
 void vec_free(void* vec){
-    DATALIB_FREE(_vec_get_header(vec));
+    _vec_free_header(_vec_get_header(vec));
 }
 
 /* Removes the last element of a vector `vec` */
@@ -70,7 +105,7 @@ void* _vec_extend(void* vec, size_t item_size, size_t capacity){
 	struct vec_header* header;
 
     if(!vec){
-        header = DATALIB_ALLOC(capacity*item_size+sizeof(*header));
+        header = _vec_alloc_header(capacity*item_size);
         if(!header) return NULL;
         header->size = 0;
         header->capacity = capacity;
@@ -84,13 +119,13 @@ void* _vec_extend(void* vec, size_t item_size, size_t capacity){
         return vec;
     }
 
-    struct vec_header* new_header = DATALIB_ALLOC(sizeof(struct vec_header) + capacity*item_size);
+    struct vec_header* new_header = _vec_alloc_header(capacity*item_size);
 	if(!new_header) return NULL;
     new_header->size = header->size;
     new_header->capacity = capacity;
 
     DATALIB_MEMMOVE(new_header->data, header->data, new_header->size*item_size);
-    DATALIB_FREE(header);
+    _vec_free_header(header);
 
     return new_header->data;
 }
@@ -148,13 +183,56 @@ void _vec_delete(void* vec, size_t item_size, size_t index){
 
     struct vec_header* header = _vec_get_header(vec);
 
-    size_t src = index * item_size;
-    size_t dest = src + item_size;
+    size_t dest = index * item_size;
+    size_t src = dest + item_size;
     size_t n = (header->size - index - 1) * item_size;
     DATALIB_MEMMOVE(header->data + dest, header->data + src, n);
     header->size--;
 }
 
+/* Removes the item at index `index` from a vector `vec` by moving the last item into its place */
+void _vec_swap_remove(void* vec, size_t item_size, size_t index){
+    if(!vec || index >= vec_size(vec)) return;
+
+    struct vec_header* header = _vec_get_header(vec);
+    size_t last = header->size - 1;
+    if(index != last){
+        memcpy(header->data + index * item_size, header->data + last * item_size, item_size);
+    }
+    header->size--;
+}
+
+/* Keeps only the items of a vector `vec` that satisfy a predicate, calling it once per item.
+ * A run of kept items is moved to the write cursor with a single `memmove`
+ * when the first removed item after it is found.
+ */
+size_t _vec_retain(void* vec, size_t item_size,
+                   int (*pred)(const void* item, void* args), void* args){
+    if(!vec || !pred) return 0;
+
+    struct vec_header* header = _vec_get_header(vec);
+    char* data = header->data;
+    size_t size = header->size;
+    size_t read, write = 0, run_start = 0;
+
+    for(read = 0; read != size; ++read){
+        if(pred(data + read * item_size, args)) continue;
+        /* The run before this item is moved, unless no item was removed before it */
+        if(write != run_start){
+            DATALIB_MEMMOVE(data + write * item_size, data + run_start * item_size, (read - run_start) * item_size);
+        }
+        write += read - run_start;
+        run_start = read + 1;
+    }
+    if(write != run_start){
+        DATALIB_MEMMOVE(data + write * item_size, data + run_start * item_size, (size - run_start) * item_size);
+    }
+    write += size - run_start;
+
+    header->size = write;
+    return size - write;
+}
+
 /* Makes a copy of a vector `vec` */
 void* _vec_copy(void* vec_, size_t item_size){
     char* vec = vec_;
@@ -170,3 +248,80 @@ void* _vec_copy(void* vec_, size_t item_size){
     }
     return vec2;
 }
+
+/* Sorts a vector `vec` in ascending order */
+void _vec_sort(void* vec, size_t item_size, int (*cmp)(const void*, const void*)){
+    if(!vec) return;
+    sort_buffer(vec, vec_size(vec), item_size, cmp);
+}
+
+/* Returns the index of the first element not less than a key in a sorted vector `vec` */
+size_t _vec_lower_bound(void* vec, size_t item_size, const void* key,
+                        int (*cmp)(const void*, const void*)){
+    if(!vec) return 0;
+    return sort_lower_bound(vec, vec_size(vec), item_size, key, cmp);
+}
+
+/* Returns the index of the first element greater than a key in a sorted vector `vec` */
+size_t _vec_upper_bound(void* vec, size_t item_size, const void* key,
+                        int (*cmp)(const void*, const void*)){
+    if(!vec) return 0;
+    return sort_upper_bound(vec, vec_size(vec), item_size, key, cmp);
+}
+
+/* Maps a file as a read-only vector.
+ * One page is reserved before the file contents to hold the header,
+ * preceded by the total number of mapped bytes.
+ */
+void* _vec_map_file(const char* path, size_t item_size){
+#ifdef DATALIB_HAS_MMAP
+    if(!path || item_size == 0) return NULL;
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size % item_size != 0){
+        close(fd);
+        return NULL;
+    }
+
+    size_t bytes = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = page + bytes;
+    char* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED){
+        close(fd);
+        return NULL;
+    }
+    if(bytes > 0){
+        void* data = mmap(base + page, bytes, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0);
+        if(data == MAP_FAILED){
+            munmap(base, length);
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+
+    struct vec_header* header = (struct vec_header*)(base + page) - 1;
+    *((size_t*)header - 1) = length;
+    header->size = bytes / item_size;
+    header->capacity = header->size;
+    return header->data;
+#else
+    (void)path; (void)item_size;
+    return NULL;
+#endif
+}
+
+/* Unmaps a vector created with `vec_map_file` */
+void vec_unmap(void* vec){
+#ifdef DATALIB_HAS_MMAP
+    if(!vec) return;
+    struct vec_header* header = _vec_get_header(vec);
+    size_t length = *((size_t*)header - 1);
+    munmap((char*)vec - (size_t)sysconf(_SC_PAGESIZE), length);
+#else
+    (void)vec;
+#endif
+}
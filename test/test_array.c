@@ -1,6 +1,8 @@
 #include "stdio.h"
 #include "assert.h"
+#include "string.h"
 #include "array.h"
+#include "sort.h"
 
 void test_array_init(){
 	array_t a;
@@ -46,6 +48,31 @@ void test_array_resize(){
 	array_uninit(&a);
 }
 
+void test_array_alignment(){
+	array_t a;
+	array_init(&a, sizeof(char));
+	array_resize(&a, 3);
+	assert((uintptr_t)a.data % DATALIB_ALIGNMENT == 0);
+	array_resize(&a, 1000);
+	assert((uintptr_t)a.data % DATALIB_ALIGNMENT == 0);
+	array_uninit(&a);
+}
+
+void test_array_resize_overflow(){
+	array_t a;
+	array_init(&a, sizeof(double));
+	/* Byte count does not fit in a size_t */
+	void* r = array_resize(&a, SIZE_MAX / 4);
+	assert(!r);
+	assert(a.size == 0);
+	assert(!a.data);
+	array_resize(&a, 2);
+	r = array_insert_range(&a, NULL, SIZE_MAX - 1, 0);
+	assert(!r);
+	assert(a.size == 2);
+	array_uninit(&a);
+}
+
 void test_array_set(){
 	array_t a;
 	int r = 1;
@@ -118,6 +145,40 @@ void test_array_insert(){
 	array_uninit(&a);
 }
 
+void test_array_element_sizes(){
+	/* Specialised and generic element copies */
+	char src[24], out[24];
+	uint32_t sizes[] = {1, 2, 3, 4, 8, 16, 24};
+	size_t i, j;
+	for(i = 0; i != sizeof(sizes)/sizeof(sizes[0]); ++i){
+		array_t a;
+		array_init(&a, sizes[i]);
+		for(j = 0; j != sizes[i]; ++j) src[j] = (char)(j + 1);
+		array_push_back(&a, src);
+		array_insert(&a, NULL, 0);
+		array_set(&a, src, 0);
+		memcpy(out, array_get(&a, 1), sizes[i]);
+		assert(memcmp(out, src, sizes[i]) == 0);
+		assert(memcmp(array_get(&a, 0), src, sizes[i]) == 0);
+		array_uninit(&a);
+	}
+}
+
+void test_array_at(){
+	array_t a;
+	array_init(&a, sizeof(double));
+	array_resize(&a, 10);
+	int i;
+	for(i = 0; i != 10; ++i){
+		array_at_as(&a, double, i) = i * 0.5;
+	}
+	for(i = 0; i != 10; ++i){
+		assert(*(double*)array_get(&a, i) == i * 0.5);
+		assert(array_at(&a, i) == array_get(&a, i));
+	}
+	array_uninit(&a);
+}
+
 void test_array_insert_wrong_index(){
 	array_t a;
 	array_init(&a, sizeof(int));
@@ -127,6 +188,15 @@ void test_array_insert_wrong_index(){
 void test_array_push_back(){
 	array_t a;
 	array_init(&a, sizeof(int));
+	int i;
+	for(i = 0; i != 100; ++i){
+		assert(array_push_back(&a, &i));
+	}
+	assert(a.size == 100);
+	assert(a.capacity == 128);
+	for(i = 0; i != 100; ++i){
+		assert(*(int*)array_get(&a, i) == i);
+	}
 	array_uninit(&a);
 }
 
@@ -137,14 +207,285 @@ void test_array_push_front(){
 }
 
 void test_array_remove(){
+	int vals[] = {0, 1, 2, 3};
+	array_t* a = array_from_data(vals, 4, sizeof(int));
+	assert(array_remove(a, 1));
+	assert(a->size == 3);
+	assert(*(int*)array_get(a, 0) == 0);
+	assert(*(int*)array_get(a, 1) == 2);
+	assert(*(int*)array_get(a, 2) == 3);
+	assert(!array_remove(a, 3));
+	array_destroy(a);
+}
+
+void test_array_remove_empty(){
 	array_t a;
 	array_init(&a, sizeof(int));
 	array_uninit(&a);
 }
 
-void test_array_remove_empty(){
+void test_array_swap_remove(){
 	array_t a;
 	array_init(&a, sizeof(int));
+	int i;
+	for(i = 0; i != 5; ++i) array_push_back(&a, &i);
+	assert(array_swap_remove(&a, 1) == &a);
+	assert(a.size == 4);
+	assert(array_at_as(&a, int, 1) == 4);
+	assert(array_at_as(&a, int, 3) == 3);
+	assert(array_swap_remove(&a, 3) == &a);
+	assert(a.size == 3);
+	assert(array_swap_remove(&a, 3) == NULL);
+	array_uninit(&a);
+}
+
+int test_array_is_even(const void* element, void* args){
+	(void)args;
+	return *(const int*)element % 2 == 0;
+}
+
+int test_array_first_ten(const void* element, void* args){
+	(void)element;
+	return (*(size_t*)args)++ < 10;
+}
+
+void test_array_retain(){
+	array_t a;
+	array_init(&a, sizeof(int));
+	int i;
+	for(i = 0; i != 101; ++i) array_push_back(&a, &i);
+	assert(array_retain(&a, test_array_is_even, NULL) == 50);
+	assert(a.size == 51);
+	for(i = 0; i != 51; ++i){
+		assert(array_at_as(&a, int, i) == i * 2);
+	}
+	assert(array_retain(&a, test_array_is_even, NULL) == 0);
+	assert(a.size == 51);
+
+	/* A stateful predicate sees every element once: keep the first 10 */
+	size_t calls = 0;
+	assert(array_retain(&a, test_array_first_ten, &calls) == 41);
+	assert(calls == 51 && a.size == 10);
+	for(i = 0; i != 10; ++i){
+		assert(array_at_as(&a, int, i) == i * 2);
+	}
+	array_uninit(&a);
+}
+
+void test_array_from_data(){
+	int vals[] = {4, 5, 6};
+	array_t* a = array_from_data(vals, 3, sizeof(int));
+	assert(a);
+	assert(a->size == 3);
+	assert(a->element_size == sizeof(int));
+	assert(memcmp(a->data, vals, sizeof(vals)) == 0);
+	array_destroy(a);
+
+	a = array_from_data(NULL, 3, sizeof(int));
+	assert(a);
+	assert(a->size == 0);
+	array_destroy(a);
+}
+
+void test_array_insert_range(){
+	int vals[] = {0, 1, 2, 3};
+	int block[] = {10, 11, 12};
+	int expected[] = {0, 1, 10, 11, 12, 2, 3};
+	array_t* a = array_from_data(vals, 4, sizeof(int));
+	assert(array_insert_range(a, block, 3, 2));
+	assert(a->size == 7);
+	assert(memcmp(a->data, expected, sizeof(expected)) == 0);
+	assert(!array_insert_range(a, block, 3, 8));
+	assert(array_insert_range(a, NULL, 2, 0));
+	assert(a->size == 9);
+	assert(*(int*)array_get(a, 0) == 0 && *(int*)array_get(a, 1) == 0);
+	assert(*(int*)array_get(a, 2) == 0 && *(int*)array_get(a, 3) == 1);
+	array_destroy(a);
+}
+
+void test_array_push_back_n(){
+	array_t a;
+	array_init(&a, sizeof(int));
+	int block[100];
+	int i;
+	for(i = 0; i != 100; ++i) block[i] = i;
+	assert(array_push_back_n(&a, block, 60));
+	assert(array_push_back_n(&a, block + 60, 40));
+	assert(a.size == 100);
+	assert(a.capacity == 128);
+	assert(memcmp(a.data, block, sizeof(block)) == 0);
+	array_uninit(&a);
+}
+
+void test_array_insert_own(){
+	array_t a;
+	array_init(&a, sizeof(int));
+	int vals[] = {0, 1, 2, 3, 4, 5};
+	int straddle[] = {0, 1, 1, 2, 2, 3, 4, 5};
+	int twice[] = {0, 1, 2, 3, 0, 1, 2, 3};
+
+	/* The source straddles the index, without growing */
+	assert(array_push_back_n(&a, vals, 6));
+	assert(a.capacity == 8);
+	assert(array_insert_range(&a, (int*)a.data + 1, 2, 2));
+	assert(a.size == 8 && memcmp(a.data, straddle, sizeof(straddle)) == 0);
+
+	/* The whole array, read again after growing */
+	array_uninit(&a);
+	array_init(&a, sizeof(int));
+	assert(array_push_back_n(&a, vals, 4));
+	assert(a.capacity == 4);
+	assert(array_push_back_n(&a, a.data, a.size));
+	assert(a.size == 8 && memcmp(a.data, twice, sizeof(twice)) == 0);
+	assert(array_insert_range(&a, (int*)a.data + 4, 4, 0));
+	assert(a.size == 12 && memcmp((int*)a.data + 4, twice, sizeof(twice)) == 0);
+	assert(memcmp(a.data, vals, 4 * sizeof(int)) == 0);
+	array_uninit(&a);
+}
+
+void test_array_remove_range(){
+	int vals[] = {0, 1, 2, 3, 4, 5};
+	int expected[] = {0, 4, 5};
+	array_t* a = array_from_data(vals, 6, sizeof(int));
+	assert(!array_remove_range(a, 4, 3));
+	assert(array_remove_range(a, 1, 3));
+	assert(a->size == 3);
+	assert(memcmp(a->data, expected, sizeof(expected)) == 0);
+	assert(array_remove_range(a, 1, 2));
+	assert(a->size == 1);
+	assert(array_remove_range(a, 0, 0));
+	assert(a->size == 1);
+	array_destroy(a);
+}
+
+void test_array_map_file(){
+#ifdef DATALIB_HAS_MMAP
+	const char* path = "test_array_map_file.bin";
+	remove(path);
+
+	array_t a;
+	assert(array_map_file(&a, path, sizeof(int)));
+	assert(a.size == 0);
+	int i;
+	for(i = 0; i != 1000; ++i){
+		assert(array_push_back(&a, &i));
+	}
+	assert(array_advise(&a, ARRAY_ADVICE_SEQUENTIAL));
+	assert(array_sync(&a));
+	assert(a.capacity == 1000);
+
+	/* The synced file holds exactly the elements, and the array still grows */
+	FILE* f = fopen(path, "rb");
+	assert(f && fseek(f, 0, SEEK_END) == 0 && ftell(f) == 1000 * (long)sizeof(int));
+	fclose(f);
+	i = 1000;
+	assert(array_push_back(&a, &i) && array_pop_back(&a));
+	array_uninit(&a);
+
+	/* The file keeps exactly the elements of the array */
+	assert(array_map_file(&a, path, sizeof(int)));
+	assert(a.size == 1000);
+	for(i = 0; i != 1000; ++i){
+		assert(*(int*)array_get(&a, i) == i);
+	}
+	array_uninit(&a);
+
+	assert(!array_map_file(&a, path, 3 * sizeof(int)));
+	assert(!array_sync(&a));
+	remove(path);
+#endif
+}
+
+int test_array_cmp_int(const void* a, const void* b){
+	int x = *(const int*)a, y = *(const int*)b;
+	return (x > y) - (x < y);
+}
+
+#define test_array_less_int(a, b) ((a) < (b))
+SORT_DEFINE(test_array_sort_ints, int, test_array_less_int)
+
+void test_array_sort(){
+	array_t a;
+	array_init(&a, sizeof(int));
+	int i;
+	for(i = 0; i != 1000; ++i){
+		int v = (i * 7919) % 1000 / 2; /* each value twice */
+		array_push_back(&a, &v);
+	}
+	assert(array_sort(&a, test_array_cmp_int));
+	for(i = 0; i != 1000; ++i){
+		assert(array_at_as(&a, int, i) == i / 2);
+	}
+
+	int key = 100, missing = 5000;
+	assert(array_lower_bound(&a, &key, test_array_cmp_int) == 200);
+	assert(array_upper_bound(&a, &key, test_array_cmp_int) == 202);
+	assert(array_lower_bound(&a, &missing, test_array_cmp_int) == a.size);
+
+	for(i = 0; i != 1000; ++i){
+		array_at_as(&a, int, i) = 1000 - i;
+	}
+	test_array_sort_ints((int*)a.data, a.size);
+	for(i = 0; i != 1000; ++i){
+		assert(array_at_as(&a, int, i) == i + 1);
+	}
+	array_uninit(&a);
+}
+
+void test_array_sort_odd_element_size(){
+	struct rec { int key; char tag[8]; };
+	array_t a;
+	array_init(&a, sizeof(struct rec));
+	int i;
+	for(i = 0; i != 100; ++i){
+		struct rec r = {99 - i, "abcdefg"};
+		array_push_back(&a, &r);
+	}
+	array_sort(&a, test_array_cmp_int);
+	for(i = 0; i != 100; ++i){
+		assert(((struct rec*)array_get(&a, i))->key == i);
+	}
+	array_uninit(&a);
+}
+
+void test_array_sort_parallel(){
+	array_t a;
+	array_init(&a, sizeof(int));
+	int i, n = SORT_PARALLEL_THRESHOLD * 2;
+	for(i = 0; i != n; ++i){
+		int v = (int)(((unsigned)i * 2654435761u) % (unsigned)n) / 4; /* duplicates */
+		array_push_back(&a, &v);
+	}
+	threadpool_t* pool = threadpool_create(3);
+	assert(pool);
+	assert(threadpool_size(pool) == 3);
+	assert(array_sort_parallel(&a, test_array_cmp_int, pool));
+	assert(a.size == (size_t)n);
+	for(i = 1; i != n; ++i){
+		assert(array_at_as(&a, int, i - 1) <= array_at_as(&a, int, i));
+	}
+	/* Sorted input and the default pool */
+	assert(array_sort_parallel(&a, test_array_cmp_int, NULL));
+	for(i = 1; i != n; ++i){
+		assert(array_at_as(&a, int, i - 1) <= array_at_as(&a, int, i));
+	}
+
+	/* Few distinct values, then a single one, fill the buckets of equal elements */
+	for(i = 0; i != n; ++i){
+		array_at_as(&a, int, i) = (n - i) % 3;
+	}
+	assert(array_sort_parallel(&a, test_array_cmp_int, pool));
+	for(i = 0; i != n; ++i){
+		assert(array_at_as(&a, int, i) == (i < n / 3 ? 0 : i < 2 * n / 3 ? 1 : 2));
+	}
+	for(i = 0; i != n; ++i){
+		array_at_as(&a, int, i) = 7;
+	}
+	assert(array_sort_parallel(&a, test_array_cmp_int, pool));
+	for(i = 0; i != n; ++i){
+		assert(array_at_as(&a, int, i) == 7);
+	}
+	threadpool_destroy(pool);
 	array_uninit(&a);
 }
 
@@ -167,15 +508,30 @@ void test_array_run_all(){
 	test_array_create();
 	test_array_create_zero_element_size();
 	test_array_resize();
+	test_array_alignment();
+	test_array_resize_overflow();
 	test_array_set();
 	test_array_set_out_of_bounds();
 	test_array_get();
 	test_array_get_out_of_bounds();
 	test_array_insert();
+	test_array_element_sizes();
+	test_array_at();
 	test_array_insert_wrong_index();
 	test_array_push_back();
 	test_array_push_front();
 	test_array_remove();
+	test_array_swap_remove();
+	test_array_retain();
+	test_array_from_data();
+	test_array_insert_range();
+	test_array_push_back_n();
+	test_array_insert_own();
+	test_array_remove_range();
+	test_array_map_file();
+	test_array_sort();
+	test_array_sort_odd_element_size();
+	test_array_sort_parallel();
 	test_array_pop_back();
 	test_array_pop_front();
 
@@ -0,0 +1,189 @@
+#include "stdio.h"
+#include "assert.h"
+#include "string.h"
+#include "art.h"
+
+/* Path-like keys sharing long prefixes, with some keys prefixes of others */
+static uint32_t test_art_key(char* buffer, int i){
+	if(i % 10 == 0) return (uint32_t)sprintf(buffer, "/srv/data/%d", i / 10);
+	return (uint32_t)sprintf(buffer, "/srv/data/%d/file-%d.txt", i / 10, i % 10);
+}
+
+void test_art_init(){
+	art_t t;
+	assert(art_init(&t) == &t);
+	assert(t.size == 0);
+	assert(!art_getb(&t, "a", 1));
+	assert(!art_removeb(&t, "a", 1));
+	uint32_t n = 5;
+	assert(!art_longest_prefix(&t, "a", 1, &n));
+	assert(n == 0);
+	art_uninit(&t);
+}
+
+void test_art_set_get(){
+	art_t* t = art_create();
+	static int values[20000];
+	char key[64];
+	int i, n = 20000;
+	for(i = 0; i != n; ++i){
+		int k = (int)(((unsigned)i * 7919u) % (unsigned)n);
+		values[k] = k;
+		assert(art_setb(t, key, test_art_key(key, k), &values[k]));
+	}
+	assert(t->size == (size_t)n);
+	for(i = 0; i != n; ++i){
+		int* v = art_getb(t, key, test_art_key(key, i));
+		assert(v && *v == i);
+	}
+	assert(!art_getb(t, "/srv/data", 9));
+	assert(!art_getb(t, "/srv/data/1/file-1.tx", 21));
+	assert(!art_getb(t, "/srv/data/1/file-1.txtx", 23));
+
+	int other = -1;
+	assert(art_setb(t, key, test_art_key(key, 15), &other));
+	assert(*(int*)art_getb(t, key, test_art_key(key, 15)) == -1);
+	assert(t->size == (size_t)n);
+	art_destroy(t);
+}
+
+void test_art_byte_keys(){
+	art_t t;
+	art_init(&t);
+	int a = 1, b = 2, c = 3, d = 4;
+	assert(art_setb(&t, "", 0, &a));
+	assert(art_setb(&t, "ab", 2, &b));
+	assert(art_setb(&t, "a\0b", 3, &c));
+	assert(art_setb(&t, "a", 1, &d));
+	assert(t.size == 4);
+	assert(*(int*)art_getb(&t, "", 0) == 1);
+	assert(*(int*)art_getb(&t, "ab", 2) == 2);
+	assert(*(int*)art_getb(&t, "a\0b", 3) == 3);
+	assert(*(int*)art_getb(&t, "a", 1) == 4);
+	assert(!art_getb(&t, "a\0", 2));
+
+	/* Every byte value as a branch */
+	static unsigned char keys[256][2];
+	int i;
+	for(i = 0; i != 256; ++i){
+		keys[i][0] = 'z';
+		keys[i][1] = (unsigned char)i;
+		assert(art_setb(&t, keys[i], 2, keys[i]));
+	}
+	for(i = 0; i != 256; ++i){
+		assert(art_getb(&t, keys[i], 2) == keys[i]);
+	}
+	for(i = 0; i != 256; ++i){
+		assert(art_removeb(&t, keys[i], 2) == keys[i]);
+	}
+	assert(t.size == 4);
+	assert(*(int*)art_getb(&t, "a\0b", 3) == 3);
+	art_uninit(&t);
+}
+
+void test_art_remove(){
+	art_t t;
+	art_init(&t);
+	static int values[5000];
+	char key[64];
+	int i, n = 5000;
+	for(i = 0; i != n; ++i){
+		values[i] = i;
+		art_setb(&t, key, test_art_key(key, i), &values[i]);
+	}
+	for(i = 0; i != n; ++i){
+		uint32_t len = test_art_key(key, i);
+		if(i % 7){
+			assert(*(int*)art_removeb(&t, key, len) == i);
+			assert(!art_removeb(&t, key, len));
+		}
+	}
+	for(i = 0; i != n; ++i){
+		int* v = art_getb(&t, key, test_art_key(key, i));
+		assert(i % 7 ? !v : v && *v == i);
+	}
+	for(i = 0; i < n; i += 7){
+		assert(art_removeb(&t, key, test_art_key(key, i)));
+	}
+	assert(t.size == 0);
+	assert(!t.root);
+	art_uninit(&t);
+}
+
+struct test_art_collect {
+	char keys[128][64];
+	int n;
+};
+
+int test_art_collect_key(const void* key, uint32_t key_length, void* value, void* args){
+	struct test_art_collect* c = args;
+	(void)value;
+	memcpy(c->keys[c->n], key, key_length);
+	c->keys[c->n][key_length] = '\0';
+	c->n++;
+	return c->n < 128;
+}
+
+void test_art_foreach_prefix(){
+	art_t t;
+	art_init(&t);
+	char key[64];
+	int i;
+	for(i = 0; i != 2000; ++i){
+		art_setb(&t, key, test_art_key(key, i), NULL);
+	}
+
+	static struct test_art_collect c;
+	c.n = 0;
+	assert(art_foreach_prefix(&t, "/srv/data/12", 12, test_art_collect_key, &c) == 110);
+	/* "/srv/data/12" and its files, then "/srv/data/120" to "/srv/data/129" and their files */
+	assert(strcmp(c.keys[0], "/srv/data/12") == 0);
+	assert(strcmp(c.keys[1], "/srv/data/12/file-1.txt") == 0);
+	assert(strcmp(c.keys[9], "/srv/data/12/file-9.txt") == 0);
+	assert(strcmp(c.keys[10], "/srv/data/120") == 0);
+	assert(strcmp(c.keys[11], "/srv/data/120/file-1.txt") == 0);
+	assert(strcmp(c.keys[100], "/srv/data/129") == 0);
+
+	c.n = 0;
+	assert(art_foreach_prefix(&t, "/srv/data/12/file-3", 19, test_art_collect_key, &c) == 1);
+	assert(strcmp(c.keys[0], "/srv/data/12/file-3.txt") == 0);
+	c.n = 0;
+	assert(art_foreach_prefix(&t, "/srv/data/12/file-3.txt!", 24, test_art_collect_key, &c) == 0);
+	assert(art_foreach_prefix(&t, "/srv/x", 6, test_art_collect_key, &c) == 0);
+
+	/* Stops when the callback returns zero */
+	c.n = 0;
+	assert(art_foreach_prefix(&t, "", 0, test_art_collect_key, &c) == 128);
+	for(i = 1; i != 128; ++i){
+		assert(strcmp(c.keys[i - 1], c.keys[i]) < 0);
+	}
+	art_uninit(&t);
+}
+
+void test_art_longest_prefix(){
+	art_t t;
+	art_init(&t);
+	int a = 1, b = 2, c = 3;
+	art_setb(&t, "/usr", 4, &a);
+	art_setb(&t, "/usr/lib", 8, &b);
+	art_setb(&t, "/usr/lib/x86", 12, &c);
+	uint32_t n;
+	assert(art_longest_prefix(&t, "/usr/local", 10, &n) == &a && n == 4);
+	assert(art_longest_prefix(&t, "/usr/lib/x8", 11, &n) == &b && n == 8);
+	assert(art_longest_prefix(&t, "/usr/lib/x86_64", 15, &n) == &c && n == 12);
+	assert(art_longest_prefix(&t, "/usr/lib/x86", 12, &n) == &c && n == 12);
+	assert(!art_longest_prefix(&t, "/us", 3, &n) && n == 0);
+	assert(!art_longest_prefix(&t, "/opt", 4, NULL));
+	art_uninit(&t);
+}
+
+void test_art_run_all(){
+	test_art_init();
+	test_art_set_get();
+	test_art_byte_keys();
+	test_art_remove();
+	test_art_foreach_prefix();
+	test_art_longest_prefix();
+
+	printf("art tests passed\n");
+}
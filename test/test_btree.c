@@ -0,0 +1,187 @@
+#include "stdio.h"
+#include "assert.h"
+#include "string.h"
+#include "btree.h"
+
+/* Keys share a 10-byte prefix, so that ordering depends on the bytes after the stored prefix */
+static uint32_t test_btree_key(char* buffer, int i){
+	return (uint32_t)sprintf(buffer, "key-shared%07d", i);
+}
+
+void test_btree_init(){
+	btree_t t;
+	assert(btree_init(&t) == &t);
+	assert(t.size == 0);
+	assert(!btree_get(&t, "a"));
+	assert(!btree_remove(&t, "a"));
+	btree_iter_t it = btree_begin(&t);
+	assert(!btree_iter_valid(&it));
+	btree_uninit(&t);
+}
+
+void test_btree_set_get(){
+	btree_t* t = btree_create();
+	static int values[20000];
+	char key[32];
+	int i, n = 20000;
+	for(i = 0; i != n; ++i){
+		int k = (int)(((unsigned)i * 7919u) % (unsigned)n);
+		values[k] = k;
+		uint32_t len = test_btree_key(key, k);
+		assert(btree_setb(t, key, len, &values[k]));
+	}
+	assert(t->size == (size_t)n);
+	for(i = 0; i != n; ++i){
+		uint32_t len = test_btree_key(key, i);
+		int* v = btree_getb(t, key, len);
+		assert(v && *v == i);
+	}
+	assert(!btree_getb(t, "key-shared", 10));
+
+	/* Replacing a value keeps the size */
+	int other = -1;
+	uint32_t len = test_btree_key(key, 5);
+	assert(btree_setb(t, key, len, &other));
+	assert(*(int*)btree_getb(t, key, len) == -1);
+	assert(t->size == (size_t)n);
+
+	/* Ordered iteration */
+	btree_iter_t it;
+	i = 0;
+	for(it = btree_begin(t); btree_iter_valid(&it); btree_next(&it)){
+		len = test_btree_key(key, i);
+		assert(it.key_length == len);
+		assert(memcmp(it.key, key, len) == 0);
+		i++;
+	}
+	assert(i == n);
+	btree_destroy(t);
+}
+
+void test_btree_byte_keys(){
+	btree_t t;
+	btree_init(&t);
+	int a = 1, b = 2, c = 3, d = 4;
+	assert(btree_setb(&t, "a", 1, &a));
+	assert(btree_setb(&t, "a\0", 2, &b));
+	assert(btree_setb(&t, "", 0, &c));
+	assert(btree_set(&t, "a", &d)); /* "a\0" */
+	assert(t.size == 3);
+	assert(*(int*)btree_getb(&t, "", 0) == 3);
+	assert(*(int*)btree_getb(&t, "a", 1) == 1);
+	assert(*(int*)btree_get(&t, "a") == 4);
+
+	btree_iter_t it = btree_begin(&t);
+	assert(it.key_length == 0);
+	btree_next(&it);
+	assert(it.key_length == 1);
+	btree_next(&it);
+	assert(it.key_length == 2);
+	btree_next(&it);
+	assert(!btree_iter_valid(&it));
+	btree_uninit(&t);
+}
+
+void test_btree_remove(){
+	btree_t t;
+	btree_init(&t);
+	static int values[5000];
+	char key[32];
+	int i, n = 5000;
+	for(i = 0; i != n; ++i){
+		values[i] = i;
+		btree_setb(&t, key, test_btree_key(key, i), &values[i]);
+	}
+	/* Remove all but multiples of 100 */
+	for(i = 0; i != n; ++i){
+		uint32_t len = test_btree_key(key, i);
+		if(i % 100){
+			assert(*(int*)btree_removeb(&t, key, len) == i);
+			assert(!btree_removeb(&t, key, len));
+		}
+	}
+	assert(t.size == 50);
+	btree_iter_t it;
+	i = 0;
+	for(it = btree_begin(&t); btree_iter_valid(&it); btree_next(&it)){
+		assert(*(int*)it.value == i * 100);
+		i++;
+	}
+	assert(i == 50);
+
+	/* Range scan over [1234, 2345) */
+	uint32_t len = test_btree_key(key, 1234);
+	int count = 0;
+	char end[32];
+	uint32_t end_length = test_btree_key(end, 2345);
+	for(it = btree_lower_bound(&t, key, len); btree_iter_valid(&it); btree_next(&it)){
+		if(memcmp(it.key, end, end_length) >= 0) break;
+		assert(*(int*)it.value == 1300 + count * 100);
+		count++;
+	}
+	assert(count == 11);
+
+	/* Reinsertion into sparse leaves */
+	for(i = 0; i != n; ++i){
+		btree_setb(&t, key, test_btree_key(key, i), &values[i]);
+	}
+	assert(t.size == (size_t)n);
+	for(i = 0; i != n; ++i){
+		assert(*(int*)btree_getb(&t, key, test_btree_key(key, i)) == i);
+	}
+	btree_uninit(&t);
+}
+
+void test_btree_load_sorted(){
+	static char storage[10000][24];
+	static const void* keys[10000];
+	static uint32_t lengths[10000];
+	static void* values[10000];
+	static int ints[10000];
+	int i, n = 10000;
+	for(i = 0; i != n; ++i){
+		lengths[i] = test_btree_key(storage[i], i);
+		keys[i] = storage[i];
+		ints[i] = i;
+		values[i] = &ints[i];
+	}
+
+	btree_t t;
+	btree_init(&t);
+	assert(btree_load_sortedb(&t, keys, lengths, values, (size_t)n));
+	assert(t.size == (size_t)n);
+	assert(!btree_load_sortedb(&t, keys, lengths, values, (size_t)n));
+	for(i = 0; i != n; ++i){
+		assert(*(int*)btree_getb(&t, keys[i], lengths[i]) == i);
+	}
+	btree_iter_t it = btree_lower_bound(&t, keys[9998], lengths[9998]);
+	assert(*(int*)it.value == 9998);
+	btree_next(&it);
+	btree_next(&it);
+	assert(!btree_iter_valid(&it));
+
+	/* Inserting after a bulk load splits the full nodes */
+	int extra = 42;
+	assert(btree_setb(&t, "key-shared0000000a", 18, &extra));
+	assert(*(int*)btree_getb(&t, "key-shared0000000a", 18) == 42);
+	assert(t.size == (size_t)n + 1);
+	btree_uninit(&t);
+
+	/* Unsorted input is rejected */
+	btree_init(&t);
+	keys[1] = storage[0];
+	lengths[1] = lengths[0];
+	assert(!btree_load_sortedb(&t, keys, lengths, values, (size_t)n));
+	assert(t.size == 0 && !t.root);
+	btree_uninit(&t);
+}
+
+void test_btree_run_all(){
+	test_btree_init();
+	test_btree_set_get();
+	test_btree_byte_keys();
+	test_btree_remove();
+	test_btree_load_sorted();
+
+	printf("btree tests passed\n");
+}
@@ -0,0 +1,194 @@
+#include "stdio.h"
+#include "assert.h"
+#include "deque.h"
+
+void test_deque_init(){
+	deque_t q;
+	void* r = deque_init(&q, sizeof(int));
+	assert(r == &q);
+	assert(q.size == 0);
+	assert(q.capacity == 0);
+	assert(q.element_size == sizeof(int));
+	assert(!q.data);
+	assert(!deque_front(&q));
+	assert(!deque_back(&q));
+	deque_uninit(&q);
+}
+
+void test_deque_init_zero_element_size(){
+	deque_t q;
+	void* r = deque_init(&q, 0);
+	assert(!r);
+	deque_uninit(&q);
+}
+
+void test_deque_push_back(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	int i;
+	for(i = 0; i != 5; ++i){
+		assert(deque_push_back(&q, &i));
+	}
+	assert(q.size == 5);
+	assert(q.capacity == 8);
+	assert(*(int*)deque_front(&q) == 0);
+	assert(*(int*)deque_back(&q) == 4);
+	for(i = 0; i != 5; ++i){
+		assert(*(int*)deque_get(&q, i) == i);
+	}
+	assert(!deque_get(&q, 5));
+	deque_uninit(&q);
+}
+
+void test_deque_push_front(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	int i;
+	for(i = 0; i != 5; ++i){
+		assert(deque_push_front(&q, &i));
+	}
+	assert(q.size == 5);
+	for(i = 0; i != 5; ++i){
+		assert(*(int*)deque_get(&q, i) == 4 - i);
+	}
+	assert(deque_push_front(&q, NULL));
+	assert(*(int*)deque_front(&q) == 0);
+	deque_uninit(&q);
+}
+
+void test_deque_pop(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	assert(!deque_pop_front(&q));
+	assert(!deque_pop_back(&q));
+	int i;
+	for(i = 0; i != 4; ++i){
+		deque_push_back(&q, &i);
+	}
+	assert(deque_pop_front(&q));
+	assert(deque_pop_back(&q));
+	assert(q.size == 2);
+	assert(*(int*)deque_front(&q) == 1);
+	assert(*(int*)deque_back(&q) == 2);
+	deque_clear(&q);
+	assert(q.size == 0);
+	deque_uninit(&q);
+}
+
+void test_deque_fifo_wrap(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	int i, next = 0;
+	/* Keeps the queue at 3 elements while the head wraps around the buffer */
+	for(i = 0; i != 3; ++i){
+		deque_push_back(&q, &i);
+	}
+	for(i = 3; i != 100; ++i){
+		deque_push_back(&q, &i);
+		assert(*(int*)deque_front(&q) == next++);
+		deque_pop_front(&q);
+	}
+	assert(q.capacity == 4);
+	assert(q.size == 3);
+	deque_uninit(&q);
+}
+
+void test_deque_grow_wrapped(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	int i;
+	for(i = 0; i != 4; ++i){
+		deque_push_back(&q, &i);
+	}
+	deque_pop_front(&q);
+	deque_pop_front(&q);
+	for(i = 4; i != 10; ++i){
+		deque_push_back(&q, &i);
+	}
+	assert(q.size == 8);
+	for(i = 0; i != 8; ++i){
+		assert(*(int*)deque_get(&q, i) == i + 2);
+	}
+	deque_uninit(&q);
+}
+
+void test_deque_push_own(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	int expected[] = {8, 2, 3, 4, 5, 2, 6, 7, 8};
+	int i;
+	for(i = 0; i != 4; ++i){
+		deque_push_back(&q, &i);
+	}
+	deque_pop_front_n(&q, 2);
+	for(i = 4; i != 6; ++i){
+		deque_push_back(&q, &i);
+	}
+
+	/* Elements of a full and wrapped deque are read again after it grows */
+	assert(q.size == q.capacity);
+	assert(deque_push_back(&q, deque_front(&q)));
+	for(i = 6; i != 9; ++i){
+		deque_push_back(&q, &i);
+	}
+	assert(q.size == q.capacity);
+	assert(deque_push_front(&q, deque_back(&q)));
+	assert(q.size == 9);
+	for(i = 0; i != 9; ++i){
+		assert(*(int*)deque_get(&q, i) == expected[i]);
+	}
+	deque_uninit(&q);
+}
+
+void test_deque_segments(){
+	deque_t q;
+	deque_init(&q, sizeof(int));
+	void *s1, *s2;
+	size_t n1, n2;
+	assert(deque_segments(&q, &s1, &n1, &s2, &n2) == 0);
+	assert(!s1 && !s2 && n1 == 0 && n2 == 0);
+
+	int i;
+	for(i = 0; i != 8; ++i){
+		deque_push_back(&q, &i);
+	}
+	deque_pop_front_n(&q, 6);
+	for(i = 8; i != 11; ++i){
+		deque_push_back(&q, &i);
+	}
+	assert(deque_segments(&q, &s1, &n1, &s2, &n2) == 5);
+	assert(n1 == 2 && n2 == 3);
+	assert(((int*)s1)[0] == 6 && ((int*)s1)[1] == 7);
+	assert(((int*)s2)[0] == 8 && ((int*)s2)[2] == 10);
+
+	assert(!deque_pop_front_n(&q, 6));
+	assert(deque_pop_front_n(&q, n1));
+	assert(*(int*)deque_front(&q) == 8);
+	deque_uninit(&q);
+}
+
+void test_deque_reserve(){
+	deque_t* q = deque_create(sizeof(double));
+	assert(q);
+	assert(deque_reserve(q, 100));
+	assert(q->capacity == 128);
+	assert(deque_reserve(q, 10));
+	assert(q->capacity == 128);
+	deque_destroy(q);
+}
+
+
+void test_deque_run_all(){
+	test_deque_init();
+	test_deque_init_zero_element_size();
+	test_deque_push_back();
+	test_deque_push_front();
+	test_deque_pop();
+	test_deque_fifo_wrap();
+	test_deque_grow_wrapped();
+	test_deque_push_own();
+	test_deque_segments();
+	test_deque_reserve();
+
+	printf("deque tests passed\n");
+}
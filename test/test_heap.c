@@ -0,0 +1,114 @@
+#include "stdio.h"
+#include "assert.h"
+#include "heap.h"
+
+int test_heap_cmp_int(const void* a, const void* b){
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+void test_heap_push_pop(){
+    int* h = vec_init(int);
+    int i;
+    assert(heap_peek(h) == NULL);
+    for(i = 0; i != 1000; ++i){
+        heap_push(h, (i * 7919) % 1000, test_heap_cmp_int);
+    }
+    assert(vec_size(h) == 1000);
+    for(i = 0; i != 1000; ++i){
+        assert(*heap_peek(h) == i);
+        heap_pop(h, test_heap_cmp_int);
+    }
+    assert(vec_empty(h));
+    heap_pop(h, test_heap_cmp_int);
+    vec_free(h);
+}
+
+void test_heap_replace_top(){
+    int* h = vec_init(int);
+    int i;
+    for(i = 0; i != 10; ++i){
+        heap_push(h, i, test_heap_cmp_int);
+    }
+    heap_replace_top(h, 100, test_heap_cmp_int);
+    assert(*heap_peek(h) == 1);
+    heap_replace_top(h, -1, test_heap_cmp_int);
+    assert(*heap_peek(h) == -1);
+    assert(vec_size(h) == 10);
+    vec_free(h);
+}
+
+void test_heap_heapify(){
+    int* h = vec_init(int);
+    int i;
+    for(i = 0; i != 500; ++i){
+        vec_push(h, 500 - i);
+    }
+    heap_heapify(h, test_heap_cmp_int);
+    for(i = 1; i != 501; ++i){
+        assert(*heap_peek(h) == i);
+        heap_pop(h, test_heap_cmp_int);
+    }
+    vec_free(h);
+}
+
+void test_heap_arity(){
+    int* h = vec_init(int);
+    int i;
+    for(i = 0; i != 100; ++i){
+        vec_push(h, (i * 37) % 100);
+    }
+    _heap_heapify(h, sizeof(int), 2, test_heap_cmp_int);
+    for(i = 1; i != 100; ++i){
+        assert(test_heap_cmp_int(&h[(i - 1) / 2], &h[i]) <= 0);
+    }
+    vec_push(h, -5);
+    _heap_sift_up(h, sizeof(int), vec_size(h) - 1, 2, test_heap_cmp_int);
+    assert(h[0] == -5);
+    vec_free(h);
+}
+
+void test_heap_topk(){
+    int* h = vec_init(int);
+    int i;
+    for(i = 0; i != 10000; ++i){
+        int v = (i * 7919) % 10000;
+        heap_topk_push(h, 10, &v, test_heap_cmp_int);
+    }
+    assert(vec_size(h) == 10);
+    assert(*heap_peek(h) == 9990);
+    heap_sort(h, test_heap_cmp_int);
+    for(i = 0; i != 10; ++i){
+        assert(h[i] == 9999 - i);
+    }
+    vec_free(h);
+}
+
+void test_heap_large_items(){
+    struct big { int key; char payload[300]; };
+    struct big* h = vec_init(struct big);
+    int i;
+    for(i = 0; i != 50; ++i){
+        struct big b;
+        b.key = 49 - i;
+        b.payload[299] = (char)i;
+        heap_push(h, b, test_heap_cmp_int);
+    }
+    for(i = 0; i != 50; ++i){
+        assert(heap_peek(h)->key == i);
+        assert(heap_peek(h)->payload[299] == (char)(49 - i));
+        heap_pop(h, test_heap_cmp_int);
+    }
+    vec_free(h);
+}
+
+void test_heap_run_all(){
+    test_heap_push_pop();
+    test_heap_replace_top();
+    test_heap_heapify();
+    test_heap_arity();
+    test_heap_topk();
+    test_heap_large_items();
+
+    printf("heap tests passed\n");
+}
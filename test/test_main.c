@@ -2,11 +2,33 @@
 
 void test_vec_run_all();
 void test_array_run_all();
+void test_deque_run_all();
+void test_segarray_run_all();
+void test_soa_run_all();
+void test_strvec_run_all();
+void test_heap_run_all();
+void test_btree_run_all();
+void test_art_run_all();
+void test_numv_kernels_run_all();
+void test_numv_run_all();
+void test_numv_expr_run_all();
+void test_numv_types_run_all();
 
 int main(int argc, char* argv[]){
     
     test_vec_run_all();
     test_array_run_all();
+    test_deque_run_all();
+    test_segarray_run_all();
+    test_soa_run_all();
+    test_strvec_run_all();
+    test_heap_run_all();
+    test_btree_run_all();
+    test_art_run_all();
+    test_numv_kernels_run_all();
+    test_numv_run_all();
+    test_numv_expr_run_all();
+    test_numv_types_run_all();
 
     printf("All tests passed\n");
 
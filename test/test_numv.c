@@ -0,0 +1,594 @@
+#include "stdio.h"
+#include "assert.h"
+#include "math.h"
+#include "numv.h"
+#include "array.h"
+#include "sort.h"
+
+void test_numv_full(){
+    size_t n;
+    for(n = 1; n != 40; ++n){
+        double* nv = numv_full(n, 2.5);
+        size_t i;
+        assert(numv_size(nv) == n);
+        for(i = 0; i != n; ++i) assert(nv[i] == 2.5);
+        numv_free(nv);
+    }
+    double data[5] = {1, -2, 3, -4, 5};
+    double* nv = numv_from_array(5, data);
+    assert(numv_size(nv) == 5 && memcmp(nv, data, sizeof(data)) == 0);
+    assert(numv_from_array(5, NULL) == NULL);
+    numv_free(nv);
+}
+
+void test_numv_arithmetic(){
+    /* Sizes that are not a multiple of any vector width */
+    size_t n;
+    for(n = 1; n < 70; n += 3){
+        double* a = numv_range(-1.5, 7.0, n);
+        double* b = numv_range(0.25, 3.0, n);
+        double* add = numv_add(a, b);
+        double* sub = numv_sub(a, b);
+        double* mult = numv_mult(a, b);
+        double* div = numv_div(a, b);
+        double* pw = numv_pow(b, a);
+        double* hyp = numv_hypot(a, b);
+        size_t i;
+        for(i = 0; i != n; ++i){
+            assert(add[i] == a[i] + b[i]);
+            assert(sub[i] == a[i] - b[i]);
+            assert(mult[i] == a[i] * b[i]);
+            assert(div[i] == a[i] / b[i]);
+            assert(pw[i] == pow(b[i], a[i]));
+            assert(hyp[i] == hypot(a[i], b[i]));
+        }
+        numv_free_n(8, a, b, add, sub, mult, div, pw, hyp);
+    }
+}
+
+void test_numv_arithmetic_scalar(){
+    double* a = numv_range(-4.0, 4.0, 37);
+    double* adds = numv_adds(a, 1.5);
+    double* subs = numv_subs(a, 1.5);
+    double* mults = numv_mults(a, -3.0);
+    double* divs = numv_divs(a, 0.0);
+    double* pows = numv_pows(a, 2.0);
+    size_t i;
+    for(i = 0; i != 37; ++i){
+        assert(adds[i] == a[i] + 1.5);
+        assert(subs[i] == a[i] - 1.5);
+        assert(mults[i] == a[i] * -3.0);
+        assert(a[i] == 0 ? isnan(divs[i]) : isinf(divs[i]));
+        assert(pows[i] == a[i] * a[i]);
+    }
+    numv_free_n(6, a, adds, subs, mults, divs, pows);
+}
+
+void test_numv_arithmetic_invalid(){
+    double* a = numv_zeros(4);
+    double* b = numv_zeros(5);
+    assert(numv_add(a, b) == NULL);
+    assert(numv_add(a, NULL) == NULL);
+    assert(numv_mults(NULL, 2) == NULL);
+    numv_free_n(2, a, b);
+}
+
+void test_numv_arithmetic_into(){
+    double* a = numv_range(1.0, 20.0, 19);
+    double* b = numv_range(-3.0, 3.0, 19);
+    double* sum = numv_add(a, b);
+    double* prod = numv_mult(a, b);
+    double* dst = numv_zeros(19);
+    size_t i;
+
+    /* Separate destination */
+    assert(numv_add_into(dst, a, b) == dst);
+    assert(memcmp(dst, sum, 19 * sizeof(double)) == 0);
+    assert(numv_mults_into(dst, a, 2.0) == dst);
+    for(i = 0; i != 19; ++i) assert(dst[i] == a[i] * 2.0);
+
+    /* Destination aliasing either input */
+    double* c = numv_copy(a);
+    assert(numv_mult_into(c, c, b) == c);
+    assert(memcmp(c, prod, 19 * sizeof(double)) == 0);
+    numv_free(c);
+    c = numv_copy(b);
+    assert(numv_add_into(c, a, c) == c);
+    assert(memcmp(c, sum, 19 * sizeof(double)) == 0);
+    numv_free(c);
+
+    /* In-place forms */
+    c = numv_copy(a);
+    assert(numv_add_inplace(c, b) == c);
+    assert(memcmp(c, sum, 19 * sizeof(double)) == 0);
+    assert(numv_subs_inplace(c, 1.0) == c);
+    for(i = 0; i != 19; ++i) assert(c[i] == sum[i] - 1.0);
+    assert(numv_hypot_inplace(c, c) == c);
+    for(i = 0; i != 19; ++i) assert(c[i] == hypot(sum[i] - 1.0, sum[i] - 1.0));
+
+    /* Size mismatches leave the destination unchanged */
+    double* small = numv_full(5, 7.0);
+    assert(numv_add_into(small, a, b) == NULL);
+    assert(numv_divs_into(small, a, 2.0) == NULL);
+    assert(numv_pow_inplace(small, a) == NULL);
+    assert(numv_add_into(NULL, a, b) == NULL);
+    for(i = 0; i != 5; ++i) assert(small[i] == 7.0);
+
+    numv_free_n(7, a, b, sum, prod, dst, c, small);
+}
+
+double test_numv_add(double x, double y){
+    return x + y;
+}
+
+void test_numv_sum(){
+    size_t n;
+    for(n = 1; n < 1200; n += 37){
+        double* nv = numv_range(1.0, (double)n + 1.0, n);
+        assert(numv_sum(nv) == (double)n * (double)(n + 1) / 2);
+        assert(numv_mean(nv) == (double)(n + 1) / 2);
+        assert(numv_agg(nv, test_numv_add) == numv_sum(nv));
+        numv_free(nv);
+    }
+    assert(numv_sum(NULL) == 0);
+    assert(isnan(numv_mean(NULL)));
+    assert(isnan(numv_agg(NULL, test_numv_add)));
+
+    /* Pairwise summation keeps the error small where a running sum drifts */
+    double* nv = numv_full(1000000, 0.1);
+    assert(fabs(numv_sum(nv) - 100000.0) < 1e-8);
+    nv[123] = NAN;
+    assert(isnan(numv_sum(nv)));
+    numv_free(nv);
+}
+
+void test_numv_std(){
+    double data[8] = {2, 4, 4, 4, 5, 5, 7, 9};
+    double* nv = numv_from_array(8, data);
+    assert(numv_std(nv) == 2.0);
+    numv_free(nv);
+
+    /* A large offset does not cancel the variance */
+    nv = numv_empty(10001);
+    size_t i;
+    for(i = 0; i != numv_size(nv); ++i) nv[i] = 1e9 + (i % 2 ? 1.0 : -1.0);
+    nv[10000] = 1e9;
+    struct numv_stats stats = numv_describe(nv);
+    assert(stats.count == 10001);
+    assert(stats.min == 1e9 - 1 && stats.max == 1e9 + 1);
+    assert(stats.mean == 1e9);
+    assert(fabs(stats.std - sqrt(10000.0 / 10001.0)) < 1e-12);
+    assert(stats.std == numv_std(nv));
+    numv_free(nv);
+
+    stats = numv_describe(NULL);
+    assert(stats.count == 0 && isnan(stats.mean) && isnan(stats.std) && isnan(stats.min));
+}
+
+void test_numv_min_max(){
+    double* nv = numv_range(0.0, 100.0, 100);
+    nv[37] = -5;
+    nv[80] = -5;
+    nv[3] = 500;
+    nv[50] = NAN;
+    assert(numv_min(nv) == -5 && numv_imin(nv) == 37);
+    assert(numv_max(nv) == 500 && numv_imax(nv) == 3);
+    struct numv_stats stats = numv_describe(nv);
+    assert(stats.min == -5 && stats.max == 500 && isnan(stats.mean));
+
+    /* Infinities are values, NaNs are not */
+    size_t i;
+    for(i = 0; i != numv_size(nv); ++i) nv[i] = NAN;
+    assert(isnan(numv_min(nv)) && isnan(numv_max(nv)));
+    assert(numv_imin(nv) == 100 && numv_imax(nv) == 100);
+    nv[99] = INFINITY;
+    assert(numv_min(nv) == INFINITY && numv_imin(nv) == 99);
+    assert(isnan(numv_describe(nv).max) == 0);
+    numv_free(nv);
+
+    assert(isnan(numv_min(NULL)) && numv_imax(NULL) == 0);
+}
+
+void test_numv_transforms(){
+    size_t n;
+    for(n = 1; n < 40; n += 3){
+        double* a = numv_range(0.5, 20.0, n);
+        double* sq = numv_sqrt(numv_copy(a));
+        double* cb = numv_cbrt(numv_copy(a));
+        double* ex = numv_exp(numv_copy(a));
+        double* lg = numv_log(numv_copy(a));
+        size_t i;
+        for(i = 0; i != n; ++i){
+            assert(sq[i] == sqrt(a[i]));
+            assert(cb[i] == cbrt(a[i]));
+            assert(ex[i] == exp(a[i]));
+            assert(lg[i] == log(a[i]));
+        }
+        numv_free_n(5, a, sq, cb, ex, lg);
+    }
+    assert(numv_sqrt(NULL) == NULL && numv_replace_nans(NULL, 0) == NULL);
+
+    double data[11] = {1, NAN, 3, -NAN, INFINITY, 6, 7, 8, NAN, -0.0, NAN};
+    double* nv = numv_from_array(11, data);
+    assert(numv_replace_nans(nv, -1) == nv);
+    for(n = 0; n != 11; ++n) assert(isnan(data[n]) ? nv[n] == -1 : nv[n] == data[n]);
+    assert(signbit(nv[9]));
+    numv_free(nv);
+}
+
+/* Block function computing 2x + offset, counting the blocks */
+struct test_numv_block_args {
+    double offset;
+    size_t n_blocks;
+};
+
+void test_numv_affine_block(const double* in, double* out, size_t n, void* args){
+    struct test_numv_block_args* b = args;
+    size_t i;
+    assert(n >= 1 && n <= NUMV_APPLY_BLOCK);
+    for(i = 0; i != n; ++i) out[i] = 2.0 * in[i] + b->offset;
+    b->n_blocks++;
+}
+
+void test_numv_apply_block(){
+    size_t n = 3 * NUMV_APPLY_BLOCK + 5, i;
+    double* a = numv_range(-10.0, 10.0, n);
+    double* dst = numv_zeros(n);
+    struct test_numv_block_args args = {1.5, 0};
+
+    assert(numv_apply_block_into(dst, a, test_numv_affine_block, &args) == dst);
+    assert(args.n_blocks == 4);
+    for(i = 0; i != n; ++i) assert(dst[i] == 2.0 * a[i] + 1.5);
+
+    assert(numv_apply_block(a, test_numv_affine_block, &args) == a);
+    assert(memcmp(a, dst, n * sizeof(double)) == 0);
+
+    double* small = numv_zeros(4);
+    assert(numv_apply_block_into(small, a, test_numv_affine_block, &args) == NULL);
+    assert(numv_apply_block(NULL, test_numv_affine_block, &args) == NULL);
+    numv_free_n(3, a, dst, small);
+}
+
+void test_numv_view_slice(){
+    double* nv = numv_range(0.0, 10.0, 10);
+    numv_view_t all = numv_view(nv);
+    assert(all.data == nv && all.size == 10 && all.stride == 1);
+
+    /* Windows, steps and reversed order share the items */
+    numv_view_t window = numv_view_slice(all, 2, -3, 1);
+    assert(window.data == nv + 2 && window.size == 6);
+    numv_view_t odd = numv_view_slice(all, 1, -1, 2);
+    assert(odd.size == 5 && odd.stride == 2);
+    numv_view_t reversed = numv_view_slice(all, -1, 0, -1);
+    numv_view_t every_third = numv_view_slice(reversed, 0, -1, 3);
+    double* r = numv_materialize(every_third);
+    assert(numv_size(r) == 4 && r[0] == 9 && r[1] == 6 && r[2] == 3 && r[3] == 0);
+    numv_free(r);
+
+    r = numv_materialize(numv_view_slice(odd, -2, 1, -1));
+    assert(numv_size(r) == 3 && r[0] == 7 && r[1] == 5 && r[2] == 3);
+    numv_free(r);
+
+    /* A view sees later changes of the items */
+    nv[3] = 100;
+    assert(numv_view_max(odd) == 100 && numv_view_imax(odd) == 1);
+
+    /* Invalid slices are empty */
+    assert(numv_view_slice(all, 0, 10, 1).size == 0);
+    assert(numv_view_slice(all, 5, 2, 1).size == 0);
+    assert(numv_view_slice(all, 2, 5, -1).size == 0);
+    assert(numv_view_slice(all, 0, 5, 0).size == 0);
+    assert(numv_view_slice(numv_view(NULL), 0, 0, 1).size == 0);
+    assert(numv_view_slice(all, 4, 4, 1).size == 1);
+    assert(numv_materialize(numv_view(NULL)) == NULL);
+
+    /* numv_slice copies the items of the same slices */
+    r = numv_slice(nv, 4, 4);
+    assert(numv_size(r) == 1 && r[0] == 4);
+    numv_free(r);
+    r = numv_slice(nv, -3, -1);
+    assert(numv_size(r) == 3 && r[0] == 7 && r[2] == 9);
+    numv_free(r);
+    assert(numv_slice(nv, 0, 10) == NULL && numv_slice(nv, 5, 2) == NULL && numv_slice(NULL, 0, 0) == NULL);
+
+    /* A stride of 0 repeats an item */
+    double x = 2.5;
+    numv_view_t repeated = numv_view_of(&x, 4, 0);
+    assert(numv_view_sum(repeated) == 10.0 && numv_view_std(repeated) == 0.0);
+    numv_free(nv);
+}
+
+void test_numv_view_ops(){
+    size_t n = 5003, i;
+    double* a = numv_range(-3.0, 7.0, 2 * n);
+    double* b = numv_range(1.0, 2.0, n);
+    a[17] = NAN;
+    numv_view_t even = numv_view_slice(numv_view(a), 0, -1, 2);
+    numv_view_t back = numv_view_slice(numv_view(a), -1, 0, -2);
+    double* ea = numv_materialize(even);
+    double* ba = numv_materialize(back);
+    assert(numv_size(ea) == n && numv_size(ba) == n);
+
+    /* Same results as on the materialised items */
+    double* x = numv_view_mult(back, numv_view(b));
+    double* y = numv_mult(ba, b);
+    assert(memcmp(x, y, n * sizeof(double)) == 0);
+    numv_free_n(2, x, y);
+    x = numv_view_pows(even, 2.0);
+    y = numv_pows(ea, 2.0);
+    assert(memcmp(x, y, n * sizeof(double)) == 0);
+    numv_free_n(2, x, y);
+
+    double s = numv_view_sum(even), t = numv_sum(ea);
+    assert(memcmp(&s, &t, sizeof(double)) == 0);
+    struct numv_stats vs = numv_view_describe(even), ms = numv_describe(ea);
+    assert(vs.count == n && vs.min == ms.min && vs.max == ms.max);
+    assert(memcmp(&vs.mean, &ms.mean, sizeof(double)) == 0 && memcmp(&vs.std, &ms.std, sizeof(double)) == 0);
+    assert(isnan(numv_view_std(back)) && isnan(numv_std(ba)) && isnan(numv_view_mean(back)));
+    assert(numv_view_std(even) == numv_std(ea));
+    assert(numv_view_imin(back) == numv_imin(ba) && numv_view_imax(even) == numv_imax(ea));
+
+    /* Writing through strided views only changes their items */
+    double* c = numv_copy(a);
+    assert(numv_view_adds_into(even, even, 1.0) == a);
+    for(i = 0; i != 2 * n; ++i){
+        if(i % 2 || isnan(c[i])) assert(memcmp(&a[i], &c[i], sizeof(double)) == 0);
+        else assert(a[i] == c[i] + 1.0);
+    }
+    numv_view_t odd = numv_view_slice(numv_view(a), 1, -1, 2);
+    assert(numv_view_sub_into(odd, numv_view(b), numv_view_slice(numv_view(b), -1, 0, -1)) == a + 1);
+    for(i = 0; i != n; ++i) assert(a[2 * i + 1] == b[i] - b[n - 1 - i]);
+
+    assert(numv_view_add(even, numv_view(NULL)) == NULL);
+    assert(numv_view_add_into(odd, even, numv_view_slice(even, 0, 5, 1)) == NULL);
+    numv_free_n(5, a, b, ea, ba, c);
+}
+
+static int test_numv_compare(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void test_numv_quantiles(){
+    double probs[6] = {0, 0.1, 0.25, 0.5, 0.999, 1};
+    size_t sizes[5] = {1, 2, 25, 1000, 100001};
+    size_t s, i, p;
+    uint64_t seed = 42;
+    for(s = 0; s != 5; ++s){
+        size_t n = sizes[s];
+        int kind;
+        /* Random, few distinct values, sorted, reversed and constant items */
+        for(kind = 0; kind != 5; ++kind){
+            double* a = numv_empty(n);
+            for(i = 0; i != n; ++i){
+                seed = seed * 6364136223846793005u + 1442695040888963407u;
+                double r = (double)(seed >> 11) / 9007199254740992.0 - 0.5;
+                a[i] = kind == 0 ? r : kind == 1 ? floor(r * 8) : kind == 2 ? (double)i
+                     : kind == 3 ? (double)(n - i) : 3.0;
+            }
+            double* sorted = numv_copy(a);
+            qsort(sorted, n, sizeof(double), test_numv_compare);
+
+            double* q = numv_quantiles(a, probs, 6);
+            assert(numv_size(q) == 6);
+            for(p = 0; p != 6; ++p){
+                double h = probs[p] * (double)(n - 1);
+                size_t lo = (size_t)h;
+                double expected = sorted[lo];
+                if(h != (double)lo) expected += (h - (double)lo) * (sorted[lo + 1] - sorted[lo]);
+                assert(q[p] == expected);
+            }
+            double median = n % 2 ? sorted[n / 2] : sorted[n / 2 - 1] + 0.5 * (sorted[n / 2] - sorted[n / 2 - 1]);
+            assert(numv_median(a) == median);
+
+            /* The in-place forms reorder the same items */
+            double* q2 = numv_quantiles_inplace(a, probs, 6);
+            assert(memcmp(q, q2, 6 * sizeof(double)) == 0);
+            assert(numv_median_inplace(a) == median);
+            qsort(a, n, sizeof(double), test_numv_compare);
+            assert(memcmp(a, sorted, n * sizeof(double)) == 0);
+            numv_free_n(4, a, sorted, q, q2);
+        }
+    }
+
+    double data[5] = {4, 1, NAN, 3, 2};
+    double bad[2] = {0.5, 1.5};
+    double* a = numv_from_array(5, data);
+    double* q = numv_quantiles(a, probs, 2);
+    assert(isnan(numv_median(a)) && isnan(q[0]) && isnan(q[1]));
+    a[2] = 5;
+    assert(numv_median(a) == 3);
+    assert(numv_quantiles(a, bad, 2) == NULL && numv_quantiles(a, probs, 0) == NULL);
+    assert(numv_quantiles(NULL, probs, 2) == NULL && isnan(numv_median(NULL)));
+    numv_free_n(2, a, q);
+}
+
+void test_numv_mode(){
+    double data[9] = {2, -0.0, 5, 0, 5, 2, 0, 7, 5};
+    double* a = numv_from_array(9, data);
+    assert(numv_mode(a) == 0);
+    a[6] = 2;
+    assert(numv_mode(a) == 2);
+    a[0] = NAN;
+    assert(isnan(numv_mode(a)) && isnan(numv_mode(NULL)));
+    numv_free(a);
+
+    /* Enough distinct values to grow the table */
+    size_t n = 100000, i;
+    a = numv_empty(n);
+    for(i = 0; i != n; ++i) a[i] = (double)(i % 30011) - 100.5;
+    assert(numv_mode(a) == -100.5);
+    for(i = n - 5; i != n; ++i) a[i] = 1e300;
+    assert(numv_mode(a) == 1e300);
+    numv_free(a);
+}
+
+/* Sizes from the threshold up use the radix sorts, which lay out their buffers in one block:
+   run under a sanitizer, and on a 32-bit target as well, to check that they stay within it */
+void test_numv_sort(){
+    size_t sizes[6] = {1, 2, 50, NUMV_SORT_RADIX_THRESHOLD - 1, NUMV_SORT_RADIX_THRESHOLD, 20000};
+    double special[8] = {-0.0, 0.0, INFINITY, -INFINITY, NAN, 5e-324, -5e-324, -NAN};
+    size_t s, i, j;
+    uint64_t seed = 7;
+    for(s = 0; s != 6; ++s){
+        size_t n = sizes[s], nans = 0, m = 0;
+        double* a = numv_empty(n);
+        for(i = 0; i != n; ++i){
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            double r = (double)(seed >> 11) / 9007199254740992.0 - 0.5;
+            a[i] = i % 3 == 0 ? special[(seed >> 3) % 8] : i % 3 == 1 ? floor(r * 10) : r * 1e10;
+            nans += isnan(a[i]);
+        }
+        /* Expected order of the other items */
+        double* expected = numv_empty(n);
+        for(i = 0; i != n; ++i){
+            if(!isnan(a[i])) expected[m++] = a[i];
+        }
+        qsort(expected, m, sizeof(double), test_numv_compare);
+
+        size_t* idx = numv_argsort(a);
+        char* seen = calloc(n, 1);
+        assert(numv_size(idx) == n);
+        for(i = 0; i != n; ++i){
+            assert(idx[i] < n && !seen[idx[i]]);
+            seen[idx[i]] = 1;
+            assert(i < m ? a[idx[i]] == expected[i] : isnan(a[idx[i]]));
+            /* Equal items and NaNs keep their order */
+            if(i > 0 && (a[idx[i]] == a[idx[i - 1]] || i > m)) assert(idx[i - 1] < idx[i]);
+        }
+        free(seen);
+
+        assert(numv_sort(a) == a);
+        for(i = 0; i != m; ++i) assert(a[i] == expected[i]);
+        for(i = 1; i < m; ++i) assert(!(a[i] == 0 && signbit(a[i]) && !signbit(a[i - 1])));
+        for(j = m; j != n; ++j) assert(isnan(a[j]));
+        assert(m + nans == n);
+        numv_free(a);
+        numv_free_n(2, expected, idx);
+    }
+
+    /* Both the introsort and the radix sort order -0 before 0, and keep the bits of NaNs */
+    for(s = 0; s != 2; ++s){
+        size_t n = s == 0 ? 8 : 2 * NUMV_SORT_RADIX_THRESHOLD;
+        double* a = numv_full(n, 0.0);
+        for(i = 0; i < n; i += 2) a[i] = -0.0;
+        a[1] = -NAN;
+        numv_sort(a);
+        assert(signbit(a[0]) && signbit(a[n / 2 - 1]) && !signbit(a[n / 2]) && !signbit(a[n - 2]));
+        assert(isnan(a[n - 1]) && signbit(a[n - 1]));
+        numv_free(a);
+    }
+
+    assert(numv_sort(NULL) == NULL && numv_argsort(NULL) == NULL);
+}
+
+static double* test_numv_nested_array;
+
+/* Calls numv from a task of a numv job, for a few items */
+double test_numv_nested(double x){
+    return x == 0 ? numv_sum(test_numv_nested_array) : x;
+}
+
+static threadpool_t* test_numv_nested_pool;
+
+static int test_numv_compare_ints(const void* a, const void* b){
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* Sorts an array on the pool of numv from a task of a numv job, for a few items */
+double test_numv_nested_sort(double x){
+    if(x != 0) return x;
+    array_t array;
+    int i, n = SORT_PARALLEL_THRESHOLD + 1, sorted = 1;
+    array_init(&array, sizeof(int));
+    for(i = 0; i != n; ++i){
+        int v = n - i;
+        array_push_back(&array, &v);
+    }
+    array_sort_parallel(&array, test_numv_compare_ints, test_numv_nested_pool);
+    for(i = 0; i != n; ++i) sorted &= array_at_as(&array, int, i) == i + 1;
+    array_uninit(&array);
+    return sorted;
+}
+
+void test_numv_threads(){
+    size_t n = 300001, i;
+    double* a = numv_range(-1.0, 1.0, n);
+    double* b = numv_range(3.0, 0.5, n);
+    for(i = 0; i < n; i += 97) a[i] *= 1e6;
+
+    /* Results on the calling thread */
+    numv_set_parallel_threshold(SIZE_MAX);
+    double sum = numv_sum(a);
+    size_t imax = numv_imax(a);
+    double sum_b = numv_sum(b);
+    struct numv_stats stats = numv_describe(a);
+    double* prod = numv_mult(a, b);
+    double* sq = numv_apply(numv_copy(a), sqrt);
+
+    size_t n_threads;
+    for(n_threads = 2; n_threads <= 5; ++n_threads){
+        threadpool_t* pool = threadpool_create(n_threads);
+        numv_set_threadpool(pool);
+        numv_set_parallel_threshold(1000);
+
+        /* Reductions are bitwise identical for any number of threads */
+        double s = numv_sum(a);
+        assert(memcmp(&s, &sum, sizeof(double)) == 0);
+        struct numv_stats st = numv_describe(a);
+        assert(st.count == stats.count && st.min == stats.min && st.max == stats.max);
+        assert(memcmp(&st.mean, &stats.mean, sizeof(double)) == 0);
+        assert(memcmp(&st.std, &stats.std, sizeof(double)) == 0);
+        assert(numv_std(a) == stats.std);
+        assert(numv_imax(a) == imax && numv_imin(a) == 0);
+
+        double* p = numv_mult(a, b);
+        assert(memcmp(p, prod, n * sizeof(double)) == 0);
+        numv_view_t reversed = numv_view_slice(numv_view(a), -1, 0, -1);
+        assert(numv_view_max(reversed) == stats.max && numv_view_imax(reversed) == n - 1 - imax);
+        double* q = numv_apply(numv_copy(a), sqrt);
+        for(i = 0; i != n; ++i) assert(isnan(q[i]) ? isnan(sq[i]) : q[i] == sq[i]);
+        double* f = numv_full(n, 4.0);
+        for(i = 0; i != n; ++i) assert(f[i] == 4.0);
+
+        /* numv called from the function of numv_apply runs on that thread */
+        test_numv_nested_array = b;
+        for(i = 0; i < n; i += 50000) f[i] = 0;
+        numv_apply(f, test_numv_nested);
+        assert(f[0] == sum_b && f[250000] == sum_b && f[n - 2] == 4.0);
+
+        /* A parallel sort on the same pool from the function of numv_apply */
+        test_numv_nested_pool = pool;
+        for(i = 0; i < n; i += 50000) f[i] = 0;
+        numv_apply(f, test_numv_nested_sort);
+        assert(f[0] == 1 && f[250000] == 1 && f[n - 2] == 4.0);
+
+        numv_free_n(3, p, q, f);
+        numv_set_threadpool(NULL);
+        threadpool_destroy(pool);
+    }
+    numv_set_parallel_threshold(NUMV_PARALLEL_THRESHOLD);
+    numv_free_n(4, a, b, prod, sq);
+}
+
+void test_numv_run_all(){
+    test_numv_full();
+    test_numv_arithmetic();
+    test_numv_arithmetic_scalar();
+    test_numv_arithmetic_invalid();
+    test_numv_arithmetic_into();
+    test_numv_transforms();
+    test_numv_apply_block();
+    test_numv_sum();
+    test_numv_std();
+    test_numv_min_max();
+    test_numv_quantiles();
+    test_numv_mode();
+    test_numv_sort();
+    test_numv_view_slice();
+    test_numv_view_ops();
+    test_numv_threads();
+
+    printf("numv tests passed\n");
+}
@@ -0,0 +1,169 @@
+#include "stdio.h"
+#include "assert.h"
+#include "math.h"
+#include "numv_expr.h"
+
+void test_numv_expr_eval(){
+    /* Sizes around a tile */
+    size_t sizes[5] = {1, 7, NUMV_EXPR_TILE, NUMV_EXPR_TILE + 1, 3 * NUMV_EXPR_TILE + 5};
+    size_t s, i;
+    for(s = 0; s != 5; ++s){
+        size_t n = sizes[s];
+        double* a = numv_range(-2.0, 5.0, n);
+        double* b = numv_range(1.0, 3.0, n);
+
+        /* sqrt(a*a + b*b) / 2 - b */
+        numv_expr_t* e = numv_expr_sub(
+            numv_expr_divs(numv_expr_sqrt(numv_expr_add(
+                numv_expr_mult(numv_expr_array(a), numv_expr_array(a)),
+                numv_expr_mult(numv_expr_array(b), numv_expr_array(b)))), 2.0),
+            numv_expr_array(b));
+        assert(numv_expr_size(e) == n);
+        double* r = numv_expr_eval(e);
+        assert(numv_size(r) == n);
+        for(i = 0; i != n; ++i){
+            assert(r[i] == sqrt(a[i] * a[i] + b[i] * b[i]) / 2.0 - b[i]);
+        }
+
+        /* Evaluating again into one of the inputs */
+        assert(numv_expr_eval_into(b, e) == b);
+        assert(memcmp(b, r, n * sizeof(double)) == 0);
+
+        numv_expr_free(e);
+        numv_free_n(3, a, b, r);
+    }
+}
+
+void test_numv_expr_compare(){
+    double data[6] = {1, 2, 3, NAN, 5, 6};
+    double* a = numv_from_array(6, data);
+    double* r = numv_empty(6);
+    double lt[6] = {1, 1, 0, 0, 0, 0};
+    double ge[6] = {0, 0, 1, 0, 1, 1};
+    double ne[6] = {1, 1, 0, 1, 1, 1};
+    size_t i;
+
+    numv_expr_t* e = numv_expr_lt(numv_expr_array(a), numv_expr_scalar(3));
+    numv_expr_eval_into(r, e);
+    for(i = 0; i != 6; ++i) assert(r[i] == lt[i]);
+    numv_expr_free(e);
+
+    e = numv_expr_ge(numv_expr_array(a), numv_expr_scalar(3));
+    numv_expr_eval_into(r, e);
+    for(i = 0; i != 6; ++i) assert(r[i] == ge[i]);
+    numv_expr_free(e);
+
+    e = numv_expr_gt(numv_expr_scalar(3), numv_expr_array(a));
+    numv_expr_eval_into(r, e);
+    for(i = 0; i != 6; ++i) assert(r[i] == lt[i]);
+    numv_expr_free(e);
+
+    e = numv_expr_ne(numv_expr_array(a), numv_expr_scalar(3));
+    numv_expr_eval_into(r, e);
+    for(i = 0; i != 6; ++i) assert(r[i] == ne[i]);
+    numv_expr_free(e);
+
+    /* Masks combine with arithmetic */
+    e = numv_expr_mult(numv_expr_le(numv_expr_array(a), numv_expr_scalar(2)), numv_expr_array(a));
+    numv_expr_eval_into(r, e);
+    assert(r[0] == 1 && r[1] == 2 && r[2] == 0 && isnan(r[3]) && r[4] == 0);
+    numv_expr_free(e);
+
+    numv_free_n(2, a, r);
+}
+
+void test_numv_expr_deep(){
+    double* a = numv_range(0.0, 10.0, 1000);
+    numv_expr_t* left = numv_expr_array(a);
+    numv_expr_t* right = numv_expr_array(a);
+    size_t i;
+    for(i = 1; i != 20; ++i){
+        left = numv_expr_add(left, numv_expr_array(a));
+        right = numv_expr_add(numv_expr_array(a), right);
+    }
+    double* x = numv_expr_eval(left);
+    double* y = numv_expr_eval(right);
+    for(i = 0; i != 1000; ++i){
+        double sum = 0;
+        size_t k;
+        for(k = 0; k != 20; ++k) sum += a[i];
+        assert(x[i] == sum && y[i] == sum);
+    }
+    numv_expr_free(left);
+    numv_expr_free(right);
+    numv_free_n(3, a, x, y);
+}
+
+void test_numv_expr_leaves(){
+    double* a = numv_range(0.0, 1.0, 10);
+    double* r = numv_zeros(10);
+    size_t i;
+
+    /* A single array is copied, scalars fill the destination */
+    numv_expr_t* e = numv_expr_array(a);
+    assert(numv_expr_eval_into(r, e) == r && memcmp(r, a, 10 * sizeof(double)) == 0);
+    numv_expr_free(e);
+
+    e = numv_expr_pows(numv_expr_scalar(2), 3);
+    assert(numv_expr_size(e) == 0 && numv_expr_eval(e) == NULL);
+    assert(numv_expr_eval_into(r, e) == r);
+    for(i = 0; i != 10; ++i) assert(r[i] == 8);
+    numv_expr_free(e);
+
+    numv_free_n(2, a, r);
+}
+
+void test_numv_expr_invalid(){
+    double* a = numv_zeros(4);
+    double* b = numv_zeros(5);
+
+    /* Mismatched sizes */
+    numv_expr_t* e = numv_expr_add(numv_expr_array(a), numv_expr_array(b));
+    assert(e && numv_expr_size(e) == 0);
+    assert(numv_expr_eval(e) == NULL && numv_expr_eval_into(a, e) == NULL);
+    numv_expr_free(e);
+
+    e = numv_expr_array(a);
+    assert(numv_expr_eval_into(b, e) == NULL);
+    numv_expr_free(e);
+
+    /* A missing operand frees the others */
+    assert(numv_expr_array(NULL) == NULL);
+    assert(numv_expr_add(numv_expr_array(a), numv_expr_array(NULL)) == NULL);
+    assert(numv_expr_sqrt(NULL) == NULL);
+    assert(numv_expr_eval(NULL) == NULL);
+
+    numv_free_n(2, a, b);
+}
+
+void test_numv_expr_threads(){
+    size_t n = 200003, i;
+    double* a = numv_range(-5.0, 5.0, n);
+    double* b = numv_range(1.0, 2.0, n);
+    numv_expr_t* e = numv_expr_mults(numv_expr_hypot(numv_expr_array(a), numv_expr_array(b)), 3.0);
+    double* serial = numv_expr_eval(e);
+
+    threadpool_t* pool = threadpool_create(3);
+    numv_set_threadpool(pool);
+    numv_set_parallel_threshold(1000);
+    double* parallel = numv_expr_eval(e);
+    assert(memcmp(serial, parallel, n * sizeof(double)) == 0);
+    for(i = 0; i < n; i += 1001) assert(parallel[i] == hypot(a[i], b[i]) * 3.0);
+    numv_set_parallel_threshold(NUMV_PARALLEL_THRESHOLD);
+    numv_set_threadpool(NULL);
+    threadpool_destroy(pool);
+
+    numv_expr_free(e);
+    numv_free_n(4, a, b, serial, parallel);
+}
+
+void test_numv_expr_run_all(){
+    test_numv_expr_eval();
+    test_numv_expr_compare();
+    test_numv_expr_deep();
+    test_numv_expr_leaves();
+    test_numv_expr_invalid();
+    test_numv_expr_threads();
+
+    printf("numv_expr tests passed\n");
+}
@@ -0,0 +1,208 @@
+#include "stdio.h"
+#include "assert.h"
+#include "math.h"
+#include "string.h"
+#include "../src/numv_kernels.h"
+
+/* Every instruction set level must give bitwise identical results to the scalar kernels,
+ * apart from the bits of NaNs. Only the levels supported by the CPU running the tests are checked.
+ */
+
+#define TEST_NUMV_KERNELS_MAX 1040
+
+/* Sizes around the vector widths and the lanes of the reductions, none a multiple of 16 */
+static const size_t test_numv_kernels_sizes[9] = {1, 3, 7, 15, 17, 31, 33, 100, 1029};
+
+static double test_numv_kernels_a[TEST_NUMV_KERNELS_MAX];
+static double test_numv_kernels_b[TEST_NUMV_KERNELS_MAX];
+static float test_numv_kernels_fa[TEST_NUMV_KERNELS_MAX];
+static float test_numv_kernels_fb[TEST_NUMV_KERNELS_MAX];
+
+/* Random items with NaNs, signed zeros, infinities, subnormals and repeated values.
+ * With `specials` unset, only finite non-zero items, so that reductions are finite.
+ */
+static void test_numv_kernels_fill(int specials){
+    double special[8] = {NAN, 0.0, -0.0, INFINITY, -INFINITY, 5e-324, -1e-310, 1.0};
+    uint64_t seed = 12345;
+    size_t i;
+    for(i = 0; i != TEST_NUMV_KERNELS_MAX; ++i){
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        double r = ((double)(seed >> 11) / 9007199254740992.0 - 0.5) * 200.0;
+        double s = r * 0.37 + 1.0;
+        if(specials && (seed >> 7) % 5 == 0) r = special[(seed >> 13) % 8];
+        if(specials && (seed >> 17) % 7 == 0) s = special[(seed >> 23) % 8];
+        test_numv_kernels_a[i] = r;
+        test_numv_kernels_b[i] = s;
+        test_numv_kernels_fa[i] = (float)r;
+        test_numv_kernels_fb[i] = (float)s;
+    }
+}
+
+/* Same bits, except that the sign and payload of NaNs may differ:
+ * when both operands of an addition are NaNs, x86 returns the first one,
+ * and the compiler may swap the operands of the scalar kernels.
+ */
+static int test_numv_kernels_same(double x, double y){
+    return memcmp(&x, &y, sizeof(double)) == 0 || (isnan(x) && isnan(y));
+}
+
+static int test_numv_kernels_same_f32(float x, float y){
+    return memcmp(&x, &y, sizeof(float)) == 0 || (isnan(x) && isnan(y));
+}
+
+static int test_numv_kernels_equal(const double* x, const double* y, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        if(!test_numv_kernels_same(x[i], y[i])) return 0;
+    }
+    return 1;
+}
+
+static int test_numv_kernels_equal_f32(const float* x, const float* y, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        if(!test_numv_kernels_same_f32(x[i], y[i])) return 0;
+    }
+    return 1;
+}
+
+static void test_numv_kernels_compare(const struct numv_kernels* k, const struct numv_kernels* s){
+    numv_binary_kernel binary[10][2] = {
+        {k->add, s->add}, {k->sub, s->sub}, {k->mult, s->mult}, {k->div, s->div},
+        {k->pow, s->pow}, {k->hypot, s->hypot},
+        {k->lt, s->lt}, {k->le, s->le}, {k->eq, s->eq}, {k->ne, s->ne}
+    };
+    numv_unary_kernel unary[4][2] = {
+        {k->sqrt, s->sqrt}, {k->cbrt, s->cbrt}, {k->exp, s->exp}, {k->log, s->log}
+    };
+    numv_scalar_kernel scalar[6][2] = {
+        {k->adds, s->adds}, {k->subs, s->subs}, {k->mults, s->mults},
+        {k->divs, s->divs}, {k->pows, s->pows}, {k->replace_nans, s->replace_nans}
+    };
+    double values[6] = {2.5, -0.0, 0.0, INFINITY, NAN, -3.0};
+    static double out[TEST_NUMV_KERNELS_MAX], expected[TEST_NUMV_KERNELS_MAX];
+    size_t z, f, v;
+    int specials;
+
+    for(specials = 0; specials != 2; ++specials){
+        test_numv_kernels_fill(specials);
+        for(z = 0; z != 9; ++z){
+            size_t n = test_numv_kernels_sizes[z];
+            /* Unaligned inputs */
+            const double* a = test_numv_kernels_a + 1;
+            const double* b = test_numv_kernels_b + 3;
+
+            for(f = 0; f != 10; ++f){
+                binary[f][0](out, a, b, n);
+                binary[f][1](expected, a, b, n);
+                assert(test_numv_kernels_equal(out, expected, n));
+            }
+            for(f = 0; f != 4; ++f){
+                unary[f][0](out, a, n);
+                unary[f][1](expected, a, n);
+                assert(test_numv_kernels_equal(out, expected, n));
+            }
+            for(f = 0; f != 6; ++f){
+                for(v = 0; v != 6; ++v){
+                    scalar[f][0](out, a, values[v], n);
+                    scalar[f][1](expected, a, values[v], n);
+                    assert(test_numv_kernels_equal(out, expected, n));
+                }
+            }
+            for(v = 0; v != 6; ++v){
+                k->fill(out, values[v], n);
+                s->fill(expected, values[v], n);
+                assert(test_numv_kernels_equal(out, expected, n));
+            }
+
+            /* In place */
+            memcpy(out, a, n * sizeof(double));
+            k->add(out, out, b, n);
+            s->add(expected, a, b, n);
+            assert(test_numv_kernels_equal(out, expected, n));
+
+            assert(test_numv_kernels_same(k->sum(a, n), s->sum(a, n)));
+            assert(test_numv_kernels_same(k->sum_sqdev(a, n, 0.75), s->sum_sqdev(a, n, 0.75)));
+            assert(test_numv_kernels_same(k->min(a, n), s->min(a, n)));
+            assert(test_numv_kernels_same(k->max(a, n), s->max(a, n)));
+            double kmin, kmax, smin, smax;
+            double ksum = k->sum_minmax(a, n, &kmin, &kmax);
+            double ssum = s->sum_minmax(a, n, &smin, &smax);
+            assert(test_numv_kernels_same(ksum, ssum));
+            assert(test_numv_kernels_same(kmin, smin) && test_numv_kernels_same(kmax, smax));
+
+            /* Present, absent, zero (equal to -0) and NaN (never found) */
+            double keys[4] = {a[n - 1], 1e300, 0.0, NAN};
+            for(v = 0; v != 4; ++v) assert(k->find(a, n, keys[v]) == s->find(a, n, keys[v]));
+        }
+    }
+}
+
+static void test_numv_kernels_compare_f32(const struct numv_kernels_f32* k, const struct numv_kernels_f32* s){
+    numv_f32_binary_kernel binary[4][2] = {
+        {k->add, s->add}, {k->sub, s->sub}, {k->mult, s->mult}, {k->div, s->div}
+    };
+    numv_f32_scalar_kernel scalar[4][2] = {
+        {k->adds, s->adds}, {k->subs, s->subs}, {k->mults, s->mults}, {k->divs, s->divs}
+    };
+    float values[5] = {2.5f, -0.0f, INFINITY, NAN, -3.0f};
+    static float out[TEST_NUMV_KERNELS_MAX], expected[TEST_NUMV_KERNELS_MAX];
+    size_t z, f, v;
+    int specials;
+
+    for(specials = 0; specials != 2; ++specials){
+        test_numv_kernels_fill(specials);
+        for(z = 0; z != 9; ++z){
+            size_t n = test_numv_kernels_sizes[z];
+            const float* a = test_numv_kernels_fa + 1;
+            const float* b = test_numv_kernels_fb + 3;
+
+            for(f = 0; f != 4; ++f){
+                binary[f][0](out, a, b, n);
+                binary[f][1](expected, a, b, n);
+                assert(test_numv_kernels_equal_f32(out, expected, n));
+                for(v = 0; v != 5; ++v){
+                    scalar[f][0](out, a, values[v], n);
+                    scalar[f][1](expected, a, values[v], n);
+                    assert(test_numv_kernels_equal_f32(out, expected, n));
+                }
+            }
+            for(v = 0; v != 5; ++v){
+                k->fill(out, values[v], n);
+                s->fill(expected, values[v], n);
+                assert(test_numv_kernels_equal_f32(out, expected, n));
+            }
+
+            assert(test_numv_kernels_same(k->sum(a, n), s->sum(a, n)));
+            float kmin = k->min(a, n), smin = s->min(a, n);
+            float kmax = k->max(a, n), smax = s->max(a, n);
+            assert(test_numv_kernels_same_f32(kmin, smin) && test_numv_kernels_same_f32(kmax, smax));
+        }
+    }
+}
+
+void test_numv_kernels_levels(){
+    const struct numv_kernels* scalar = numv_kernels_level(NUMV_SIMD_SCALAR);
+    const struct numv_kernels_f32* scalar_f32 = numv_kernels_f32_level(NUMV_SIMD_SCALAR);
+    assert(scalar && scalar_f32);
+    assert(scalar->level == NUMV_SIMD_SCALAR && scalar_f32->level == NUMV_SIMD_SCALAR);
+    assert(numv_kernels()->level == numv_kernels_f32()->level);
+
+    /* The scalar table is also compared with itself, which checks that the inputs are deterministic */
+    int level;
+    for(level = NUMV_SIMD_SCALAR; level <= NUMV_SIMD_AVX512; ++level){
+        const struct numv_kernels* k = numv_kernels_level((enum numv_simd_level)level);
+        const struct numv_kernels_f32* kf = numv_kernels_f32_level((enum numv_simd_level)level);
+        assert(!k == !kf);
+        if(!k) continue;
+        assert(k->level == (enum numv_simd_level)level && kf->level == (enum numv_simd_level)level);
+        test_numv_kernels_compare(k, scalar);
+        test_numv_kernels_compare_f32(kf, scalar_f32);
+    }
+}
+
+void test_numv_kernels_run_all(){
+    test_numv_kernels_levels();
+
+    printf("numv_kernels tests passed\n");
+}
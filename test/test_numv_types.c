@@ -0,0 +1,139 @@
+#include "stdio.h"
+#include "assert.h"
+#include "math.h"
+#include "numv_types.h"
+
+void test_numv_f32_arithmetic(){
+    /* Sizes that are not a multiple of any vector width */
+    size_t n;
+    for(n = 1; n < 70; n += 3){
+        float* a = numv_f32_range(-1.5, 7.0, n);
+        float* b = numv_f32_range(0.25, 3.0, n);
+        float* add = numv_f32_add(a, b);
+        float* div = numv_f32_div(a, b);
+        float* mults = numv_f32_mults(a, 3.0f);
+        size_t i;
+        assert(numv_size(a) == n && numv_size(add) == n);
+        for(i = 0; i != n; ++i){
+            assert(add[i] == a[i] + b[i]);
+            assert(div[i] == a[i] / b[i]);
+            assert(mults[i] == a[i] * 3.0f);
+        }
+        assert(numv_f32_sub_inplace(add, b) == add);
+        assert(numv_f32_subs_into(div, add, 1.0f) == div);
+        for(i = 0; i != n; ++i) assert(add[i] == (float)(a[i] + b[i]) - b[i] && div[i] == add[i] - 1.0f);
+        numv_free_n(5, a, b, add, div, mults);
+    }
+    float* a = numv_f32_zeros(4);
+    float* b = numv_f32_full(5, 1.5f);
+    assert(numv_f32_add(a, b) == NULL && numv_f32_mult_into(a, a, b) == NULL);
+    assert(b[4] == 1.5f && numv_f32_mults(NULL, 2.0f) == NULL);
+    numv_free_n(2, a, b);
+}
+
+void test_numv_f32_reductions(){
+    size_t n;
+    for(n = 1; n < 3000; n += 97){
+        float* nv = numv_f32_range(1.0, (double)n + 1.0, n);
+        assert(numv_f32_sum(nv) == (double)n * (double)(n + 1) / 2);
+        assert(numv_f32_mean(nv) == (double)(n + 1) / 2);
+        assert(numv_f32_min(nv) == 1.0f && numv_f32_max(nv) == (float)n);
+        assert(numv_f32_imin(nv) == 0 && numv_f32_imax(nv) == n - 1);
+        numv_free(nv);
+    }
+
+    /* Sums are computed in double precision */
+    float* nv = numv_f32_full(1000000, 0.1f);
+    assert(fabs(numv_f32_sum(nv) - 1000000.0 * (double)0.1f) < 1e-6);
+    assert(numv_f32_std(nv) < 1e-9);
+    nv[77] = NAN;
+    nv[500] = -2.0f;
+    assert(isnan(numv_f32_sum(nv)) && numv_f32_min(nv) == -2.0f && numv_f32_imin(nv) == 500);
+    numv_free(nv);
+
+    float data[4] = {NAN, NAN, NAN, NAN};
+    nv = numv_f32_from_array(4, data);
+    assert(isnan(numv_f32_min(nv)) && numv_f32_imax(nv) == 4);
+    nv[2] = -INFINITY;
+    assert(numv_f32_max(nv) == -INFINITY && numv_f32_imax(nv) == 2);
+    numv_free(nv);
+
+    assert(numv_f32_sum(NULL) == 0 && isnan(numv_f32_mean(NULL)) && isnan(numv_f32_max(NULL)));
+}
+
+void test_numv_int(){
+    int32_t* a = numv_i32_range(-5, 5, 10);
+    int32_t* b = numv_i32_full(10, 3);
+    size_t i;
+    for(i = 0; i != 10; ++i) assert(a[i] == (int32_t)i - 5);
+
+    int32_t* q = numv_i32_div(a, b);
+    for(i = 0; i != 10; ++i) assert(q[i] == a[i] / 3);
+    assert(numv_i32_sum(a) == -5 && numv_i32_mean(a) == -0.5);
+    assert(numv_i32_min(a) == -5 && numv_i32_max(a) == 4 && numv_i32_imax(a) == 9);
+    assert(fabs(numv_i32_std(a) - sqrt(8.25)) < 1e-12);
+
+    /* Division by zero gives 0, overflows wrap around */
+    assert(numv_i32_divs_inplace(q, 0) == q);
+    for(i = 0; i != 10; ++i) assert(q[i] == 0);
+    b[0] = INT32_MIN;
+    b[1] = INT32_MAX;
+    assert(numv_i32_mults_inplace(b, -1) == b);
+    assert(b[0] == INT32_MIN && b[1] == -INT32_MAX);
+    assert(numv_i32_adds_inplace(b, -1) == b && b[0] == INT32_MAX);
+    numv_free_n(3, a, b, q);
+
+    /* Sums of 32-bit integers do not overflow */
+    a = numv_i32_full(1000, INT32_MAX);
+    assert(numv_i32_sum(a) == 1000 * (int64_t)INT32_MAX);
+    numv_free(a);
+
+    int64_t* c = numv_i64_range(0, 3e12, 3);
+    assert(c[0] == 0 && c[1] == 1000000000000 && c[2] == 2000000000000);
+    int64_t* d = numv_i64_mult(c, c);
+    assert(d[1] == (int64_t)((uint64_t)1000000000000 * 1000000000000)); /* Wraps around */
+    assert(numv_i64_sum(c) == 3000000000000 && numv_i64_imin(c) == 0);
+    assert(numv_i64_min(NULL) == 0 && numv_i64_imax(NULL) == 0 && isnan(numv_i64_std(NULL)));
+    numv_free_n(2, c, d);
+}
+
+void test_numv_conversions(){
+    double data[8] = {1.9, -1.9, 0.5, NAN, 3e9, -3e9, INFINITY, 16777217.0};
+    double* nv = numv_from_array(8, data);
+
+    /* Toward zero, saturated, NaN to 0 */
+    int32_t* i32 = numv_i32_from_f64(nv);
+    int32_t expected[8] = {1, -1, 0, 0, INT32_MAX, INT32_MIN, INT32_MAX, 16777217};
+    assert(numv_size(i32) == 8 && memcmp(i32, expected, sizeof(expected)) == 0);
+
+    int64_t* i64 = numv_i64_from_f64(nv);
+    assert(i64[4] == 3000000000 && i64[5] == -3000000000 && i64[6] == INT64_MAX && i64[3] == 0);
+    int32_t* narrow = numv_i32_from_i64(i64);
+    assert(narrow[4] == INT32_MAX && narrow[5] == INT32_MIN && narrow[0] == 1);
+
+    /* Floats round to nearest */
+    float* f32 = numv_f32_from_f64(nv);
+    assert(f32[0] == 1.9f && isnan(f32[3]) && f32[7] == 16777216.0f);
+    double* back = numv_from_f32(f32);
+    assert(back[0] == (double)1.9f && isinf(back[6]));
+    double* wide = numv_from_i64(i64);
+    assert(wide[4] == 3e9);
+
+    int64_t* from_i32 = numv_i64_from_i32(i32);
+    float* f_from_i32 = numv_f32_from_i32(i32);
+    assert(from_i32[5] == INT32_MIN && f_from_i32[1] == -1.0f);
+    int32_t* from_f32 = numv_i32_from_f32(f32);
+    assert(from_f32[0] == 1 && from_f32[3] == 0 && from_f32[6] == INT32_MAX);
+
+    assert(numv_f32_from_f64(NULL) == NULL && numv_from_i32(NULL) == NULL);
+    numv_free_n(10, nv, i32, i64, narrow, f32, back, wide, from_i32, f_from_i32, from_f32);
+}
+
+void test_numv_types_run_all(){
+    test_numv_f32_arithmetic();
+    test_numv_f32_reductions();
+    test_numv_int();
+    test_numv_conversions();
+
+    printf("numv_types tests passed\n");
+}
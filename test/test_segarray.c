@@ -0,0 +1,104 @@
+#include "stdio.h"
+#include "assert.h"
+#include "segarray.h"
+
+void test_segarray_init(){
+	segarray_t s;
+	void* r = segarray_init(&s, sizeof(int));
+	assert(r == &s);
+	assert(s.size == 0);
+	assert(s.element_size == sizeof(int));
+	assert(s.block_capacity * sizeof(int) == SEGARRAY_BLOCK_BYTES);
+	assert(!segarray_get(&s, 0));
+	segarray_uninit(&s);
+}
+
+void test_segarray_init_zero_element_size(){
+	segarray_t s;
+	void* r = segarray_init(&s, 0);
+	assert(!r);
+	segarray_uninit(&s);
+}
+
+void test_segarray_push_back(){
+	segarray_t s;
+	segarray_init(&s, sizeof(int));
+	int i, n = (int)s.block_capacity * 3 + 5;
+	for(i = 0; i != n; ++i){
+		assert(segarray_push_back(&s, &i));
+	}
+	assert(s.size == (size_t)n);
+	assert(s.blocks.size == 4);
+	for(i = 0; i != n; ++i){
+		assert(*(int*)segarray_get(&s, i) == i);
+	}
+	assert(!segarray_get(&s, n));
+	segarray_uninit(&s);
+}
+
+void test_segarray_insert(){
+	segarray_t s;
+	segarray_init(&s, sizeof(int));
+	int i, n = (int)s.block_capacity * 2;
+	/* Every element is inserted at the front, splitting full blocks */
+	for(i = 0; i != n; ++i){
+		assert(segarray_insert(&s, &i, 0));
+	}
+	assert(s.size == (size_t)n);
+	assert(s.blocks.size > 2);
+	for(i = 0; i != n; ++i){
+		assert(*(int*)segarray_get(&s, i) == n - 1 - i);
+	}
+	assert(!segarray_insert(&s, &i, n + 1));
+	assert(segarray_insert(&s, NULL, n / 2));
+	assert(*(int*)segarray_get(&s, n / 2) == 0);
+	assert(*(int*)segarray_get(&s, n / 2 + 1) == n / 2 - 1);
+	segarray_uninit(&s);
+}
+
+void test_segarray_set(){
+	segarray_t s;
+	segarray_init(&s, sizeof(int));
+	int v = 5;
+	assert(!segarray_set(&s, &v, 0));
+	segarray_push_back(&s, NULL);
+	assert(segarray_set(&s, &v, 0));
+	assert(*(int*)segarray_get(&s, 0) == 5);
+	segarray_uninit(&s);
+}
+
+void test_segarray_remove(){
+	segarray_t s;
+	segarray_init(&s, sizeof(int));
+	int i, n = (int)s.block_capacity * 3;
+	for(i = 0; i != n; ++i){
+		segarray_push_back(&s, &i);
+	}
+	/* Removes every even element */
+	for(i = 0; i != n / 2; ++i){
+		assert(segarray_remove(&s, i));
+	}
+	assert(s.size == (size_t)n / 2);
+	for(i = 0; i != n / 2; ++i){
+		assert(*(int*)segarray_get(&s, i) == 2 * i + 1);
+	}
+	assert(!segarray_remove(&s, n / 2));
+	while(s.size){
+		assert(segarray_pop_back(&s));
+	}
+	assert(s.blocks.size == 0);
+	assert(!segarray_pop_back(&s));
+	segarray_uninit(&s);
+}
+
+
+void test_segarray_run_all(){
+	test_segarray_init();
+	test_segarray_init_zero_element_size();
+	test_segarray_push_back();
+	test_segarray_insert();
+	test_segarray_set();
+	test_segarray_remove();
+
+	printf("segarray tests passed\n");
+}
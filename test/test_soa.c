@@ -0,0 +1,133 @@
+#include "stdio.h"
+#include "assert.h"
+#include "soa.h"
+
+struct test_soa_record {
+	int id;
+	double price;
+	char tag;
+};
+
+static const struct soa_field test_soa_fields[] = {
+	{"id", sizeof(int)},
+	{"price", sizeof(double)},
+	{"tag", sizeof(char)},
+};
+
+void test_soa_init(){
+	soa_t s;
+	void* r = soa_init(&s, test_soa_fields, 3);
+	assert(r == &s);
+	assert(s.size == 0);
+	assert(s.n_columns == 3);
+	assert(s.columns[1].element_size == sizeof(double));
+	assert(soa_column_index(&s, "tag") == 2);
+	assert(soa_column_index(&s, "missing") == 3);
+	assert(!soa_column(&s, 0));
+	assert(!soa_get(&s, 0, 0));
+	soa_uninit(&s);
+}
+
+void test_soa_init_invalid_schema(){
+	soa_t s;
+	struct soa_field zero_size[] = {{"a", 4}, {"b", 0}};
+	struct soa_field duplicate[] = {{"a", 4}, {"a", 8}};
+	assert(!soa_init(&s, test_soa_fields, 0));
+	assert(!soa_init(&s, zero_size, 2));
+	assert(!soa_init(&s, duplicate, 2));
+	soa_uninit(&s);
+	assert(!soa_create(duplicate, 2));
+}
+
+void test_soa_push_back(){
+	soa_t* s = soa_create(test_soa_fields, 3);
+	assert(s);
+	int i;
+	for(i = 0; i != 100; ++i){
+		double price = i * 0.5;
+		char tag = (char)('a' + i % 26);
+		const void* record[] = {&i, &price, &tag};
+		assert(soa_push_back(s, record));
+	}
+	assert(s->size == 100);
+
+	int* ids = soa_column(s, 0);
+	double* prices = soa_column_by_name(s, "price");
+	char* tags = soa_column_by_name(s, "tag");
+	for(i = 0; i != 100; ++i){
+		assert(ids[i] == i);
+		assert(prices[i] == i * 0.5);
+		assert(tags[i] == 'a' + i % 26);
+	}
+	assert(*(double*)soa_get(s, 1, 10) == 5.0);
+	assert(!soa_get(s, 1, 100));
+	assert(!soa_get(s, 3, 0));
+
+	/* NULL values zero the record */
+	assert(soa_push_back(s, NULL));
+	assert(*(int*)soa_get(s, 0, 100) == 0);
+	assert(*(double*)soa_get(s, 1, 100) == 0.0);
+	soa_destroy(s);
+}
+
+void test_soa_insert(){
+	soa_t s;
+	soa_init(&s, test_soa_fields, 3);
+	int i;
+	for(i = 0; i != 10; ++i){
+		const void* record[] = {&i, NULL, NULL};
+		assert(soa_insert(&s, record, 0));
+	}
+	double price = 99;
+	int id = 99;
+	const void* record[] = {&id, &price, NULL};
+	assert(soa_insert(&s, record, 5));
+	assert(!soa_insert(&s, record, 12));
+	assert(s.size == 11);
+	for(i = 0; i != 11; ++i){
+		int expected = i < 5 ? 9 - i : i == 5 ? 99 : 10 - i;
+		assert(*(int*)soa_get(&s, 0, i) == expected);
+		assert(*(double*)soa_get(&s, 1, i) == (i == 5 ? 99 : 0));
+	}
+	soa_uninit(&s);
+}
+
+void test_soa_remove(){
+	soa_t s;
+	soa_init(&s, test_soa_fields, 3);
+	int i;
+	for(i = 0; i != 6; ++i){
+		double price = i;
+		const void* record[] = {&i, &price, NULL};
+		soa_push_back(&s, record);
+	}
+	assert(soa_remove(&s, 1));
+	assert(soa_swap_remove(&s, 0));
+	assert(soa_pop_back(&s));
+	assert(!soa_remove(&s, 3));
+	/* Records: 5, 2, 3 */
+	assert(s.size == 3);
+	int* ids = soa_column(&s, 0);
+	double* prices = soa_column(&s, 1);
+	assert(ids[0] == 5 && prices[0] == 5);
+	assert(ids[1] == 2 && prices[1] == 2);
+	assert(ids[2] == 3 && prices[2] == 3);
+	assert(s.columns[2].size == 3);
+
+	assert(soa_resize(&s, 50));
+	assert(s.size == 50 && s.columns[1].size == 50);
+	assert(soa_clear(&s));
+	assert(s.size == 0 && s.columns[0].size == 0);
+	assert(!soa_pop_back(&s));
+	soa_uninit(&s);
+}
+
+void test_soa_run_all(){
+	test_soa_init();
+	test_soa_init_invalid_schema();
+	test_soa_push_back();
+	test_soa_insert();
+	test_soa_remove();
+
+	printf("soa tests passed\n");
+}
@@ -0,0 +1,125 @@
+#include "stdio.h"
+#include "assert.h"
+#include "string.h"
+#include "strvec.h"
+
+void test_strvec_init(){
+	strvec_t s;
+	void* r = strvec_init(&s);
+	assert(r == &s);
+	assert(strvec_size(&s) == 0);
+	assert(!strvec_get(&s, 0));
+	assert(strvec_len(&s, 0) == 0);
+	strvec_uninit(&s);
+}
+
+void test_strvec_push(){
+	strvec_t s;
+	strvec_init(&s);
+	assert(strvec_push(&s, "hello"));
+	assert(strvec_pushn(&s, "world!", 5));
+	assert(strvec_push(&s, ""));
+	assert(!strvec_push(&s, NULL));
+	assert(strvec_size(&s) == 3);
+	assert(strcmp(strvec_get(&s, 0), "hello") == 0);
+	assert(strcmp(strvec_get(&s, 1), "world") == 0);
+	assert(strcmp(strvec_get(&s, 2), "") == 0);
+	assert(strvec_len(&s, 0) == 5);
+	assert(strvec_len(&s, 1) == 5);
+	assert(strvec_len(&s, 2) == 0);
+	/* Characters and terminators only */
+	assert(s.bytes.size == 13);
+
+	assert(strvec_pop_back(&s));
+	assert(strvec_pop_back(&s));
+	assert(strvec_size(&s) == 1);
+	assert(s.bytes.size == 6);
+	assert(strvec_clear(&s));
+	assert(!strvec_pop_back(&s));
+	strvec_uninit(&s);
+}
+
+void test_strvec_many(){
+	strvec_t* s = strvec_create();
+	char buffer[16];
+	int i;
+	for(i = 0; i != 10000; ++i){
+		sprintf(buffer, "%d", i);
+		assert(strvec_push(s, buffer));
+	}
+	for(i = 0; i != 10000; ++i){
+		sprintf(buffer, "%d", i);
+		assert(strcmp(strvec_get(s, i), buffer) == 0);
+		assert(strvec_len(s, i) == strlen(buffer));
+	}
+	strvec_destroy(s);
+}
+
+void test_strvec_push_own(){
+	strvec_t s;
+	strvec_init(&s);
+	assert(strvec_push(&s, "ab"));
+	/* Each copy of a string of the strvec may move the bytes it is read from */
+	size_t i;
+	for(i = 1; i != 300; ++i){
+		assert(strvec_push(&s, strvec_get(&s, i - 1)));
+	}
+	assert(strvec_pushn(&s, strvec_get(&s, 0) + 1, 1));
+	for(i = 0; i != 300; ++i){
+		assert(strcmp(strvec_get(&s, i), "ab") == 0);
+	}
+	assert(strcmp(strvec_get(&s, 300), "b") == 0);
+	strvec_uninit(&s);
+}
+
+void test_strvec_from_text(){
+	strvec_t s;
+	strvec_init(&s);
+	const char* text = "one\ntwo\n\nfour\n";
+	assert(strvec_from_text(&s, text, strlen(text), '\n'));
+	assert(strvec_size(&s) == 4);
+	assert(strcmp(strvec_get(&s, 0), "one") == 0);
+	assert(strcmp(strvec_get(&s, 2), "") == 0);
+	assert(strcmp(strvec_get(&s, 3), "four") == 0);
+
+	/* Appends after existing strings, without a final delimiter */
+	assert(strvec_from_text(&s, "a,bc", 4, ','));
+	assert(strvec_size(&s) == 6);
+	assert(strcmp(strvec_get(&s, 4), "a") == 0);
+	assert(strcmp(strvec_get(&s, 5), "bc") == 0);
+	assert(strvec_len(&s, 5) == 2);
+
+	assert(strvec_from_text(&s, "", 0, ','));
+	assert(strvec_size(&s) == 6);
+	strvec_uninit(&s);
+}
+
+void test_strvec_slice(){
+	strvec_t s;
+	strvec_init(&s);
+	strvec_from_text(&s, "a b cc ddd", 10, ' ');
+	strvec_t* slice = strvec_slice(&s, 1, 4);
+	assert(slice);
+	assert(strvec_size(slice) == 3);
+	assert(strcmp(strvec_get(slice, 0), "b") == 0);
+	assert(strcmp(strvec_get(slice, 2), "ddd") == 0);
+	assert(strvec_len(slice, 2) == 3);
+	strvec_destroy(slice);
+
+	slice = strvec_slice(&s, 2, 2);
+	assert(slice && strvec_size(slice) == 0);
+	strvec_destroy(slice);
+	assert(!strvec_slice(&s, 3, 5));
+	strvec_uninit(&s);
+}
+
+void test_strvec_run_all(){
+	test_strvec_init();
+	test_strvec_push();
+	test_strvec_many();
+	test_strvec_push_own();
+	test_strvec_from_text();
+	test_strvec_slice();
+
+	printf("strvec tests passed\n");
+}
@@ -26,6 +26,16 @@ void test_vec_init(){
     vec_free(v);
 }
 
+void test_vec_alignment(){
+    double* v = vec_init(double);
+    vec_resize(v, 3);
+    assert((uintptr_t)v % DATALIB_ALIGNMENT == 0);
+    vec_resize(v, 100);
+    assert((uintptr_t)v % DATALIB_ALIGNMENT == 0);
+    assert(vec_size(v) == 100);
+    vec_free(v);
+}
+
 void test_vec_resize(){
     int* v = vec_init(int);
     vec_resize(v, 3);
@@ -156,7 +166,14 @@ void test_vec_insert_empty(){
 
 void test_vec_delete(){
     int* v = vec_init(int);
-
+    int i;
+    for(i = 0; i != 5; ++i) vec_push(v, i);
+    vec_delete(v, 2);
+    assert(vec_size(v) == 4);
+    assert(v[0] == 0);
+    assert(v[1] == 1);
+    assert(v[2] == 3);
+    assert(v[3] == 4);
     vec_free(v);
 }
 
@@ -176,6 +193,104 @@ void test_vec_delete_empty(){
 }
 
 
+void test_vec_swap_remove(){
+    int* v = vec_init(int);
+    int i;
+    for(i = 0; i != 5; ++i) vec_push(v, i);
+    vec_swap_remove(v, 1);
+    assert(vec_size(v) == 4);
+    assert(v[0] == 0);
+    assert(v[1] == 4);
+    assert(v[2] == 2);
+    assert(v[3] == 3);
+    vec_swap_remove(v, 3);
+    assert(vec_size(v) == 3);
+    assert(v[2] == 2);
+    vec_swap_remove(v, 3);
+    assert(vec_size(v) == 3);
+    vec_free(v);
+}
+
+int test_vec_is_multiple(const void* item, void* args){
+    return *(const int*)item % *(int*)args == 0;
+}
+
+int test_vec_every_other(const void* item, void* args){
+    (void)item;
+    return (*(size_t*)args)++ % 2 == 0;
+}
+
+void test_vec_retain(){
+    int* v = vec_init(int);
+    int i, k = 3;
+    for(i = 0; i != 100; ++i) vec_push(v, i);
+    assert(vec_retain(v, test_vec_is_multiple, &k) == 66);
+    assert(vec_size(v) == 34);
+    for(i = 0; i != 34; ++i){
+        assert(v[i] == i * 3);
+    }
+    k = 1;
+    assert(vec_retain(v, test_vec_is_multiple, &k) == 0);
+    assert(vec_size(v) == 34);
+    k = 1000;
+    assert(vec_retain(v, test_vec_is_multiple, &k) == 33);
+    assert(vec_size(v) == 1 && v[0] == 0);
+
+    /* A stateful predicate sees every item once: keep every other item */
+    size_t calls = 0;
+    for(i = 1; i != 100; ++i) vec_push(v, i);
+    assert(vec_retain(v, test_vec_every_other, &calls) == 50);
+    assert(calls == 100 && vec_size(v) == 50);
+    for(i = 0; i != 50; ++i){
+        assert(v[i] == i * 2);
+    }
+    vec_free(v);
+}
+
+
+int test_vec_cmp_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void test_vec_sort(){
+    double* v = vec_init(double);
+    int i;
+    for(i = 0; i != 100; ++i){
+        vec_push(v, (double)((i * 37) % 100));
+    }
+    vec_sort(v, test_vec_cmp_double);
+    for(i = 0; i != 100; ++i){
+        assert(v[i] == i);
+    }
+    double key = 41.5;
+    assert(vec_lower_bound(v, &key, test_vec_cmp_double) == 42);
+    key = 41;
+    assert(vec_lower_bound(v, &key, test_vec_cmp_double) == 41);
+    assert(vec_upper_bound(v, &key, test_vec_cmp_double) == 42);
+    vec_free(v);
+}
+
+void test_vec_map_file(){
+#ifdef DATALIB_HAS_MMAP
+    const char* path = "test_vec_map_file.bin";
+    double values[] = {1.5, 2.5, 3.5};
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    fwrite(values, sizeof(double), 3, f);
+    fclose(f);
+
+    double* v = vec_map_file(double, path);
+    assert(v);
+    assert(vec_size(v) == 3);
+    assert(memcmp(v, values, sizeof(values)) == 0);
+    vec_unmap(v);
+
+    assert(!vec_map_file(struct {char c[5];}, path));
+    remove(path);
+#endif
+}
+
 void test_vec_of_structs(){
     struct data {int a; float b; char c;};
     struct data* data = vec_init(struct data);
@@ -194,6 +309,7 @@ void test_vec_of_structs(){
 void test_vec_run_all(){
 
     test_vec_init();
+    test_vec_alignment();
     test_vec_resize();
     test_vec_push();
     test_vec_push_front();
@@ -208,6 +324,10 @@ void test_vec_run_all(){
     test_vec_delete_front();
     test_vec_delete_back();
     test_vec_delete_empty();
+    test_vec_swap_remove();
+    test_vec_retain();
+    test_vec_sort();
+    test_vec_map_file();
     test_vec_of_structs();
 
     printf("vec tests passed\n");